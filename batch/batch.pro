@@ -0,0 +1,12 @@
+# Command line tool that runs restoration pipelines on many images without
+# the GUI. Only uses Qt to read and write image files.
+TARGET = prog3-batch
+DESTDIR = $$OUT_PWD/..
+QT = core gui
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += \
+    prog3-batch.cpp
+
+include(../restore/restore.pri)
@@ -0,0 +1,660 @@
+/***************************************************************************//**
+ * prog3-batch.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 16, 2015
+ *
+ * Details - Command line tool that runs a restoration pipeline on many images
+ *           without the GUI, for example
+ *
+ *               prog3-batch -p "fft | lowpass gaussian r=40 | ifft" -o out *.png
+ *
+ *           Images are processed in parallel, one per thread, and the total
+ *           throughput is reported at the end. Images are read and written
+ *           with QImage and converted to grayscale intensities, just as the
+ *           menus work on intensities. With -t, images whose spectrum would
+ *           not fit in memory are filtered in tiles instead, and with -s,
+ *           the frames of a video are filtered several at a time.
+ *
+ *           Frames can also be kept between runs as frame files, which hold
+ *           raw intensities or spectra and are mapped back into memory
+ *           rather than decoded, so one run can stop at 'fft' and later runs
+ *           can filter the saved spectra.
+ *
+ *           Options of the pipeline may list several values, for example
+ *
+ *               prog3-batch -p "fft | blur r=2,4 | ifft | noise sd=5 seed=1..10"
+ *                           -o corpus *.png
+ *
+ *           to build a corpus of degraded images: every image is run through
+ *           every combination, and manifest.csv records the original image
+ *           and the exact pipeline behind each result.
+ ******************************************************************************/
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include "BufferPool.h"
+#include "FrameFile.h"
+#include "Pipeline.h"
+#include "StackFilter.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// Image format of results made from frame files without -r
+static const char* const FRAME_IMAGE_SUFFIX = "png";
+
+/***************************************************************************//**
+ * usage
+ * Author - Dan Andrus
+ *
+ * Prints how to run the program.
+ ******************************************************************************/
+static void usage()
+{
+    cerr << "Usage: prog3-batch -p PIPELINE [-o DIR] [-j THREADS] [-t TILE] [-s DEPTH] [-r] [-m]" << endl
+         << "                   FILE..." << endl
+         << endl
+         << "  -p PIPELINE  stages separated by '|', for example" << endl
+         << "               \"fft | lowpass gaussian r=40 | wiener K=0.01 r=30 | ifft\"" << endl
+         << "  -o DIR       directory for the results (default: restored)" << endl
+         << "  -j THREADS   number of threads (default: PROG3_THREADS or all)" << endl
+         << "  -t TILE      filter in TILE x TILE tiles, for images whose spectrum" << endl
+         << "               does not fit in memory (for example -t 1024)" << endl
+         << "  -s DEPTH     filter DEPTH frames of the same size at a time, such as" << endl
+         << "               the frames of a video, for a pipeline that is only fft," << endl
+         << "               filters and ifft (for example -s 8)" << endl
+         << "  -r           write every result as a frame file (." << FRAME_FILE_SUFFIX << ")" << endl
+         << "  -m           write manifest.csv, listing the source and pipeline of" << endl
+         << "               every result" << endl
+         << endl
+         << "FILE may be a wildcard pattern such as frames/*.png, or @LIST to read" << endl
+         << "file names from LIST, one per line." << endl
+         << endl
+         << "Frame files hold raw intensities or spectra and can be given as FILE." << endl
+         << "Results still in the frequency domain are written as frame files, and" << endl
+         << "images made from frame files as ." << FRAME_IMAGE_SUFFIX << " images. The" << endl
+         << "pipeline for a spectrum starts without 'fft'." << endl
+         << endl
+         << "Options may list several values, such as r=2,4,8 or seed=1..10. Every" << endl
+         << "image is then run through every combination, the results are numbered" << endl
+         << "NAME-1, NAME-2 and so on (padded with zeros to the same width), and" << endl
+         << "manifest.csv is always written." << endl
+         << endl
+         << "Stages:" << endl
+         << "  fft, ifft" << endl
+         << "  lowpass [ideal|gaussian] r=R" << endl
+         << "  bandreject [ideal|gaussian] lo=A hi=B" << endl
+         << "  notch fx=X fy=Y r=R" << endl
+         << "  inverse r=R [t=T]" << endl
+         << "  wiener r=R K=K [t=T]" << endl
+         << "  autonotch [t=T] [r=R] [max=N]" << endl
+         << endl
+         << "Degradations:" << endl
+         << "  blur r=R" << endl
+         << "  noise sd=S [seed=N]" << endl
+         << "  periodic fx=X fy=Y a=A [phase=P]" << endl;
+}
+
+/***************************************************************************//**
+ * Variant
+ *
+ * Author - Dan Andrus
+ *
+ * One combination of the options of the pipeline, parsed for frames starting
+ * in either domain: images start in the spatial domain and saved spectra in
+ * the frequency domain, and each file uses the pipeline that fits it.
+ ******************************************************************************/
+struct Variant
+{
+    Pipeline pipelines[2];
+    string errors[2];
+    bool parsed[2];
+};
+
+/***************************************************************************//**
+ * csvField
+ * Author - Dan Andrus
+ *
+ * Returns text quoted for a CSV file.
+ ******************************************************************************/
+static string csvField(const string& text)
+{
+    string quoted = "\"";
+
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] == '"')
+            quoted += '"';
+        quoted += text[i];
+    }
+    return quoted + "\"";
+}
+
+/***************************************************************************//**
+ * expandInput
+ * Author - Dan Andrus
+ *
+ * Adds the files named by one command line argument to a list. Wildcards are
+ * expanded here since not every shell does it, and @LIST arguments are read
+ * as a list of file names.
+ *
+ * Returns
+ *          false if a list file could not be read
+ ******************************************************************************/
+static bool expandInput(const QString& arg, QStringList& files)
+{
+    if (arg.startsWith('@'))
+    {
+        QFile list(arg.mid(1));
+        if (!list.open(QIODevice::ReadOnly | QIODevice::Text))
+            return false;
+
+        QTextStream in(&list);
+        while (!in.atEnd())
+        {
+            QString line = in.readLine().trimmed();
+            if (!line.isEmpty())
+                files << line;
+        }
+        return true;
+    }
+
+    if (!arg.contains('*') && !arg.contains('?') && !arg.contains('['))
+    {
+        files << arg;
+        return true;
+    }
+
+    QFileInfo pattern(arg);
+    QDir dir = pattern.dir();
+    QStringList names = dir.entryList(QStringList(pattern.fileName()),
+                                      QDir::Files, QDir::Name);
+    for (int i = 0; i < names.size(); i++)
+        files << dir.filePath(names[i]);
+    return true;
+}
+
+/***************************************************************************//**
+ * loadFrame
+ * Author - Dan Andrus
+ *
+ * Reads an image file into the intensities of a frame, or maps a frame file
+ * as it was saved.
+ *
+ * Returns
+ *          false with error set, naming the file, if it could not be read
+ ******************************************************************************/
+static bool loadFrame(const QString& path, Frame& frame, string& error)
+{
+    if (isFrameFile(path.toStdString()))
+        return readFrameFile(path.toStdString(), frame, error);
+
+    QImage image(path);
+    if (image.isNull())
+    {
+        error = path.toStdString() + ": cannot read";
+        return false;
+    }
+
+    image = image.convertToFormat(QImage::Format_RGB32);
+    int rows = image.height();
+    int cols = image.width();
+
+    frame.spatial.resize(rows, cols);
+    for (int r = 0; r < rows; r++)
+    {
+        const QRgb* line = (const QRgb*) image.constScanLine(r);
+        float* out = frame.spatial[r];
+        for (int c = 0; c < cols; c++)
+            out[c] = (float) qGray(line[c]);
+    }
+    frame.cols = cols;
+    frame.frequency = false;
+    return true;
+}
+
+/***************************************************************************//**
+ * saveFrame
+ * Author - Dan Andrus
+ *
+ * Writes the intensities of a frame as a grayscale image, clamped to 0-255.
+ * The format is chosen from the file extension.
+ ******************************************************************************/
+static bool saveFrame(const QString& path, const Frame& frame)
+{
+    int rows = frame.spatial.rows();
+    int cols = frame.spatial.cols();
+    QImage image(cols, rows, QImage::Format_RGB32);
+
+    for (int r = 0; r < rows; r++)
+    {
+        QRgb* line = (QRgb*) image.scanLine(r);
+        const float* in = frame.spatial[r];
+        for (int c = 0; c < cols; c++)
+        {
+            int value = (int) floor(in[c] + 0.5f);
+            value = std::min(255, std::max(0, value));
+            line[c] = qRgb(value, value, value);
+        }
+    }
+    return image.save(path);
+}
+
+/***************************************************************************//**
+ * resultName
+ * Author - Dan Andrus
+ *
+ * Returns the file name of a result given its base name: with the frame file
+ * suffix if it is written raw, and otherwise with the suffix of its input,
+ * which picks the image format. Frame files have no image format, so images
+ * made from them are written as FRAME_IMAGE_SUFFIX.
+ ******************************************************************************/
+static QString resultName(const QString& path, const QString& base, bool raw)
+{
+    QFileInfo input(path);
+
+    if (raw)
+        return base + "." + FRAME_FILE_SUFFIX;
+    if (isFrameFile(path.toStdString()))
+        return base + "." + FRAME_IMAGE_SUFFIX;
+    if (input.suffix().isEmpty())
+        return base;
+    return base + "." + input.suffix();
+}
+
+/***************************************************************************//**
+ * writeResult
+ * Author - Dan Andrus
+ *
+ * Writes the result of one input file, as a frame file if raw is set and as
+ * an image otherwise.
+ *
+ * Returns
+ *          false with problem set, naming the file, if it could not be written
+ ******************************************************************************/
+static bool writeResult(const QString& path, const QString& target,
+                        const Frame& frame, bool raw, string& problem)
+{
+    QFileInfo input(path);
+    QFileInfo existing(target);
+
+    // A frame read from a file may still be using its mapping
+    if (isFrameFile(path.toStdString()) && existing.exists()
+        && existing.canonicalFilePath() == input.canonicalFilePath())
+        problem = path.toStdString() + ": result would replace the input";
+    else if (raw)
+        writeFrameFile(target.toStdString(), frame, problem);
+    else if (!saveFrame(target, frame))
+        problem = target.toStdString() + ": cannot write";
+    return problem.empty();
+}
+
+/***************************************************************************//**
+ * manifestRecord
+ * Author - Dan Andrus
+ *
+ * Returns the line of manifest.csv describing one result.
+ ******************************************************************************/
+static string manifestRecord(const QString& target, const QString& path,
+                             int number, const string& history)
+{
+    ostringstream row;
+
+    row << csvField(QFileInfo(target).fileName().toStdString()) << ","
+        << csvField(QFileInfo(path).absoluteFilePath().toStdString()) << ","
+        << number << ","
+        << csvField(history);
+    return row.str();
+}
+
+/***************************************************************************//**
+ * main
+ * Author - Dan Andrus
+ *
+ * Parses the command line, runs the pipeline on every input file and reports
+ * the throughput.
+ *
+ * Returns
+ *          0 if every image was processed, 1 if any failed, 2 on bad arguments
+ ******************************************************************************/
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    QString spec;
+    QString output = "restored";
+    QStringList files;
+    int threads = 0;
+    int tile = 0;
+    int depth = 0;
+    bool rawOutput = false;
+    bool manifest = false;
+
+    for (int i = 1; i < args.size(); i++)
+    {
+        const QString& arg = args[i];
+
+        if ((arg == "-p" || arg == "-o" || arg == "-j" || arg == "-t" || arg == "-s")
+            && i + 1 >= args.size())
+        {
+            usage();
+            return 2;
+        }
+
+        if (arg == "-p")
+            spec = args[++i];
+        else if (arg == "-o")
+            output = args[++i];
+        else if (arg == "-j")
+            threads = args[++i].toInt();
+        else if (arg == "-t")
+            tile = args[++i].toInt();
+        else if (arg == "-s")
+            depth = args[++i].toInt();
+        else if (arg == "-r")
+            rawOutput = true;
+        else if (arg == "-m")
+            manifest = true;
+        else if (arg == "-h" || arg == "--help")
+        {
+            usage();
+            return 0;
+        }
+        else if (!expandInput(arg, files))
+        {
+            cerr << "Cannot read file list " << arg.mid(1).toStdString() << endl;
+            return 2;
+        }
+    }
+
+    if (spec.isEmpty() || files.isEmpty())
+    {
+        usage();
+        return 2;
+    }
+
+    vector<string> specs;
+    string error;
+    if (!Pipeline::expand(spec.toStdString(), specs, error))
+    {
+        cerr << "Bad pipeline: " << error << endl;
+        return 2;
+    }
+
+    vector<Variant> variants(specs.size());
+    for (size_t v = 0; v < specs.size(); v++)
+    {
+        Variant& variant = variants[v];
+        for (int domain = 0; domain < 2; domain++)
+        {
+            variant.parsed[domain] = variant.pipelines[domain].parse(
+                specs[v], variant.errors[domain], domain == 1);
+            variant.pipelines[domain].setTileSize(tile);
+        }
+        if (!variant.parsed[0] && !variant.parsed[1])
+        {
+            cerr << "Bad pipeline: " << variant.errors[0] << endl;
+            return 2;
+        }
+    }
+
+    const Variant& first = variants[0];
+    const Pipeline& pipeline = first.parsed[0] ? first.pipelines[0] : first.pipelines[1];
+    int count = (int) variants.size();
+    bool grid = (count > 1);
+    manifest = manifest || grid;
+
+    if (depth > 0 && (grid || tile > 0 || !first.parsed[0] || !first.pipelines[0].onlyFilters()))
+    {
+        cerr << "-s needs a pipeline of the form 'fft | filters | ifft', without -t"
+             << " or options listing several values" << endl;
+        return 2;
+    }
+
+    if (!QDir().mkpath(output))
+    {
+        cerr << "Cannot create output directory " << output.toStdString() << endl;
+        return 2;
+    }
+
+    ThreadPool& pool = ThreadPool::global();
+    if (threads > 0)
+        pool.resize(threads);
+
+    cout << "Pipeline: " << (grid ? spec.toStdString() : pipeline.describe()) << endl;
+    if (grid)
+        cout << "Variants: " << count << endl;
+    cout << "Images:   " << files.size() << endl
+         << "Threads:  " << pool.size() << endl;
+    if (tile > 0)
+        cout << "Tiles:    " << tile << " x " << tile << endl;
+    if (depth > 0)
+        cout << "Stacks:   " << depth << " frames" << endl;
+
+    std::mutex report;
+    std::atomic<int> failed(0);
+    std::atomic<long long> pixels(0);
+    QDir outDir(output);
+    int jobs = files.size() * count;
+    vector<string> records(jobs);       // lines of the manifest, empty if failed
+    int digits = 1;
+    for (int n = count; n >= 10; n /= 10)
+        digits++;
+
+    // One result per thread, taking the variants of an image in turn.
+    // Transforms started inside the loop run on that thread alone, so with
+    // fewer results than threads it is faster to take them one at a time and
+    // let each transform use the whole pool. Tiled images are always taken
+    // one at a time, so that only one large image is in memory and its tiles
+    // are spread over the pool.
+    auto process = [&](int begin, int end)
+    {
+        Frame source;
+        int loaded = -1;
+        bool readable = false;
+
+        for (int i = begin; i < end; i++)
+        {
+            int index = i / count;
+            int number = i % count + 1;
+            const Variant& variant = variants[number - 1];
+            const QString& path = files[index];
+            QFileInfo input(path);
+            QString target;
+            Frame frame;
+            string problem;     // names the file
+
+            // Each image is read once for all of its variants, and a problem
+            // reading it is reported once
+            if (index != loaded)
+            {
+                source = Frame();
+                readable = loadFrame(path, source, problem);
+                loaded = index;
+            }
+            else if (!readable)
+            {
+                failed++;
+                continue;
+            }
+
+            if (readable)
+            {
+                if (count == 1)
+                    frame = std::move(source);
+                else
+                    frame = source;
+            }
+
+            if (readable && !variant.parsed[frame.frequency])
+                problem = path.toStdString() + ": " + variant.errors[frame.frequency];
+            else if (readable)
+            {
+                int rows = frame.frequency ? frame.real.rows() : frame.spatial.rows();
+                pixels += (long long) rows * frame.cols;
+                variant.pipelines[frame.frequency].run(frame);
+
+                bool raw = frame.frequency || rawOutput;
+                QString name = input.completeBaseName();
+                if (grid)
+                {
+                    ostringstream suffix;
+                    suffix << "-" << setw(digits) << setfill('0') << number;
+                    name = name + QString::fromStdString(suffix.str());
+                }
+
+                target = outDir.filePath(resultName(path, name, raw));
+
+                if (writeResult(path, target, frame, raw, problem))
+                    records[i] = manifestRecord(target, path, number, frame.history);
+            }
+
+            if (!problem.empty())
+            {
+                std::lock_guard<std::mutex> lock(report);
+                cerr << problem << endl;
+                failed++;
+            }
+        }
+    };
+
+    // With -s, consecutive images of the same size go through one StackFilter,
+    // which reads and writes them on a thread of its own while it filters.
+    // An image of another size ends the stream and starts the next one
+    auto stacked = [&]()
+    {
+        const TransferFunction& filters = *first.pipelines[0].onlyFilters();
+        Frame pending;              // read but not yet filtered
+        int pendingIndex = -1;
+        int index = 0;
+
+        // Reads images until one is read, reporting those that cannot be
+        auto readNext = [&]() -> bool
+        {
+            while (pendingIndex < 0 && index < files.size())
+            {
+                string problem;
+                if (loadFrame(files[index], pending, problem) && pending.frequency)
+                    problem = files[index].toStdString() + ": stacks need images, not spectra";
+                if (problem.empty())
+                    pendingIndex = index;
+                else
+                {
+                    std::lock_guard<std::mutex> lock(report);
+                    cerr << problem << endl;
+                    failed++;
+                }
+                index++;
+            }
+            return pendingIndex >= 0;
+        };
+
+        while (readNext())
+        {
+            int rows = pending.spatial.rows();
+            int cols = pending.spatial.cols();
+            StackFilter filter(filters, rows, cols, depth);
+            vector<int> sources;    // input file of each frame of this stream
+            Frame result;
+
+            result.history = first.pipelines[0].describe();
+            filter.run(
+                [&](int n, float* const* out) -> bool
+                {
+                    if (!readNext() || pending.spatial.rows() != rows
+                        || pending.spatial.cols() != cols)
+                        return false;
+                    for (int r = 0; r < rows; r++)
+                        std::copy(pending.spatial[r], pending.spatial[r] + cols, out[r]);
+                    sources.push_back(pendingIndex);
+                    pendingIndex = -1;
+                    pending = Frame();
+                    pixels += (long long) rows * cols;
+                    return true;
+                },
+                [&](int n, const float* const* in)
+                {
+                    const QString& path = files[sources[n]];
+                    QFileInfo input(path);
+                    QString target = outDir.filePath(
+                        resultName(path, input.completeBaseName(), rawOutput));
+                    string problem;
+
+                    result.spatial.resize(rows, cols);
+                    result.cols = cols;
+                    for (int r = 0; r < rows; r++)
+                        std::copy(in[r], in[r] + cols, result.spatial[r]);
+
+                    if (writeResult(path, target, result, rawOutput, problem))
+                        records[sources[n]] = manifestRecord(target, path, 1, result.history);
+                    else
+                    {
+                        std::lock_guard<std::mutex> lock(report);
+                        cerr << problem << endl;
+                        failed++;
+                    }
+                });
+        }
+    };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (depth > 0)
+        stacked();
+    else if (tile == 0 && jobs >= pool.size())
+        pool.parallelFor(jobs, process);
+    else
+        process(0, jobs);
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    bool manifestFailed = false;
+    if (manifest)
+    {
+        string path = outDir.filePath("manifest.csv").toStdString();
+        ofstream out(path.c_str());
+
+        out << "output,source,variant,pipeline" << endl;
+        for (int i = 0; i < jobs; i++)
+        {
+            if (!records[i].empty())
+                out << records[i] << endl;
+        }
+        if (!out)
+        {
+            cerr << path << ": cannot write" << endl;
+            manifestFailed = true;
+        }
+    }
+
+    int done = jobs - failed;
+    BufferPool::Stats buffers = BufferPool::global().stats();
+    cout << fixed << setprecision(2)
+         << "Processed " << done << " of " << jobs << " images in "
+         << seconds << " s" << endl
+         << "Throughput: " << done / seconds << " images/s, "
+         << pixels / seconds / 1e6 << " Mpixels/s" << endl
+         << "Buffers:    " << buffers.requests << " allocated, "
+         << (buffers.requests > 0 ? 100.0 * buffers.hits / buffers.requests : 0.0)
+         << "% reused from the pool, " << buffers.highWater / 1048576.0
+         << " MB at most in use" << endl;
+
+    return (failed > 0 || manifestFailed) ? 1 : 0;
+}
@@ -0,0 +1,741 @@
+/***************************************************************************//**
+ * Benchmarks.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 2, 2015
+ *
+ * Details - Defines timing runs comparing our own transforms against the ones
+ *           supplied by QtImageLib. None of these modify the current image.
+ ******************************************************************************/
+
+#include "Benchmarks.h"
+#include "GaussianSmoother.h"
+#include "Noise.h"
+#include "StackFilter.h"
+#include "TiledFilter.h"
+#include <chrono>
+#include <iomanip>
+
+/***************************************************************************//**
+ * elapsedMs
+ * Author - Dan Andrus
+ *
+ * Returns the number of milliseconds since the given start time.
+ ******************************************************************************/
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/***************************************************************************//**
+ * Menu_Benchmark_FourierTransform
+ * Author - Dan Andrus
+ *
+ * Times a forward and inverse transform through QtImageLib's fft2D, through
+ * our mixedFFT2D and through our real-input realFFT2D on square power of 2
+ * sizes, which are the only sizes fft2D supports. Reports the speedup of the
+ * real-input transform and the largest difference between the fft2D and
+ * mixedFFT2D results.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Benchmarks::Menu_Benchmark_FourierTransform(Image& image)
+{
+    static const int runs = 3;
+    int n;
+    int r;
+    int c;
+
+    cout << setw(6) << "size"
+         << setw(14) << "fft2D (ms)"
+         << setw(16) << "mixedFFT2D (ms)"
+         << setw(15) << "realFFT2D (ms)"
+         << setw(10) << "speedup"
+         << setw(14) << "max diff" << endl;
+
+    for (n = 128; n <= 2048; n *= 2)
+    {
+        Buffer2D<float> real_a(n, n);
+        Buffer2D<float> imag_a(n, n);
+        Buffer2D<float> real_b(n, n);
+        Buffer2D<float> imag_b(n, n);
+        Buffer2D<float> real_c;
+        Buffer2D<float> imag_c;
+        Buffer2D<float> spatial(n, n);
+        double best_a = 0;
+        double best_b = 0;
+        double best_c = 0;
+        double diff = 0;
+
+        for (int run = 0; run < runs; run++)
+        {
+            // Same pseudo-random intensities for both transforms
+            srand(n);
+            for (r = 0; r < n; r++)
+            {
+                for (c = 0; c < n; c++)
+                {
+                    real_a[r][c] = real_b[r][c] = spatial[r][c] = rand() % 256;
+                    imag_a[r][c] = imag_b[r][c] = 0;
+                }
+            }
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            fft2D(1, n, n, real_a.rowPointers(), imag_a.rowPointers());
+            fft2D(-1, n, n, real_a.rowPointers(), imag_a.rowPointers());
+            double time_a = elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            mixedFFT2D(1, n, n, real_b.rowPointers(), imag_b.rowPointers());
+            mixedFFT2D(-1, n, n, real_b.rowPointers(), imag_b.rowPointers());
+            double time_b = elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            realFFT2D(spatial, real_c, imag_c);
+            inverseRealFFT2D(real_c, imag_c, spatial, n);
+            double time_c = elapsedMs(start);
+
+            best_a = (run == 0) ? time_a : MIN(best_a, time_a);
+            best_b = (run == 0) ? time_b : MIN(best_b, time_b);
+            best_c = (run == 0) ? time_c : MIN(best_c, time_c);
+        }
+
+        for (r = 0; r < n; r++)
+        {
+            for (c = 0; c < n; c++)
+            {
+                diff = MAX(diff, fabs(real_a[r][c] - real_b[r][c]));
+            }
+        }
+
+        cout << setw(6) << n
+             << setw(14) << fixed << setprecision(2) << best_a
+             << setw(16) << best_b
+             << setw(15) << best_c
+             << setw(10) << best_a / best_c
+             << setw(14) << scientific << diff << endl;
+    }
+
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Benchmark_ThreadScaling
+ * Author - Dan Andrus
+ *
+ * Times a forward and inverse realFFT2D on 1K, 4K and 8K square images with
+ * every thread count from 1 up to the size of the global thread pool, and
+ * reports the speedup over a single thread. The pool is restored to its
+ * original size afterwards.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Benchmarks::Menu_Benchmark_ThreadScaling(Image& image)
+{
+    static const int sizes[] = { 1024, 4096, 8192 };
+    static const int runs = 2;
+    ThreadPool& pool = ThreadPool::global();
+    int max_threads = pool.size();
+
+    cout << setw(6) << "size"
+         << setw(9) << "threads"
+         << setw(12) << "time (ms)"
+         << setw(10) << "speedup" << endl;
+
+    for (int i = 0; i < 3; i++)
+    {
+        int n = sizes[i];
+        Buffer2D<float> spatial(n, n);
+        Buffer2D<float> real;
+        Buffer2D<float> imag;
+        double single = 0;
+
+        srand(n);
+        for (int r = 0; r < n; r++)
+        {
+            for (int c = 0; c < n; c++)
+            {
+                spatial[r][c] = rand() % 256;
+            }
+        }
+
+        for (int threads = 1; threads <= max_threads; threads++)
+        {
+            double best = 0;
+
+            pool.resize(threads);
+            for (int run = 0; run < runs; run++)
+            {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                realFFT2D(spatial, real, imag);
+                inverseRealFFT2D(real, imag, spatial, n);
+                double time = elapsedMs(start);
+
+                best = (run == 0) ? time : MIN(best, time);
+            }
+            if (threads == 1)
+                single = best;
+
+            cout << setw(6) << n
+                 << setw(9) << threads
+                 << setw(12) << fixed << setprecision(2) << best
+                 << setw(10) << single / best << endl;
+        }
+    }
+
+    pool.resize(max_threads);
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Benchmark_PlanCache
+ * Author - Dan Andrus
+ *
+ * Shows what the plan cache saves on frame sizes typical of video and
+ * scanned stills. Cold is a forward and inverse realFFT2D that has to build
+ * its four plans first, as every transform did before plans were cached; warm
+ * is the same round trip with the plans and scratch buffers already in place.
+ * 509 and 1021 are prime, so they go through Bluestein, whose plans are the
+ * most expensive to build.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Benchmarks::Menu_Benchmark_PlanCache(Image& image)
+{
+    static const int sizes[][2] = { { 256, 256 }, { 480, 640 }, { 509, 509 },
+                                    { 1080, 1920 }, { 1021, 1021 } };
+    static const int runs = 5;
+
+    cout << setw(11) << "size"
+         << setw(15) << "plans (ms)"
+         << setw(13) << "cold (ms)"
+         << setw(13) << "warm (ms)"
+         << setw(10) << "speedup" << endl;
+
+    for (int i = 0; i < 5; i++)
+    {
+        int rows = sizes[i][0];
+        int cols = sizes[i][1];
+        Buffer2D<float> spatial(rows, cols);
+        Buffer2D<float> real;
+        Buffer2D<float> imag;
+        double plans = 0;
+        double warm = 0;
+
+        srand(rows * cols);
+        for (int r = 0; r < rows; r++)
+        {
+            for (int c = 0; c < cols; c++)
+            {
+                spatial[r][c] = rand() % 256;
+            }
+        }
+
+        for (int run = 0; run < runs; run++)
+        {
+            // Uncached plans, as built by every transform before the cache
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            {
+                FFTPlan<float> forward_rows(cols, 1);
+                FFTPlan<float> forward_cols(rows, 1);
+                FFTPlan<float> inverse_rows(cols, -1);
+                FFTPlan<float> inverse_cols(rows, -1);
+            }
+            double time_plans = elapsedMs(start);
+
+            // The first run also fills the cache and scratch, so it is not timed
+            realFFT2D(spatial, real, imag);
+            inverseRealFFT2D(real, imag, spatial, cols);
+
+            start = std::chrono::steady_clock::now();
+            realFFT2D(spatial, real, imag);
+            inverseRealFFT2D(real, imag, spatial, cols);
+            double time_warm = elapsedMs(start);
+
+            plans = (run == 0) ? time_plans : MIN(plans, time_plans);
+            warm = (run == 0) ? time_warm : MIN(warm, time_warm);
+        }
+
+        cout << setw(5) << rows << " x " << setw(4) << left << cols << right
+             << setw(14) << fixed << setprecision(2) << plans
+             << setw(13) << plans + warm
+             << setw(13) << warm
+             << setw(10) << (plans + warm) / warm << endl;
+    }
+
+    cout << FFTPlan<float>::cachedPlans() << " plans cached" << endl;
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Benchmark_TiledFilter
+ * Author - Dan Andrus
+ *
+ * Filters large images once over the whole frame and once in tiles, with a
+ * Gaussian low-pass and a Wiener filter, and reports the time and the memory
+ * each needs on top of the image along with the largest difference between
+ * the two results.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Benchmarks::Menu_Benchmark_TiledFilter(Image& image)
+{
+    static const int sizes[][2] = { { 2048, 2048 }, { 3000, 4000 }, { 4096, 4096 } };
+
+    cout << setw(11) << "size"
+         << setw(10) << "filter"
+         << setw(12) << "whole (ms)"
+         << setw(12) << "tiled (ms)"
+         << setw(12) << "whole (MB)"
+         << setw(12) << "tiled (MB)"
+         << setw(8) << "tiles"
+         << setw(11) << "max diff" << endl;
+
+    for (int i = 0; i < 3; i++)
+    {
+        int rows = sizes[i][0];
+        int cols = sizes[i][1];
+        Buffer2D<float> spatial(rows, cols);
+        std::shared_ptr<TransferFunction> filters[2] =
+        {
+            std::make_shared<GaussianLowPass>(rows / 20.0),
+            std::make_shared<GaussianWiener>(rows / 8.0, 0.01, 1000000)
+        };
+        const char* names[2] = { "lowpass", "wiener" };
+
+        srand(rows * cols);
+        for (int r = 0; r < rows; r++)
+        {
+            for (int c = 0; c < cols; c++)
+            {
+                spatial[r][c] = rand() % 256;
+            }
+        }
+
+        for (int f = 0; f < 2; f++)
+        {
+            Buffer2D<float> real;
+            Buffer2D<float> imag;
+            Buffer2D<float> whole;
+            Buffer2D<float> tiled;
+            double diff = 0;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            realFFT2D(spatial, real, imag);
+            applyTransfer(*filters[f], real, imag, cols);
+            inverseRealFFT2D(real, imag, whole, cols);
+            double time_whole = elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            TiledFilter filter(*filters[f], rows, cols);
+            filter.run(spatial, tiled);
+            double time_tiled = elapsedMs(start);
+
+            for (int r = 0; r < rows; r++)
+            {
+                for (int c = 0; c < cols; c++)
+                {
+                    diff = MAX(diff, fabs(whole[r][c] - tiled[r][c]));
+                }
+            }
+
+            cout << setw(5) << rows << " x " << setw(4) << left << cols << right
+                 << setw(10) << names[f]
+                 << setw(12) << fixed << setprecision(1) << time_whole
+                 << setw(12) << time_tiled
+                 << setw(12) << (real.bytes() + imag.bytes()) / 1048576.0
+                 << setw(12) << filter.peakBytes() / 1048576.0
+                 << setw(8) << filter.tileCount()
+                 << setw(11) << setprecision(4) << diff << endl;
+        }
+    }
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Benchmark_Precision
+ * Author - Dan Andrus
+ *
+ * Runs each filter on a blurred image with the spectrum kept in double,
+ * single and half precision, and reports the time of the forward transform,
+ * filter and inverse transform, the memory the spectrum takes, and the
+ * largest and RMS difference of each result from the double precision one.
+ * The inverse and Wiener filters undo the blur with a threshold of 1000000,
+ * which is where single precision loses the most.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Benchmarks::Menu_Benchmark_Precision(Image& image)
+{
+    static const int rows = 1536;
+    static const int cols = 2048;
+    static const Precision precisions[3] =
+        { DOUBLE_PRECISION, SINGLE_PRECISION, HALF_PRECISION };
+    double blur = rows / 16.0;
+    std::shared_ptr<TransferFunction> filters[4] =
+    {
+        std::make_shared<GaussianLowPass>(rows / 20.0),
+        std::make_shared<GaussianBandReject>(rows / 16.0, rows / 8.0),
+        std::make_shared<GaussianWiener>(blur, 0.0001, 1000000),
+        std::make_shared<GaussianInverse>(blur, 1000000)
+    };
+    const char* names[4] = { "lowpass", "bandreject", "wiener", "inverse" };
+    Buffer2D<float> spatial(rows, cols);
+    Spectrum spectrum;
+
+    // Blur a random image in double precision, so the filters start from
+    // the same input whatever precision they run in
+    srand(rows * cols);
+    for (int r = 0; r < rows; r++)
+    {
+        for (int c = 0; c < cols; c++)
+        {
+            spatial[r][c] = rand() % 256;
+        }
+    }
+    spectrum.precision = DOUBLE_PRECISION;
+    spectrum.transform(spatial);
+    spectrum.apply(GaussianLowPass(blur));
+    spectrum.inverse(spatial);
+
+    cout << rows << " x " << cols << " image blurred with r=" << blur << endl
+         << setw(12) << "filter"
+         << setw(11) << "precision"
+         << setw(11) << "time (ms)"
+         << setw(11) << "MB"
+         << setw(12) << "max diff"
+         << setw(12) << "rms diff" << endl;
+
+    for (int f = 0; f < 4; f++)
+    {
+        Buffer2D<float> reference;
+
+        for (int p = 0; p < 3; p++)
+        {
+            Buffer2D<float> result;
+            double diff = 0;
+            double squares = 0;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            spectrum.precision = precisions[p];
+            spectrum.transform(spatial);
+            spectrum.apply(*filters[f]);
+            size_t bytes = spectrum.bytes();
+            spectrum.inverse(result);
+            double time = elapsedMs(start);
+
+            if (precisions[p] == DOUBLE_PRECISION)
+                reference = result;
+            for (int r = 0; r < rows; r++)
+            {
+                for (int c = 0; c < cols; c++)
+                {
+                    double d = fabs(result[r][c] - reference[r][c]);
+                    diff = MAX(diff, d);
+                    squares += d * d;
+                }
+            }
+
+            cout << setw(12) << names[f]
+                 << setw(11) << precisionName(precisions[p])
+                 << setw(11) << fixed << setprecision(1) << time
+                 << setw(11) << bytes / 1048576.0
+                 << setw(12) << setprecision(4) << diff
+                 << setw(12) << sqrt(squares / ((double) rows * cols)) << endl;
+        }
+    }
+    spectrum.release();
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Benchmark_GaussianNoise
+ * Author - Dan Andrus
+ *
+ * Adds Gaussian noise with a standard deviation of 15 to mid-gray images
+ * with QtImageLib's gaussianNoise and with addGaussianNoise, and reports the
+ * time of each along with the standard deviation of the noise they added.
+ * addGaussianNoise is run again on a single thread, and the result is
+ * checked to be identical.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Benchmarks::Menu_Benchmark_GaussianNoise(Image& image)
+{
+    static const int sizes[] = { 1024, 2048, 4096 };
+    static const double stddev = 15.0;
+    ThreadPool& pool = ThreadPool::global();
+    int max_threads = pool.size();
+
+    cout << setw(6) << "size"
+         << setw(15) << "QtImageLib (ms)"
+         << setw(10) << "ours (ms)"
+         << setw(10) << "speedup"
+         << setw(14) << "QtImageLib sd"
+         << setw(9) << "ours sd"
+         << setw(12) << "1 thread" << endl;
+
+    for (int i = 0; i < 3; i++)
+    {
+        int n = sizes[i];
+        Image gray(n, n);
+        Buffer2D<float> noisy(n, n);
+        Buffer2D<float> single(n, n);
+        double sum_theirs = 0;
+        double sum_ours = 0;
+        bool same = true;
+
+        for (int r = 0; r < n; r++)
+        {
+            for (int c = 0; c < n; c++)
+            {
+                gray[r][c].SetIntensity(128);
+                noisy[r][c] = single[r][c] = 128;
+            }
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        gaussianNoise(gray, stddev);
+        double time_theirs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        addGaussianNoise(noisy, stddev, n);
+        double time_ours = elapsedMs(start);
+
+        pool.resize(1);
+        addGaussianNoise(single, stddev, n);
+        pool.resize(max_threads);
+
+        for (int r = 0; r < n; r++)
+        {
+            for (int c = 0; c < n; c++)
+            {
+                double theirs = gray[r][c].Intensity() - 128.0;
+                double ours = noisy[r][c] - 128.0;
+                sum_theirs += theirs * theirs;
+                sum_ours += ours * ours;
+                same = same && noisy[r][c] == single[r][c];
+            }
+        }
+
+        cout << setw(6) << n
+             << setw(15) << fixed << setprecision(1) << time_theirs
+             << setw(10) << time_ours
+             << setw(10) << setprecision(2) << time_theirs / time_ours
+             << setw(14) << sqrt(sum_theirs / ((double) n * n))
+             << setw(9) << sqrt(sum_ours / ((double) n * n))
+             << setw(12) << (same ? "identical" : "DIFFERENT") << endl;
+    }
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Benchmark_GaussianSmoothing
+ * Author - Dan Andrus
+ *
+ * Smooths random images of a power of 2 and a non power of 2 size with
+ * GaussianSmoother by every method available for a range of radii, and
+ * reports the time of each and the largest difference of the convolution and
+ * recursive results from the frequency result. The method SMOOTH_AUTO would
+ * pick is marked with a '*'.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Benchmarks::Menu_Benchmark_GaussianSmoothing(Image& image)
+{
+    static const int sizes[][2] = { { 1024, 1024 }, { 1000, 1500 } };
+    static const double radii[] = { 10, 40, 160, 400 };
+    static const SmoothingMethod methods[] =
+        { SMOOTH_FREQUENCY, SMOOTH_CONVOLUTION, SMOOTH_RECURSIVE };
+
+    cout << setw(11) << "size"
+         << setw(8) << "radius"
+         << setw(13) << "method"
+         << setw(8) << "taps"
+         << setw(11) << "time (ms)"
+         << setw(12) << "max diff" << endl;
+
+    for (int s = 0; s < 2; s++)
+    {
+        int rows = sizes[s][0];
+        int cols = sizes[s][1];
+        Buffer2D<float> input(rows, cols);
+
+        for (int r = 0; r < rows; r++)
+        {
+            for (int c = 0; c < cols; c++)
+                input[r][c] = rand() % 256;
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            GaussianSmoother smoother(radii[i], rows, cols);
+            smoother.setApproximate(true);
+            SmoothingMethod picked = smoother.method();
+            Buffer2D<float> reference;
+
+            for (int m = 0; m < 3; m++)
+            {
+                std::ostringstream size;
+                size << rows << "x" << cols;
+                cout << setw(11) << size.str()
+                     << setw(8) << fixed << setprecision(0) << radii[i]
+                     << setw(12) << GaussianSmoother::name(methods[m])
+                     << (methods[m] == picked ? '*' : ' ');
+
+                if (!smoother.available(methods[m]))
+                {
+                    cout << setw(8) << "-" << setw(11) << "n/a" << endl;
+                    continue;
+                }
+
+                Buffer2D<float> result = input;
+                smoother.setMethod(methods[m]);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                smoother.run(result);
+                double time = elapsedMs(start);
+
+                double diff = 0;
+                if (methods[m] == SMOOTH_FREQUENCY)
+                    reference = result;
+                for (int r = 0; r < rows; r++)
+                {
+                    for (int c = 0; c < cols; c++)
+                        diff = MAX(diff, fabs(result[r][c] - reference[r][c]));
+                }
+
+                if (methods[m] == SMOOTH_CONVOLUTION)
+                    cout << setw(8) << 2 * smoother.kernelRadius(false) + 1;
+                else
+                    cout << setw(8) << "-";
+                cout << setw(11) << setprecision(1) << time
+                     << setw(12) << setprecision(3) << diff << endl;
+            }
+        }
+    }
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Benchmark_FrameStack
+ * Author - Dan Andrus
+ *
+ * Filters 64 random frames with a Wiener filter one frame at a time, through
+ * realFFT2D, applyTransfer and inverseRealFFT2D, and through a StackFilter of
+ * several depths, for a few frame sizes. Reports the frames filtered per
+ * second and whether the stacked results are identical to the others.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Benchmarks::Menu_Benchmark_FrameStack(Image& image)
+{
+    static const int sizes[][2] = { { 240, 320 }, { 480, 640 }, { 1080, 1920 } };
+    static const int depths[] = { 1, 4, 8, 16 };
+    static const int frames = 64;
+    GaussianWiener wiener(30, 0.01, 1000000);
+
+    cout << setw(11) << "size"
+         << setw(8) << "depth"
+         << setw(11) << "time (ms)"
+         << setw(10) << "frames/s"
+         << setw(11) << "memory MB"
+         << setw(12) << "result" << endl;
+
+    for (int s = 0; s < 3; s++)
+    {
+        int rows = sizes[s][0];
+        int cols = sizes[s][1];
+        vector<Buffer2D<float> > input(frames);
+        vector<Buffer2D<float> > single(frames);
+        std::ostringstream size;
+        size << rows << "x" << cols;
+
+        for (int n = 0; n < frames; n++)
+        {
+            input[n].resize(rows, cols);
+            for (int r = 0; r < rows; r++)
+            {
+                for (int c = 0; c < cols; c++)
+                    input[n][r][c] = rand() % 256;
+            }
+        }
+
+        single = input;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int n = 0; n < frames; n++)
+        {
+            Buffer2D<float> real;
+            Buffer2D<float> imag;
+            realFFT2D(single[n], real, imag);
+            applyTransfer(wiener, real, imag, cols);
+            inverseRealFFT2D(real, imag, single[n], cols);
+        }
+        double time = elapsedMs(start);
+
+        cout << setw(11) << size.str()
+             << setw(8) << "none"
+             << setw(11) << fixed << setprecision(1) << time
+             << setw(10) << frames * 1000.0 / time
+             << setw(11) << "-"
+             << setw(12) << "-" << endl;
+
+        for (int d = 0; d < 4; d++)
+        {
+            StackFilter filter(wiener, rows, cols, depths[d]);
+            vector<Buffer2D<float> > stacked = input;
+            bool same = true;
+
+            start = std::chrono::steady_clock::now();
+            filter.run(stacked);
+            time = elapsedMs(start);
+
+            for (int n = 0; n < frames && same; n++)
+            {
+                for (int r = 0; r < rows && same; r++)
+                    same = memcmp(stacked[n][r], single[n][r], cols * sizeof(float)) == 0;
+            }
+
+            cout << setw(11) << size.str()
+                 << setw(8) << depths[d]
+                 << setw(11) << time
+                 << setw(10) << frames * 1000.0 / time
+                 << setw(11) << filter.peakBytes() / 1048576.0
+                 << setw(12) << (same ? "identical" : "DIFFERENT") << endl;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,37 @@
+/***************************************************************************//**
+ * Benchmarks.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 2, 2015
+ *
+ * Details - Contains the declaration for the Benchmarks class.
+ ******************************************************************************/
+
+#pragma once
+#include "Toolbox.h"
+
+/***************************************************************************//**
+ * Benchmarks
+ *
+ * Author - Dan Andrus
+ *
+ * Child of QObject class.
+ *
+ * This class is responsible for timing our own implementations against the
+ * ones supplied by QtImageLib. Results are written to standard output.
+ ******************************************************************************/
+class Benchmarks : public QObject
+{
+  Q_OBJECT;
+
+  public slots:
+    bool Menu_Benchmark_FourierTransform(Image& image);
+    bool Menu_Benchmark_ThreadScaling(Image& image);
+    bool Menu_Benchmark_PlanCache(Image& image);
+    bool Menu_Benchmark_TiledFilter(Image& image);
+    bool Menu_Benchmark_Precision(Image& image);
+    bool Menu_Benchmark_GaussianNoise(Image& image);
+    bool Menu_Benchmark_GaussianSmoothing(Image& image);
+    bool Menu_Benchmark_FrameStack(Image& image);
+};
@@ -0,0 +1,846 @@
+/***************************************************************************//**
+ * Filters.cpp
+ *
+ * Author - Derek Stotz
+ *
+ * Date - April 8, 2015
+ *
+ * Method declarations for the Filters class.
+ ******************************************************************************/
+
+#include "Filters.h"
+#include "PeakDetector.h"
+#include "WienerSearch.h"
+#include <QImage>
+#include <chrono>
+
+/***************************************************************************//**
+ * singlePrecision
+ * Author - Dan Andrus
+ *
+ * Gives a spectrum in single precision and of one channel, as the searches
+ * read it: the spectrum itself if it already is, or else copy, filled with
+ * the spectrum converted by toSingle (the luminance, for color).
+ *
+ * Parameters -
+ *          data - the spectrum to read
+ *          copy - filled with the converted spectrum if one is needed
+ *
+ * Returns
+ *          data or copy
+ ******************************************************************************/
+static const Spectrum& singlePrecision(const Spectrum& data, Spectrum& copy)
+{
+    if (data.precision == SINGLE_PRECISION && data.channels == 1)
+        return data;
+
+    copy.rows = data.rows;
+    copy.cols = data.cols;
+    data.toSingle(copy.real, copy.imag);
+    return copy;
+}
+
+/***************************************************************************//**
+ * Menu_Filters_FourierTransform
+ * Author - Derek Stotz
+ *
+ * Applies the fast Fourier transform to an image and normalizes the resulting
+ * frequency data to be displayed to the user. Overwrites the original image.
+ *
+ * Parameters -
+ *          image - the image object to manipulate.
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_Transform_FourierTransform(Image& image)
+{
+    // Fails if this image's frequency info is already stored
+    return T_Session.transform(image);
+}
+
+/***************************************************************************//**
+ * Menu_Filters_InverseFourierTransform
+ * Author - Derek Stotz
+ *
+ * Applies the changes to the frequency information and recreates the original image.
+ *
+ * Parameters -
+ *          image - the image object to manipulate.
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_Transform_InverseFourierTransform(Image& image)
+{
+    // Applies any filters still waiting in the queue first
+    return T_Session.inverse(image);
+}
+
+/***************************************************************************//**
+ * Menu_Transform_QueueFilters
+ * Author - Dan Andrus
+ *
+ * Turns filter queueing on or off. While queueing, the filters only update
+ * the displayed spectrum and are collected in a queue; the frequency data is
+ * changed once, with every queued filter at the same time, when the queue is
+ * committed or the inverse transform is run.
+ *
+ * Parameters -
+ *          image - the image object (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Filters::Menu_Transform_QueueFilters(Image& image)
+{
+    bool queue = T_Queue_Filters;
+
+    if (!Dialog("Queue Filters").Add(queue, "Queue filters until committed").Show())
+        return false;
+
+    // Turning queueing off applies what was queued so far
+    if (!queue)
+        T_Session.commitAll();
+    T_Queue_Filters = queue;
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Transform_CommitFilters
+ * Author - Dan Andrus
+ *
+ * Applies every queued filter to the frequency data in a single pass over
+ * the spectrum. The display already shows their effect.
+ *
+ * Parameters -
+ *          image - the image object (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Filters::Menu_Transform_CommitFilters(Image& image)
+{
+    T_Session.commit(image);
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Filters_WienerFilter
+ * Author - Derek Stotz
+ *
+ * The user is prompted for a constant K to act as an estimation of the power spectra
+ * of the original image and noise.
+ *
+ * A weiner filter assuming a gaussian blur is then applied to the image, resulting
+ * in a partial reversal of blurring, taking into account noise.
+ * Information is still lost, and this will not always reflect general blurs, but it's a
+ * good estimation.
+ *
+ * To avoid dividing by zero, a threshold is used when calculating the weiner filter.
+ *
+ * Parameters -
+ *          image - the image object to manipulate.
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_Filters_WienerFilter(ImageHnd& hnd, QMouseEvent event)
+{
+    double threshold = 1000000;
+
+    // Last K entered, also used by the live preview during the drag
+    static double K = 0.01;
+
+    // Static variables for keeping track of stuff across runs
+    // Prevents us from using global variables
+    static CircleOverlay T_Overlay;
+    static int T_Mouse_Buttons;
+
+    double radius;
+    int origin_x;
+    int origin_y;
+
+    // Only work with Fourier transformed images
+    if (!T_Session.contains(hnd.CopyImage()))
+    {
+      return false;
+    }
+
+    Image& spectrum = hnd.CopyImage();
+    origin_x = spectrum.Width() / 2;
+    origin_y = spectrum.Height() / 2;
+
+    // Calculate distance from mouse to center of image
+    radius = sqrt(
+        pow(abs(origin_y - event.pos().y()), 2.0) +
+        pow(abs(origin_x - event.pos().x()), 2.0)
+    );
+
+    // Initial press
+    if (event.button() == Qt::LeftButton
+        && event.buttons() & Qt::LeftButton
+        && !(T_Mouse_Buttons & Qt::LeftButton))
+    {
+        // Start with no circle on the image
+        T_Overlay.begin();
+        T_Preview.start(spectrum);
+    }
+
+    // Left click drag OR initial press
+    if ((event.button() == Qt::NoButton && event.buttons() & Qt::LeftButton)
+        || (event.button() == Qt::LeftButton
+            && event.buttons() & Qt::LeftButton
+            && !(T_Mouse_Buttons & Qt::LeftButton)))
+    {
+        // Move the inverted circle on the image
+        T_Overlay.show(spectrum, origin_x, origin_y, radius);
+        T_Preview.update(make_shared<GaussianWiener>(radius, K, threshold));
+
+        T_Mouse_Buttons = event.buttons();
+        return true;
+    }
+
+    // Release
+    if (event.button() == Qt::LeftButton
+        && !(event.buttons() & Qt::LeftButton)
+        && T_Mouse_Buttons & Qt::LeftButton)
+    {
+        // Back to the spectrum as it was before the drag
+        T_Overlay.hide(spectrum);
+        T_Preview.stop();
+
+        // get estimate of power spectra
+        if (!Dialog("Power Spectra Estimation").Add(K, "K").Show())
+        {
+            T_Mouse_Buttons = event.buttons();
+            return true;
+        }
+
+        // apply wiener filter
+        T_Session.filter(spectrum, make_shared<GaussianWiener>(radius, K, threshold), NULL);
+
+        T_Mouse_Buttons = event.buttons();
+        return true;
+    }
+
+    T_Mouse_Buttons = event.buttons();
+
+  return false;
+}
+
+
+/***************************************************************************//**
+ * Menu_Filters_SpecifiedWienerFilter
+ * Author - Derek Stotz
+ *
+ * Prompts the user for a cutoff frequency in the image (assuming some kind of blurring
+ * operation was applied) and a constant K to be used for an estimation of the power specra.
+ *
+ * A weiner filter assuming a gaussian blur is then applied to the image, resulting
+ * in a partial reversal of blurring, taking into account noise.
+ * Information is still lost, and this will not always reflect general blurs, but it's a
+ * good estimation.
+ *
+ * To avoid dividing by zero, a threshold is used when calculating the weiner filter.
+ *
+ * Parameters -
+ *          image - the image object to manipulate.
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_Filters_SpecifiedWienerFilter(Image& image)
+{
+  // get threshold via a promt to the user
+  // get cutoff frequency from the user
+
+  // assumes deblurring - use a GLPF for H
+
+  // if abs(f(u,v)) <= 1/threshold
+  //   multiply the frequency value by threshold * abs(f(u,v))/f(u,v)
+  // else
+  //   multiply the frequency value by 1/(e^(-(D(u,v))^2 / 2 * (cutoff^2) ))
+
+  double threshold = 1000000;
+  double K;
+  // Static variables for keeping track of stuff across runs
+  // Prevents us from using global variables
+
+  double radius;
+
+  // Only work with Fourier transformed images
+  if (!T_Session.contains(image))
+  {
+    return false;
+  }
+
+  if (!Dialog("Cutoff Frequency").Add(radius, "Frequency").Show())
+      return false;
+
+  // get estimate of power spectra
+  if (!Dialog("Power Spectra Estimation").Add(K, "K").Show())
+      return false;
+
+  // apply wiener filter
+  return T_Session.filter(image, make_shared<GaussianWiener>(radius, K, threshold), NULL);
+
+}
+
+
+/***************************************************************************//**
+ * Menu_Filters_AutoWienerFilter
+ * Author - Dan Andrus
+ *
+ * Applies the Wiener filter with the radius and K found by a WienerSearch
+ * instead of asking for them. The user may fix the radius, and may name the
+ * file of the original, unblurred image, in which case the parameters that
+ * restore it best are searched for. Otherwise both are estimated from the
+ * image's spectrum. The search runs as a job over the spectrum with the
+ * queued filters applied, and the parameters found are printed to standard
+ * output.
+ *
+ * Parameters -
+ *          image - the image object to manipulate.
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_Filters_AutoWienerFilter(Image& image)
+{
+  double threshold = 1000000;
+  double radius = 0;
+  string reference;
+  Buffer2D<float> spatial;
+
+  // Only work with Fourier transformed images
+  if (!T_Session.contains(image))
+  {
+    return false;
+  }
+
+  if (!Dialog("Automatic Wiener Filter")
+        .Add(radius, "Radius (0 to search)")
+        .Add(reference, "Original image (optional)").Show())
+      return false;
+
+  if (!reference.empty())
+  {
+    QImage original(QString::fromStdString(reference));
+    if (original.isNull()
+        || original.width() != (int) image.Width()
+        || original.height() != (int) image.Height())
+    {
+      cout << "Cannot use " << reference << " as the original: it must be an image "
+           << "the size of this one" << endl;
+      return false;
+    }
+
+    original = original.convertToFormat(QImage::Format_RGB32);
+    spatial.resize(original.height(), original.width());
+    for (int r = 0; r < spatial.rows(); r++)
+    {
+      const QRgb* line = (const QRgb*) original.constScanLine(r);
+      for (int c = 0; c < spatial.cols(); c++)
+      {
+        spatial[r][c] = qGray(line[c]);
+      }
+    }
+  }
+
+  // Search the spectrum as it will be filtered
+  if (!T_Session.commit(image))
+    return false;
+
+  Spectrum copy;
+  const Spectrum& data = singlePrecision(T_Session.cache().spectrum(&image), copy);
+
+  WienerSearch search(data.real, data.imag, data.cols);
+  WienerCandidate best;
+  Buffer2D<float> ref_real;
+  Buffer2D<float> ref_imag;
+  search.setRadius(radius);
+  search.setThreshold(threshold);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  bool done = runJob("Automatic Wiener Filter", 2, [&](Job& job)
+  {
+    job.stage("Transforming original");
+    if (spatial.rows() > 0)
+    {
+      realFFT2D(spatial, ref_real, ref_imag);
+      search.setReference(ref_real, ref_imag);
+    }
+
+    job.stage("Searching");
+    best = search.search();
+  });
+  if (!done)
+    return false;
+
+  cout << "Wiener filter: radius " << best.radius << ", K " << best.K;
+  if (search.hasReference())
+    cout << ", PSNR " << WienerSearch::psnr(best.score) << " dB";
+  else
+    cout << ", noise " << search.noiseDeviation() << " gray levels";
+  cout << " (" << std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start).count()
+       << " ms)" << endl;
+
+  return T_Session.filter(image, make_shared<GaussianWiener>(best.radius, best.K, threshold), NULL);
+}
+
+
+/***************************************************************************//**
+ * Menu_Filters_InverseFilter
+ * Author - Derek Stotz
+ *
+ * Interactively gets a cutoff frequency from the user (assuming some kind of blurring
+ * operation was applied) via mouse input, similar to the Low Pass Filter.
+ *
+ * An inverse filter assuming a gaussian blur is then applied to the image, resulting
+ * in a partial reversal of blurring.  Information is still lost, and this will not
+ * always reflect general blurs, but it's a good estimation.
+ *
+ * To avoid dividing by zero, a threshold is used when calculating the inverse filter.
+ *
+ * Parameters -
+ *          image - the image object to manipulate.
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_Filters_InverseFilter(ImageHnd& hnd, QMouseEvent event)
+{
+  // get threshold via a promt to the user
+  // get cutoff frequency from the user
+
+  // assumes deblurring - use a GLPF for H
+
+  // if abs(f(u,v)) <= 1/threshold
+  //   multiply the frequency value by threshold * abs(f(u,v))/f(u,v)
+  // else
+  //   multiply the frequency value by 1/(e^(-(D(u,v))^2 / 2 * (cutoff^2) ))
+
+  double threshold = 1000000;
+
+  // Static variables for keeping track of stuff across runs
+  // Prevents us from using global variables
+  static CircleOverlay T_Overlay;
+  static int T_Mouse_Buttons;
+
+  double radius;
+  int origin_x;
+  int origin_y;
+
+  // Only work with Fourier transformed images
+  if (!T_Session.contains(hnd.CopyImage()))
+  {
+    return false;
+  }
+
+  Image& spectrum = hnd.CopyImage();
+  origin_x = spectrum.Width() / 2;
+  origin_y = spectrum.Height() / 2;
+
+  // Calculate distance from mouse to center of image
+  radius = sqrt(
+      pow(abs((double) (origin_y - event.pos().y())), 2.0) +
+      pow(abs((double) (origin_x - event.pos().x())), 2.0)
+  );
+
+  // Initial press
+  if (event.button() == Qt::LeftButton
+      && event.buttons() & Qt::LeftButton
+      && !(T_Mouse_Buttons & Qt::LeftButton))
+  {
+      // Start with no circle on the image
+      T_Overlay.begin();
+      T_Preview.start(spectrum);
+  }
+
+  // Left click drag OR initial press
+  if ((event.button() == Qt::NoButton && event.buttons() & Qt::LeftButton)
+      || (event.button() == Qt::LeftButton
+          && event.buttons() & Qt::LeftButton
+          && !(T_Mouse_Buttons & Qt::LeftButton)))
+  {
+      // Move the inverted circle on the image
+      T_Overlay.show(spectrum, origin_x, origin_y, radius);
+      T_Preview.update(make_shared<GaussianInverse>(radius, threshold));
+
+      T_Mouse_Buttons = event.buttons();
+      return true;
+  }
+
+  // Release
+  if (event.button() == Qt::LeftButton
+      && !(event.buttons() & Qt::LeftButton)
+      && T_Mouse_Buttons & Qt::LeftButton)
+  {
+      // Back to the spectrum as it was before the drag
+      T_Overlay.hide(spectrum);
+      T_Preview.stop();
+
+      // apply inverse filter
+      T_Session.filter(spectrum, make_shared<GaussianInverse>(radius, threshold), NULL);
+
+      T_Mouse_Buttons = event.buttons();
+      return true;
+  }
+
+  T_Mouse_Buttons = event.buttons();
+
+  return false;
+
+}
+
+/***************************************************************************//**
+ * Menu_Filters_SpecifiedInverseFilter
+ * Author - Derek Stotz
+ *
+ * Prompts the user for a cutoff frequency in the image (assuming some kind of blurring
+ * operation was applied).
+ *
+ * An inverse filter assuming a gaussian blur is then applied to the image, resulting
+ * in a partial reversal of blurring.  Information is still lost, and this will not
+ * always reflect general blurs, but it's a good estimation.
+ *
+ * To avoid dividing by zero, a threshold is used when calculating the inverse filter.
+ *
+ * Parameters -
+ *          image - the image object to manipulate.
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_Filters_SpecifiedInverseFilter(Image& image)
+{
+  // get threshold via a promt to the user
+  // get cutoff frequency from the user
+
+  // assumes deblurring - use a GLPF for H
+
+  // if abs(f(u,v)) <= 1/threshold
+  //   multiply the frequency value by threshold * abs(f(u,v))/f(u,v)
+  // else
+  //   multiply the frequency value by 1/(e^(-(D(u,v))^2 / 2 * (cutoff^2) ))
+
+  double threshold = 1000000;
+
+  // Static variables for keeping track of stuff across runs
+  // Prevents us from using global variables
+
+  double radius;
+
+  // Only work with Fourier transformed images
+  if (!T_Session.contains(image))
+  {
+    return false;
+  }
+
+  if (!Dialog("Cutoff Frequency").Add(radius, "Frequency").Show())
+      return false;
+
+  // apply inverse filter
+  return T_Session.filter(image, make_shared<GaussianInverse>(radius, threshold), NULL);
+
+}
+
+/***************************************************************************//**
+ * Menu_BandReject
+ * Author - Daniel Andrus
+ *
+ * Allows the user to interactivally apply a band-reject filter on the frequency
+ * data of an image. After using the mouse to specify a band range, the user
+ * asks whether to use a Gaussian function or an ideal band-reject filter. Then
+ * applies either an ideal band-pass filter or a Gaussian band-reject filter
+ * based on the user's choise.
+ *
+ * Parameters
+ *          hnd - Handle for the image object to manipulate
+ *          event - The mouse event object containing event data
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_BandReject( ImageHnd &hnd, QMouseEvent event )
+{
+    // Static variables for keeping track of stuff across runs
+    // Prevents us from using global var
+    static CircleOverlay T_Overlay;
+    static int T_Mouse_Buttons;
+    
+    static double lower_bound;
+    static double upper_bound;
+    
+    int origin_x;
+    int origin_y;
+    bool ideal;
+    
+    double radius;
+    
+    // Only work with Fourier transformed images
+    if (!T_Session.contains(hnd.CopyImage()))
+    {
+      return false;
+    }
+    
+    Image& spectrum = hnd.CopyImage();
+    origin_x = spectrum.Width() / 2;
+    origin_y = spectrum.Height() / 2;
+    
+    // Calculate distance from mouse to center of image
+    radius = sqrt(
+        pow(abs(origin_y - event.pos().y()), 2.0) +
+        pow(abs(origin_x - event.pos().x()), 2.0)
+    );
+    
+    // Initial press
+    if (event.button() == Qt::LeftButton
+        && event.buttons() & Qt::LeftButton
+        && !(T_Mouse_Buttons & Qt::LeftButton))
+    {
+        // Start with no circles on the image
+        T_Overlay.begin();
+        T_Preview.start(spectrum);
+        
+        // Store lower bound
+        lower_bound = radius;
+    }
+
+    // Left click drag OR initial press
+    if ((event.button() == Qt::NoButton && event.buttons() & Qt::LeftButton)
+        || (event.button() == Qt::LeftButton
+            && event.buttons() & Qt::LeftButton
+            && !(T_Mouse_Buttons & Qt::LeftButton)))
+    {
+        // Move the inverted circles on the image. The one at the lower bound
+        // is only drawn once
+        T_Overlay.show(spectrum, origin_x, origin_y, radius, 0);
+        T_Overlay.show(spectrum, origin_x, origin_y, lower_bound, 1);
+        
+        // The preview assumes Gaussian, the mode is chosen on release
+        T_Preview.update(make_shared<GaussianBandReject>(MIN(radius, lower_bound),
+                                                         MAX(radius, lower_bound)));
+        
+        T_Mouse_Buttons = event.buttons();
+        return true;
+    }
+    
+    // Release
+    if (event.button() == Qt::LeftButton
+        && !(event.buttons() & Qt::LeftButton)
+        && T_Mouse_Buttons & Qt::LeftButton)
+    {
+        // Back to the spectrum as it was before the drag
+        T_Overlay.hide(spectrum);
+        T_Preview.stop();
+        
+        // Make sure lower_bound is min radius and upper_bound is max radius
+        upper_bound = MAX(radius, lower_bound);
+        lower_bound = MIN(radius, lower_bound);
+        
+        // Ask user whether or not to use Gaussian or ideal band-pass filter
+        QMessageBox msgBox;
+        msgBox.setWindowTitle("Choose mode");
+        msgBox.setText("Gaussian or Ideal? (Yes for Gaussian)");
+        msgBox.setStandardButtons(QMessageBox::Yes
+                                  |QMessageBox::No
+                                  |QMessageBox::Cancel);
+        msgBox.setDefaultButton(QMessageBox::Yes);
+        
+        // Display popup box to user
+        int result = msgBox.exec();
+        
+        // If user cancelled out, cancel everything
+        if (result == QMessageBox::Cancel)
+        {
+            T_Mouse_Buttons = event.buttons();
+            return true;
+        }
+        
+        ideal = (result == QMessageBox::No);
+        
+        // Apply band-reject fitler to image
+        if (ideal)
+            T_Session.filter(spectrum, make_shared<IdealBandReject>(lower_bound, upper_bound), &spectrum);
+        else
+            T_Session.filter(spectrum, make_shared<GaussianBandReject>(lower_bound, upper_bound), &spectrum);
+        
+        T_Mouse_Buttons = event.buttons();
+        return true;
+    }
+    
+    T_Mouse_Buttons = event.buttons();
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_SpotReject
+ * Author - Daniel Andrus
+ *
+ * Allows the user to interactivly remove spots of frequency data from an image.
+ * Users can use this to manually remove periodic noise from an image
+ *
+ * Parameters
+ *          hnd - Handle for the image object to manipulate
+ *          event - The mouse event object containing event data
+ *
+ * Returns
+ *          True if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_SpotReject( ImageHnd &hnd, QMouseEvent event )
+{
+    // Static variables for keeping track of stuff across runs
+    // Prevents us from using global variables
+    static CircleOverlay T_Overlay;
+    static int T_Mouse_X;
+    static int T_Mouse_Y;
+    static int T_Mouse_Buttons;
+    
+    double radius;
+
+    int origin_x;
+    int origin_y;
+    
+    // Only work with Fourier transformed images
+    if (!T_Session.contains(hnd.CopyImage()))
+    {
+        return false;
+    }
+
+    Image& spectrum = hnd.CopyImage();
+
+    // Initial press
+    if (event.button() == Qt::LeftButton
+      && event.buttons() & Qt::LeftButton
+      && !(T_Mouse_Buttons & Qt::LeftButton))
+    {
+        T_Mouse_X = event.pos().x();
+        T_Mouse_Y = event.pos().y();
+
+        // Start with no circle on the image
+        T_Overlay.begin();
+        T_Preview.start(spectrum);
+    }
+
+    radius = sqrt(
+        pow(T_Mouse_X - event.pos().x(), 2) +
+        pow(T_Mouse_Y - event.pos().y(), 2)
+    );
+
+    // Drag (and initial press)
+    if ((event.button() == Qt::NoButton && event.buttons() & Qt::LeftButton)
+        || (event.button() == Qt::LeftButton
+            && event.buttons() & Qt::LeftButton
+            && !(T_Mouse_Buttons & Qt::LeftButton)))
+    {
+        // Move the circle around the spot
+        T_Overlay.show(spectrum, T_Mouse_X, T_Mouse_Y, radius);
+        T_Preview.update(make_shared<GaussianSpotReject>(T_Mouse_Y - spectrum.Height() / 2,
+                                                         T_Mouse_X - spectrum.Width() / 2,
+                                                         radius));
+
+        T_Mouse_Buttons = event.buttons();
+        return true;
+    }
+
+    // Release
+    if (event.button() == Qt::LeftButton
+      && !(event.buttons() & Qt::LeftButton)
+      && T_Mouse_Buttons & Qt::LeftButton)
+    {
+        // Back to the spectrum as it was before the drag
+        T_Overlay.hide(spectrum);
+        T_Preview.stop();
+
+        origin_x = spectrum.Width() / 2;
+        origin_y = spectrum.Height() / 2;
+
+        // Gaussian removal. Frequency data of a real image is symmetric, so
+        // the spot mirrored across the center is removed along with it
+        T_Session.filter(spectrum,
+                         make_shared<GaussianSpotReject>(T_Mouse_Y - origin_y,
+                                                         T_Mouse_X - origin_x,
+                                                         radius), &spectrum);
+
+        T_Mouse_Buttons = event.buttons();
+        return true;
+    }
+
+    T_Mouse_Buttons = event.buttons();
+
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Filters_AutoNotchFilter
+ * Author - Dan Andrus
+ *
+ * Removes periodic noise without clicking on its spikes: a PeakDetector finds
+ * the spikes in the spectrum, with the queued filters applied, and a
+ * Gaussian notch is placed on each one and its mirror. The notches are
+ * applied together as one GaussianNotchBank, which only touches the
+ * frequencies near them. The peaks found are printed to standard output.
+ *
+ * Parameters -
+ *          image - the frequency image to filter
+ *
+ * Returns
+ *          true if successful, false if not
+ ******************************************************************************/
+bool Filters::Menu_Filters_AutoNotchFilter(Image& image)
+{
+    static double threshold = DEFAULT_PEAK_THRESHOLD;
+    static double radius = DEFAULT_PEAK_NOTCH_RADIUS;
+    static int max_peaks = DEFAULT_MAX_PEAKS;
+    vector<SpectrumPeak> peaks;
+
+    // Only work with Fourier transformed images
+    if (!T_Session.contains(image))
+    {
+        return false;
+    }
+
+    if (!Dialog("Automatic Notch Filter")
+            .Add(threshold, "Threshold (times the median)", 1.0, 1000.0)
+            .Add(radius, "Notch radius", 0.5, 100.0)
+            .Add(max_peaks, "Most peaks", 1, 1000).Show())
+        return false;
+
+    // Look for peaks in the spectrum as it will be filtered
+    if (!T_Session.commit(image))
+        return false;
+
+    Spectrum copy;
+    const Spectrum& data = singlePrecision(T_Session.cache().spectrum(&image), copy);
+
+    PeakDetector detector;
+    detector.setThreshold(threshold);
+    detector.setMaxPeaks(max_peaks);
+
+    bool done = runJob("Automatic Notch Filter", 1, [&](Job& job)
+    {
+        job.stage("Finding peaks");
+        peaks = detector.detect(data.real, data.imag, data.cols);
+    });
+    if (!done)
+        return false;
+
+    if (peaks.empty())
+    {
+        cout << "No periodic noise peaks found" << endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < peaks.size(); i++)
+    {
+        cout << "Peak at fx " << peaks[i].fx << ", fy " << peaks[i].fy
+             << ", " << peaks[i].ratio << " times the median" << endl;
+    }
+
+    return T_Session.filter(image,
+                            make_shared<GaussianNotchBank>(PeakDetector::notches(peaks, radius)),
+                            &image);
+}
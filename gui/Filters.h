@@ -30,11 +30,15 @@ class Filters : public QObject
   public slots:
     bool Menu_Transform_FourierTransform(Image& image);
     bool Menu_Transform_InverseFourierTransform(Image& image);
+    bool Menu_Transform_QueueFilters(Image& image);
+    bool Menu_Transform_CommitFilters(Image& image);
     bool Menu_Filters_SpecifiedWienerFilter(Image& image);
+    bool Menu_Filters_AutoWienerFilter(Image& image);
     bool Menu_Filters_WienerFilter(ImageHnd& hnd, QMouseEvent event);
     bool Menu_Filters_InverseFilter(ImageHnd& hnd, QMouseEvent event);
     bool Menu_Filters_SpecifiedInverseFilter(Image& image);
     bool Menu_BandReject( ImageHnd &hnd, QMouseEvent event );
     bool Menu_SpotReject( ImageHnd &hnd, QMouseEvent event );
+    bool Menu_Filters_AutoNotchFilter(Image& image);
 };
 
@@ -12,6 +12,17 @@
  ******************************************************************************/
 
 #include "NoiseSmoothing.h"
+#include "GaussianSmoother.h"
+#include "Noise.h"
+#include <chrono>
+
+// One bin of the half spectrum raised by Menu_AddNoise
+struct NoisePoint
+{
+    int u;
+    int v;
+    float value;
+};
 
 /***************************************************************************//**
  * Menu_LowPass
@@ -33,36 +44,39 @@ bool NoiseSmoothing::Menu_LowPass( ImageHnd &hnd, QMouseEvent event )
 {
     // Static variables for keeping track of stuff across runs
     // Prevents us from using global variables
-    static Image T_Image_Original;
+    static CircleOverlay T_Overlay;
     static int T_Mouse_Buttons;
     
-    Image copy;    
-    
-    double radius_div;
     double radius;
-    double r;
-    float adjustment;
     
     int origin_x;
     int origin_y;
     bool ideal;
     
-    unsigned int x;
-    unsigned int y;
-    
     // Only work with Fourier transformed images
-    if (!T_Frequency_Set)
+    if (!T_Session.contains(hnd.CopyImage()))
     {
       return false;
     }
     
+    Image& spectrum = hnd.CopyImage();
+    origin_x = spectrum.Width() / 2;
+    origin_y = spectrum.Height() / 2;
+    
+    // Calculate distance from mouse to center of image
+    radius = sqrt(
+        pow(abs(origin_y - event.pos().y()), 2.0) +
+        pow(abs(origin_x - event.pos().x()), 2.0)
+    );
+    
     // Initial press
     if (event.button() == Qt::LeftButton
         && event.buttons() & Qt::LeftButton
         && !(T_Mouse_Buttons & Qt::LeftButton))
     {
-        // Store original image
-        T_Image_Original = hnd.CopyImage();
+        // Start with no circle on the image
+        T_Overlay.begin();
+        T_Preview.start(spectrum);
     }
 
     // Left click drag OR initial press
@@ -71,23 +85,12 @@ bool NoiseSmoothing::Menu_LowPass( ImageHnd &hnd, QMouseEvent event )
             && event.buttons() & Qt::LeftButton
             && !(T_Mouse_Buttons & Qt::LeftButton)))
     {
-        // Draw circle on stored original image
-        copy = T_Image_Original;
-        
-        origin_x = copy.Width() / 2;
-        origin_y = copy.Height() / 2;
+        // Move the inverted circle on the image
+        T_Overlay.show(spectrum, origin_x, origin_y, radius);
         
-        // Calculate distance from mouse to center of image
-        radius = sqrt(
-            pow(abs(origin_y - event.pos().y()), 2.0) +
-            pow(abs(origin_x - event.pos().x()), 2.0)
-        );
+        // The preview assumes Gaussian, the mode is chosen on release
+        T_Preview.update(make_shared<GaussianLowPass>(radius));
         
-        // Draw an inverted circle on the image
-        drawCircle(copy, origin_x, origin_y, radius, 1.0);
-        
-        // Apply changes to our main image
-        hnd.CopyImage() = copy;
         T_Mouse_Buttons = event.buttons();
         return true;
     }
@@ -97,17 +100,9 @@ bool NoiseSmoothing::Menu_LowPass( ImageHnd &hnd, QMouseEvent event )
         && !(event.buttons() & Qt::LeftButton)
         && T_Mouse_Buttons & Qt::LeftButton)
     {
-        // Work with copy of original image
-        copy = T_Image_Original;
-        
-        origin_x = copy.Width() / 2;
-        origin_y = copy.Height() / 2;
-        
-        // Calculate distance from mouse to center of image
-        radius = sqrt(
-            pow(abs(origin_y - event.pos().y()), 2.0) +
-            pow(abs(origin_x - event.pos().x()), 2.0)
-        );
+        // Back to the spectrum as it was before the drag
+        T_Overlay.hide(spectrum);
+        T_Preview.stop();
         
         // Ask user whether or not to use Gaussian or ideal band-pass filter
         QMessageBox msgBox;
@@ -124,64 +119,20 @@ bool NoiseSmoothing::Menu_LowPass( ImageHnd &hnd, QMouseEvent event )
         // If user cancelled out, cancel everything
         if (result == QMessageBox::Cancel)
         {
-            hnd.CopyImage() = T_Image_Original;
             T_Mouse_Buttons = event.buttons();
             return true;
         }
         
         ideal = (result == QMessageBox::No);
         
-        // Calculate divisor for gaussian reject filter
-        if (!ideal)
-        {
-            radius_div = pow(radius, 2.0) * 2.0;
-        }
-        
         // Apply low-pass filter to data
-        for (y = 0; y < copy.Height(); y++)
-        {
-            for (x = 0; x < copy.Width(); x++)
-            {
-                r = sqrt(
-                    pow(abs((double) origin_y - y), 2.0) +
-                    pow(abs((double) origin_x - x), 2.0)
-                );
-                
-                if (ideal)
-                {
-                    // Zero out data outside of range
-                    if (r > radius)
-                    {
-                        copy[y][x].SetIntensity(0);
-                        
-                        T_Image_Freal
-                            [(y + origin_y) % copy.Height()]
-                            [(x + origin_x) % copy.Width()] = 0;
-                        T_Image_Fimag
-                            [(y + origin_y) % copy.Height()]
-                            [(x + origin_x) % copy.Width()] = 0;
-                    }
-                }
-                else
-                {
-                    // Apply Gaussian adjustment to imagebased on range
-                    adjustment = exp(-pow(r, 2.0) / radius_div); 
-                    
-                    copy[y][x] = copy[y][x] * adjustment;
-                    
-                    T_Image_Freal
-                        [(y + origin_y) % copy.Height()]
-                        [(x + origin_x) % copy.Width()] *= adjustment;
-                    T_Image_Fimag
-                        [(y + origin_y) % copy.Height()]
-                        [(x + origin_x) % copy.Width()] *= adjustment;
-                }
-            }
-        }
+        if (ideal)
+            T_Session.filter(spectrum, make_shared<IdealLowPass>(radius), &spectrum);
+        else
+            T_Session.filter(spectrum, make_shared<GaussianLowPass>(radius), &spectrum);
         
         cout << "Low-pass radius: " << radius << endl;
         
-        hnd.CopyImage() = copy;
         T_Mouse_Buttons = event.buttons();
         return true;
     }
@@ -191,13 +142,85 @@ bool NoiseSmoothing::Menu_LowPass( ImageHnd &hnd, QMouseEvent event )
     return false;
 }
 
+/***************************************************************************//**
+ * smoothSpatial
+ * Author - Dan Andrus
+ *
+ * Applies a low-pass filter to an image that has not been transformed. The
+ * Gaussian filter is run by a GaussianSmoother, which convolves the image
+ * instead of transforming it when that is cheaper; the ideal filter is
+ * always run through the transforms. The method used and the time taken are
+ * printed.
+ *
+ * Parameters -
+ *          image - the image to smooth
+ *          radius - the cutoff frequency
+ *          ideal - true for the ideal filter, false for the Gaussian one
+ *          approximate - true to allow the recursive Gaussian
+ *
+ * Returns
+ *          true if successful, false if cancelled
+ ******************************************************************************/
+static bool smoothSpatial(Image& image, double radius, bool ideal, bool approximate)
+{
+    int rows = image.Height();
+    int cols = image.Width();
+    Buffer2D<float> spatial(rows, cols);
+    GaussianSmoother smoother(radius, rows, cols);
+    smoother.setApproximate(approximate);
+    const char* method = GaussianSmoother::name(ideal ? SMOOTH_FREQUENCY : smoother.method());
+
+    for (int r = 0; r < rows; r++)
+    {
+        for (int c = 0; c < cols; c++)
+        {
+            spatial[r][c] = image[r][c].Intensity();
+        }
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool done = runJob("Low-Pass Filter", 1, [&](Job& job)
+    {
+        job.stage("Smoothing");
+        if (!ideal)
+        {
+            smoother.run(spatial);
+            return;
+        }
+
+        Buffer2D<float> real;
+        Buffer2D<float> imag;
+        realFFT2D(spatial, real, imag);
+        applyTransfer(IdealLowPass(radius), real, imag, cols);
+        inverseRealFFT2D(real, imag, spatial, cols);
+    });
+    if (!done)
+        return false;
+
+    cout << "Low-pass radius: " << radius << " (" << method << " method, "
+         << std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count()
+         << " ms)" << endl;
+
+    for (int r = 0; r < rows; r++)
+    {
+        for (int c = 0; c < cols; c++)
+        {
+            image[r][c].SetIntensity(MIN(MAX(lround(spatial[r][c]), 0), 255));
+        }
+    }
+    return true;
+}
+
 /***************************************************************************//**
  * Menu_SpecifiedLowPass
  * Author - Dan Andrus, Derek Stotz
  *
- * Smooths an image by transforming it into the frequency domain and applying
- * a low-pass filter to the frequency information. Gets the cutoff frequency from
- * the user. Asks the user whether to use an ideal or gaussian low-pass filter.
+ * Smooths an image by applying a low-pass filter to its frequency
+ * information. Gets the cutoff frequency from the user. Asks the user whether
+ * to use an ideal or gaussian low-pass filter. A transformed image is
+ * filtered in place; any other image is smoothed directly by smoothSpatial,
+ * in which case the user may also allow the approximate recursive Gaussian.
  *
  * Parameters
  *          image - The image object
@@ -209,34 +232,19 @@ bool NoiseSmoothing::Menu_SpecifiedLowPass( Image &image )
 {
     // Static variables for keeping track of stuff across runs
     // Prevents us from using global variables
+    static bool approximate = false;
 
-    Image copy;
-
-    double radius_div;
     double radius;
-    double r;
-    float adjustment;
 
-    int origin_x;
-    int origin_y;
     bool ideal;
 
-    unsigned int x;
-    unsigned int y;
-
-    // Only work with Fourier transformed images
-    if (!T_Frequency_Set)
-    {
-      return false;
-    }
-
-    // Work with copy of original image
-    copy = image;
-
-    origin_x = copy.Width() / 2;
-    origin_y = copy.Height() / 2;
+    bool spatial = !T_Session.contains(image);
 
-    if (!Dialog("Cutoff Frequency").Add(radius, "Frequency").Show())
+    Dialog dialog("Cutoff Frequency");
+    dialog.Add(radius, "Frequency");
+    if (spatial)
+        dialog.Add(approximate, "Allow approximation");
+    if (!dialog.Show())
         return false;
 
     // Ask user whether or not to use Gaussian or ideal band-pass filter
@@ -259,54 +267,13 @@ bool NoiseSmoothing::Menu_SpecifiedLowPass( Image &image )
 
     ideal = (result == QMessageBox::No);
 
-    // Calculate divisor for gaussian reject filter
-    if (!ideal)
-    {
-        radius_div = pow(radius, 2.0) * 2.0;
-    }
+    if (spatial)
+        return smoothSpatial(image, radius, ideal, approximate);
 
-    // Apply low-pass filter to data
-    for (y = 0; y < copy.Height(); y++)
-    {
-        for (x = 0; x < copy.Width(); x++)
-        {
-            r = sqrt(
-                pow(abs((double) origin_y - y), 2.0) +
-                pow(abs((double) origin_x - x), 2.0)
-            );
-
-            if (ideal)
-            {
-                // Zero out data outside of range
-                if (r > radius)
-                {
-                    copy[y][x].SetIntensity(0);
-
-                    T_Image_Freal
-                        [(y + origin_y) % copy.Height()]
-                        [(x + origin_x) % copy.Width()] = 0;
-                    T_Image_Fimag
-                        [(y + origin_y) % copy.Height()]
-                        [(x + origin_x) % copy.Width()] = 0;
-                }
-            }
-            else
-            {
-                // Apply Gaussian adjustment to imagebased on range
-                adjustment = exp(-pow(r, 2.0) / radius_div);
-
-                copy[y][x] = copy[y][x] * adjustment;
-
-                T_Image_Freal
-                    [(y + origin_y) % copy.Height()]
-                    [(x + origin_x) % copy.Width()] *= adjustment;
-                T_Image_Fimag
-                    [(y + origin_y) % copy.Height()]
-                    [(x + origin_x) % copy.Width()] *= adjustment;
-            }
-        }
-    }
-    return true;
+    // Apply low-pass filter to data and show it on the displayed spectrum
+    if (ideal)
+        return T_Session.filter(image, make_shared<IdealLowPass>(radius), &image);
+    return T_Session.filter(image, make_shared<GaussianLowPass>(radius), &image);
 }
 
 /***************************************************************************//**
@@ -326,28 +293,25 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
 {
     // Static variables for keeping track of stuff across runs
     // Prevents us from using global variables
-    static Image T_Image_Original;
+    static CircleOverlay T_Overlay;
     static int T_Mouse_Buttons;
     
     static const int preview_radius = 5;
     
-    Image copy;
-    
-    int origin_x;
-    int origin_y;
-    
     double rad;
     double radius;
     double intensity;
     
     unsigned int x;
     unsigned int y;
+    int u;
+    int v;
     int r;
     int c;
     
     
     // Only work with Fourier transformed images
-    if (!T_Frequency_Set)
+    if (!T_Session.contains(hnd.CopyImage()))
     {
       return false;
     }
@@ -357,8 +321,8 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
         && event.buttons() & Qt::LeftButton
         && !(T_Mouse_Buttons & Qt::LeftButton))
     {
-        // Store original image
-        T_Image_Original = hnd.CopyImage();
+        // Start with no circles on the image
+        T_Overlay.begin();
     }
 
     // Left click drag OR initial press
@@ -367,27 +331,21 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
             && event.buttons() & Qt::LeftButton
             && !(T_Mouse_Buttons & Qt::LeftButton)))
     {
-        // Draw circle on stored original image
-        copy = T_Image_Original;
-        
-        origin_x = copy.Width() / 2;
-        origin_y = copy.Height() / 2;
+        Image& spectrum = hnd.CopyImage();
         
-        // Draw an inverted circle on the image under mouse
-        //   and mirror circle across center of image
-        drawCircle(copy,
+        // Move the inverted circle under the mouse
+        //   and its mirror across center of image
+        T_Overlay.show(spectrum,
             event.pos().x(),
             event.pos().y(),
-            preview_radius, 1.0
+            preview_radius, 0
         );
-        drawCircle(copy,
-            copy.Width() - event.pos().x(),
-            copy.Height() - event.pos().y(),
-            preview_radius, 1.0
+        T_Overlay.show(spectrum,
+            spectrum.Width() - event.pos().x(),
+            spectrum.Height() - event.pos().y(),
+            preview_radius, 1
         );
         
-        // Apply changes to our main image
-        hnd.CopyImage() = copy;
         T_Mouse_Buttons = event.buttons();
         return true;
     }
@@ -397,11 +355,10 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
         && !(event.buttons() & Qt::LeftButton)
         && T_Mouse_Buttons & Qt::LeftButton)
     {
-        // Work with copy of original image
-        copy = T_Image_Original;
-        
-        origin_x = copy.Width() / 2;
-        origin_y = copy.Height() / 2;
+        // Back to the spectrum as it was before the drag, then draw the
+        // noise straight onto it
+        Image& copy = hnd.CopyImage();
+        T_Overlay.hide(copy);
         
         // Calculate distance from mouse to center of image
         radius = 1;
@@ -414,6 +371,13 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
         }
         else
         {
+            // Bins to raise, kept so the change can be replayed if the
+            // spectrum is ever rebuilt
+            shared_ptr<vector<NoisePoint> > points = make_shared<vector<NoisePoint> >();
+
+            // Tables of spectrum positions for this image size
+            const FrequencyGeometry& geom = FrequencyGeometry::get(copy.Height(), copy.Width());
+
             for (y = (unsigned int) (event.pos().y() - radius - 1);
                 y < (unsigned int) (event.pos().y() + radius + 1);
                 y++)
@@ -435,15 +399,18 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
                         copy[r][c].SetIntensity(
                             MAX((255*intensity)*(1.0-rad/radius), copy[r][c].Intensity()));
                         
-                        // Cooresponding place in frequency data
-                        r = (r + origin_y) % copy.Height();
-                        c = (c + origin_x) % copy.Width();
-                        
-                        // Apply linear gradient
-                        T_Image_Freal[r][c] = MAX((65535.0*intensity)*(1.0-rad/radius),
-                                                  T_Image_Freal[r][c]);
-                        T_Image_Fimag[r][c] = MAX((65535.0*intensity)*(1.0-rad/radius),
-                                                  T_Image_Freal[r][c]);
+                        // Cooresponding place in frequency data. Only the
+                        // stored half is written, the mirror covers the rest
+                        if (!geom.mirroredCol[c])
+                        {
+                            u = geom.spectrumRow[r];
+                            v = geom.spectrumCol[c];
+
+                            // Apply linear gradient
+                            NoisePoint point = { u, v,
+                                (float) ((65535.0*intensity)*(1.0-rad/radius)) };
+                            points->push_back(point);
+                        }
                         
                         // Mirror across center of image
                         r = copy.Height() - y;
@@ -453,21 +420,35 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
                         copy[r][c].SetIntensity(
                             MAX((255*intensity)*(1.0-rad/radius), copy[r][c].Intensity()));
                         
-                        // Cooresponding place in frequency data
-                        r = (r + origin_y) % copy.Height();
-                        c = (c + origin_x) % copy.Width();
-                        
-                        // Apply linear gradient
-                        T_Image_Freal[r][c] = MAX((65535.0*intensity)*(1.0-rad/radius),
-                                                  T_Image_Freal[r][c]);
-                        T_Image_Fimag[r][c] = MAX((65535.0*intensity)*(1.0-rad/radius),
-                                                  T_Image_Freal[r][c]);
+                        // Cooresponding place in frequency data. Only the
+                        // stored half is written, the mirror covers the rest
+                        if (!geom.mirroredCol[c])
+                        {
+                            u = geom.spectrumRow[r];
+                            v = geom.spectrumCol[c];
+
+                            // Apply linear gradient
+                            NoisePoint point = { u, v,
+                                (float) ((65535.0*intensity)*(1.0-rad/radius)) };
+                            points->push_back(point);
+                        }
                     }
                 }
             }
+
+            // Queued filters come before the noise
+            T_Session.edit(hnd.CopyImage(),
+                [points](Buffer2D<float>& real, Buffer2D<float>& imag, int cols)
+                {
+                    for (size_t i = 0; i < points->size(); i++)
+                    {
+                        const NoisePoint& p = (*points)[i];
+                        real[p.u][p.v] = MAX(p.value, real[p.u][p.v]);
+                        imag[p.u][p.v] = MAX(p.value, real[p.u][p.v]);
+                    }
+                });
         }
         
-        hnd.CopyImage() = copy;
         T_Mouse_Buttons = event.buttons();
         return true;
     }
@@ -479,9 +460,13 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
 
 /***************************************************************************//**
  * Menu_Noise_GaussianNoise
- * Author - Derek Stotz
+ * Author - Derek Stotz, Dan Andrus
  *
- * Adds Gaussian Noise to an image.  Asks the user for a standard devaition.
+ * Adds Gaussian Noise to an image.  Asks the user for a standard devaition
+ * and a seed. The noise comes from addGaussianNoise, so the same seed gives
+ * the same noise on an image of the same size. The seed offered goes up by
+ * one after every use, so applying the noise twice does not add the same
+ * noise twice.
  *
  * Parameters -
             image - the image object to manipulate.
@@ -491,13 +476,35 @@ bool NoiseSmoothing::Menu_AddNoise( ImageHnd &hnd, QMouseEvent event )
  ******************************************************************************/
 bool NoiseSmoothing::Menu_Noise_GaussianNoise(Image &image)
 {
+    static int seed = 1;
     double stddev = 15.0;
+    int rows = image.Height();
+    int cols = image.Width();
 
     // Propt user for standard deviation
-    if (!Dialog("Gaussian Noise").Add(stddev, "Standard Deviation").Show())
+    if (!Dialog("Gaussian Noise").Add(stddev, "Standard Deviation")
+                                 .Add(seed, "Seed").Show())
       return false;
 
-   gaussianNoise(image, stddev);
+   Buffer2D<float> spatial(rows, cols);
+   for (int r = 0; r < rows; r++)
+   {
+       for (int c = 0; c < cols; c++)
+       {
+           spatial[r][c] = image[r][c].Intensity();
+       }
+   }
+
+   addGaussianNoise(spatial, stddev, (uint32_t) seed);
+   seed++;
+
+   for (int r = 0; r < rows; r++)
+   {
+       for (int c = 0; c < cols; c++)
+       {
+           image[r][c].SetIntensity(MIN(MAX(lround(spatial[r][c]), 0), 255));
+       }
+   }
    return true;
 }
 
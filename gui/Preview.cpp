@@ -0,0 +1,143 @@
+/***************************************************************************//**
+ * Preview.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 19, 2015
+ *
+ * Details - Defines the LivePreview class.
+ ******************************************************************************/
+
+#include "Toolbox.h"
+#include <QImage>
+#include <QLabel>
+#include <QPixmap>
+#include <QTimer>
+
+// How often the GUI thread looks for a finished preview, in milliseconds
+static const int POLL_INTERVAL = 15;
+
+LivePreview::LivePreview()
+    : window(NULL), timer(NULL), active(false), frames(0), total_ms(0)
+{
+}
+
+/***************************************************************************//**
+ * start
+ * Author - Dan Andrus
+ *
+ * Begins previewing filters on an image in the frequency domain. Does
+ * nothing unless live preview is turned on.
+ *
+ * Parameters -
+ *          image - the displayed spectrum of the image
+ ******************************************************************************/
+void LivePreview::start(const Image& image)
+{
+    if (!T_Live_Preview || !T_Session.contains(image))
+        return;
+
+    if (!proxy)
+        proxy.reset(new ProxyPreview());
+    if (window == NULL)
+    {
+        window = new QLabel();
+        window->setWindowTitle("Live Preview");
+        window->setScaledContents(true);
+        timer = new QTimer(this);
+        connect(timer, SIGNAL(timeout()), this, SLOT(poll()));
+    }
+
+    proxy->setSource(T_Session.cache().spectrum(&image));
+    queued = std::make_shared<TransferChain>(T_Session.queued(image));
+
+    active = true;
+    frames = 0;
+    total_ms = 0;
+    timer->start(POLL_INTERVAL);
+}
+
+/***************************************************************************//**
+ * update
+ * Author - Dan Andrus
+ *
+ * Asks for a preview of the image with one more filter applied, replacing
+ * the previous request. Returns right away.
+ *
+ * Parameters -
+ *          transfer - the filter at the current mouse position
+ ******************************************************************************/
+void LivePreview::update(const std::shared_ptr<const TransferFunction>& transfer)
+{
+    if (!active)
+        return;
+
+    std::shared_ptr<TransferChain> chain = std::make_shared<TransferChain>(*queued);
+    chain->add(transfer);
+    proxy->request(chain);
+}
+
+/***************************************************************************//**
+ * stop
+ * Author - Dan Andrus
+ *
+ * Ends the drag. The last preview asked for is still shown once it is done,
+ * after which the timer stops.
+ ******************************************************************************/
+void LivePreview::stop()
+{
+    if (!active)
+        return;
+
+    active = false;
+    if (frames > 0)
+    {
+        cout << "Live preview: " << frames << " frames, mean "
+             << total_ms / frames << " ms" << endl;
+    }
+}
+
+/***************************************************************************//**
+ * poll
+ * Author - Dan Andrus
+ *
+ * Shows the newest finished preview, if there is one, scaled to 0-255 the
+ * same way the inverse transform stores intensities.
+ ******************************************************************************/
+void LivePreview::poll()
+{
+    Buffer2D<float> result;
+    double ms;
+
+    if (!proxy->take(result, ms))
+    {
+        if (!active && !proxy->busy())
+            timer->stop();
+        return;
+    }
+
+    int rows = result.rows();
+    int cols = result.cols();
+    QImage picture(cols, rows, QImage::Format_RGB32);
+
+    for (int r = 0; r < rows; r++)
+    {
+        QRgb* line = (QRgb*) picture.scanLine(r);
+        for (int c = 0; c < cols; c++)
+        {
+            int value = (int) (result[r][c] + 0.5f);
+            value = MIN(255, MAX(0, value));
+            line[c] = qRgb(value, value, value);
+        }
+    }
+
+    window->setPixmap(QPixmap::fromImage(picture));
+    if (!window->isVisible())
+    {
+        window->resize(2 * cols, 2 * rows);
+        window->show();
+    }
+
+    frames++;
+    total_ms += ms;
+}
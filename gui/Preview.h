@@ -0,0 +1,59 @@
+/***************************************************************************//**
+ * Preview.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 19, 2015
+ *
+ * Details - Contains the LivePreview class, a small window showing what the
+ *           filter being dragged will do to the image.
+ ******************************************************************************/
+#pragma once
+#include <qtimagelib.h>
+#include <memory>
+#include "ProxyPreview.h"
+
+class QLabel;
+class QTimer;
+
+/***************************************************************************//**
+ * LivePreview
+ *
+ * Author - Dan Andrus
+ *
+ * Child of QObject class.
+ *
+ * While the user drags an interactive filter with live preview turned on,
+ * each new position of the filter is applied to a ProxyPreview of the image's
+ * spectrum, together with any filters still queued, and the resulting small
+ * image is shown in a window of its own. Results are picked up by a timer on
+ * the GUI thread, so the drag never waits for them; positions the preview
+ * thread has not reached by the time a newer one arrives are skipped.
+ *
+ * The window and the preview thread are created the first time they are
+ * needed. The window is never deleted, since the global LivePreview outlives
+ * the QApplication.
+ ******************************************************************************/
+class LivePreview : public QObject
+{
+  Q_OBJECT;
+
+  public:
+    LivePreview();
+
+    void start(const Image& image);
+    void update(const std::shared_ptr<const TransferFunction>& transfer);
+    void stop();
+
+  private slots:
+    void poll();
+
+  private:
+    std::unique_ptr<ProxyPreview> proxy;
+    std::shared_ptr<TransferChain> queued;
+    QLabel* window;
+    QTimer* timer;
+    bool active;
+    int frames;
+    double total_ms;
+};
@@ -0,0 +1,550 @@
+/***************************************************************************//**
+ * Session.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 18, 2015
+ *
+ * Details - Defines the FrequencySession class.
+ ******************************************************************************/
+
+#include "Toolbox.h"
+
+// Pixels along each side of the grid sampled to recognize a displayed
+// spectrum, and how far each may drift before it no longer counts as the same
+static const int SIGNATURE_SIDE = 32;
+static const int SIGNATURE_TOLERANCE = 2;
+
+FrequencySession::FrequencySession()
+    : spectra(SpectrumCache::defaultBudget(), SpectrumCache::defaultPrecision())
+{
+}
+
+/***************************************************************************//**
+ * clampChannel
+ * Author - Dan Andrus
+ *
+ * Rounds a color channel value to the nearest whole number from 0 to 255.
+ ******************************************************************************/
+static int clampChannel(float value)
+{
+    return MIN(MAX((int) lround(value), 0), 255);
+}
+
+/***************************************************************************//**
+ * sample
+ * Author - Dan Andrus
+ *
+ * Returns the intensities of a SIGNATURE_SIDE x SIGNATURE_SIDE grid of pixels
+ * spread evenly over an image, row by row.
+ ******************************************************************************/
+static std::vector<unsigned char> sample(const Image& image)
+{
+    std::vector<unsigned char> values;
+    int rows = image.Height();
+    int cols = image.Width();
+
+    values.reserve(SIGNATURE_SIDE * SIGNATURE_SIDE);
+    for (int i = 0; i < SIGNATURE_SIDE; i++)
+    {
+        int y = (2 * i + 1) * rows / (2 * SIGNATURE_SIDE);
+        for (int j = 0; j < SIGNATURE_SIDE; j++)
+        {
+            int x = (2 * j + 1) * cols / (2 * SIGNATURE_SIDE);
+            values.push_back(image[y][x].Intensity());
+        }
+    }
+    return values;
+}
+
+/***************************************************************************//**
+ * contains
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          true if the image is in the frequency domain
+ ******************************************************************************/
+bool FrequencySession::contains(const Image& image)
+{
+    std::lock_guard<std::mutex> lock(guard);
+    return find(image) != NULL;
+}
+
+/***************************************************************************//**
+ * transform
+ * Author - Dan Andrus
+ *
+ * Runs the forward transform on an image, keeps a copy of the image for the
+ * inverse transform and draws the spectrum in its place. While
+ * T_Color_Channels is set, the red, green and blue channels are transformed
+ * instead of the intensity.
+ *
+ * Parameters -
+ *          image - the image to transform, replaced by its spectrum
+ *
+ * Returns
+ *          true if successful, false if the image is already transformed or
+ *          the transform was cancelled
+ ******************************************************************************/
+bool FrequencySession::transform(Image& image)
+{
+    SpectrumCache::Key key = &image;
+    int channels = T_Color_Channels ? 3 : 1;
+    Image shown;
+
+    if (contains(image))
+        return false;
+
+    bool done = runJob("Fourier Transform", 2, [&](Job& job)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        Entry& entry = entries[key];
+
+        try
+        {
+            entry.spatial = image;
+            shown = image;
+
+            // The spectrum is read from the stored copy, so the cache can
+            // rebuild it after the displayed image has become the spectrum
+            const Image* source = &entry.spatial;
+            job.stage("Transforming");
+            spectra.insert(key, image.Height(), image.Width(),
+                [source, channels](Buffer2D<float>& spatial)
+                {
+                    int rows = spatial.rows() / channels;
+                    for (int r = 0; r < rows; r++)
+                    {
+                        for (int c = 0; c < spatial.cols(); c++)
+                        {
+                            const Pixel& pixel = (*source)[r][c];
+                            if (channels == 1)
+                            {
+                                spatial[r][c] = pixel.Intensity();
+                                continue;
+                            }
+                            spatial[r][c] = pixel.Red();
+                            spatial[rows + r][c] = pixel.Green();
+                            spatial[2 * rows + r][c] = pixel.Blue();
+                        }
+                    }
+                }, channels);
+
+            spectra.setKeptBytes(key, (size_t) image.Height() * image.Width()
+                                          * sizeof(Pixel));
+
+            job.stage("Drawing spectrum");
+            entry.view.render(spectra.spectrum(key));
+            drawSpectrum(shown, entry.view);
+            entry.signature = sample(shown);
+        }
+        catch (...)
+        {
+            spectra.remove(key);
+            entries.erase(key);
+            throw;
+        }
+    });
+
+    if (done)
+        image = shown;
+    return done;
+}
+
+/***************************************************************************//**
+ * inverse
+ * Author - Dan Andrus
+ *
+ * Applies any queued filters, runs the inverse transform and puts the new
+ * intensities, or colors, into a copy of the stored image, which then
+ * replaces the displayed spectrum. The image's frequency data is dropped.
+ *
+ * Parameters -
+ *          image - the displayed spectrum, replaced by the result
+ *
+ * Returns
+ *          true if successful, false if the image is not transformed or the
+ *          inverse transform was cancelled
+ ******************************************************************************/
+bool FrequencySession::inverse(Image& image)
+{
+    SpectrumCache::Key key = &image;
+    Image result;
+
+    if (!contains(image))
+        return false;
+
+    bool done = runJob("Inverse Fourier Transform", 3, [&](Job& job)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        Entry& entry = entries.at(key);
+        int rows = entry.spatial.Height();
+        int cols = entry.spatial.Width();
+        Buffer2D<float> spatial;
+
+        job.stage("Applying queued filters");
+        commit(key, entry);
+
+        // The inverse transform works in place, so from here on a cancelled
+        // job leaves the spectrum to be rebuilt
+        job.stage("Inverse transform");
+        Spectrum& data = spectra.spectrum(key);
+        try
+        {
+            data.inverse(spatial);
+
+            job.stage("Writing image");
+            result = entry.spatial;
+            for (int r = 0; r < rows; r++)
+            {
+                for (int c = 0; c < cols; c++)
+                {
+                    if (data.channels == 1)
+                        result[r][c].SetIntensity(spatial[r][c]);
+                    else
+                        result[r][c].SetRGB(clampChannel(spatial[r][c]),
+                                            clampChannel(spatial[rows + r][c]),
+                                            clampChannel(spatial[2 * rows + r][c]));
+                }
+                Job::report(r + 1, rows);
+            }
+        }
+        catch (...)
+        {
+            spectra.discard(key);
+            throw;
+        }
+
+        spectra.remove(key);
+        entries.erase(key);
+    });
+
+    if (done)
+        image = result;
+    return done;
+}
+
+/***************************************************************************//**
+ * filter
+ * Author - Dan Andrus
+ *
+ * Applies a transfer function to the frequency data of an image and, if given
+ * a displayed spectrum, redraws the bins it changes so the user sees what was
+ * removed. The rest of the display is left as it is, and keeps the
+ * brightness scale it was drawn with when the image was transformed.
+ *
+ * While T_Queue_Filters is set the frequency data is left alone and the
+ * filter is added to the image's queue instead, to be applied together with
+ * the rest of the queue by commit(). The display is still updated right away.
+ *
+ * Parameters -
+ *          image - the transformed image
+ *          transfer - the transfer function to apply
+ *          display - the displayed spectrum to update, or NULL
+ *
+ * Returns
+ *          true if successful, false if the filter was cancelled
+ ******************************************************************************/
+bool FrequencySession::filter(const Image& image,
+                              const std::shared_ptr<const TransferFunction>& transfer,
+                              Image* display)
+{
+    SpectrumCache::Key key = &image;
+    bool queue = T_Queue_Filters;
+    Image shaded;
+
+    if (!contains(image))
+        return false;
+
+    bool done = runJob("Filter", 1, [&](Job& job)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        Entry& entry = entries.at(key);
+        int rows = entry.spatial.Height();
+        int cols = entry.spatial.Width();
+        const FrequencyGeometry& geom = FrequencyGeometry::get(rows, cols);
+
+        job.stage("Filtering");
+        if (display == NULL)
+        {
+            // The view is not told, so it reads the spectrum again when next
+            // drawn
+            entry.stale = true;
+            if (!queue)
+            {
+                spectra.applyTransfer(key, transfer);
+                return;
+            }
+            entry.queue.add(transfer);
+            cout << entry.queue.size() << " filter(s) queued" << endl;
+            return;
+        }
+
+        refresh(key, entry);
+        shaded = *display;
+        try
+        {
+            if (queue)
+            {
+                Buffer2D<float> h(1, geom.halfCols);
+                int first;
+                int end;
+                for (int u = 0; u < rows; u++)
+                {
+                    if (transfer->evaluateSpan(geom, u, h[0], first, end))
+                    {
+                        entry.view.scaleSpan(u, h[0], first, end);
+                        drawSpan(shaded, entry.view, u, first, end);
+                    }
+                    Job::report(u + 1, rows);
+                }
+                entry.queue.add(transfer);
+                cout << entry.queue.size() << " filter(s) queued" << endl;
+                return;
+            }
+
+            spectra.applyTransfer(key, transfer,
+                [&](int u, const float* h)
+                {
+                    int first;
+                    int end;
+                    if (SpectrumRenderer::changedSpan(h, geom.halfCols, first, end))
+                    {
+                        entry.view.scaleSpan(u, h, first, end);
+                        drawSpan(shaded, entry.view, u, first, end);
+                    }
+                });
+        }
+        catch (...)
+        {
+            // Part of the view was scaled for a display that is thrown away
+            entry.stale = true;
+            throw;
+        }
+    });
+
+    if (done && display != NULL)
+    {
+        *display = shaded;
+
+        // The sample describes the image's own window, which a display
+        // elsewhere leaves as it was
+        if (display == &image)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            entries.at(key).signature = sample(shaded);
+        }
+    }
+    return done;
+}
+
+/***************************************************************************//**
+ * edit
+ * Author - Dan Andrus
+ *
+ * Makes a change to the frequency data of an image that is not a transfer
+ * function, after applying any queued filters. The change is recorded so it
+ * can be made again if the spectrum is ever rebuilt.
+ *
+ * Returns
+ *          true if successful, false if the change was cancelled
+ ******************************************************************************/
+bool FrequencySession::edit(const Image& image, const SpectrumCache::Edit& change)
+{
+    SpectrumCache::Key key = &image;
+
+    if (!contains(image))
+        return false;
+
+    bool done = runJob("Edit Spectrum", 2, [&](Job& job)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+
+        job.stage("Applying queued filters");
+        commit(key, entries.at(key));
+        job.stage("Editing spectrum");
+        entries.at(key).stale = true;
+        spectra.applyEdit(key, change);
+    });
+
+    // The tools that edit draw the change on the image themselves
+    if (done)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        entries.at(key).signature = sample(image);
+    }
+    return done;
+}
+
+/***************************************************************************//**
+ * commit
+ * Author - Dan Andrus
+ *
+ * Applies every filter queued for an image in a single pass over its
+ * spectrum and empties the queue.
+ *
+ * Returns
+ *          true if successful, false if cancelled
+ ******************************************************************************/
+bool FrequencySession::commit(const Image& image)
+{
+    SpectrumCache::Key key = &image;
+
+    if (queued(image).empty())
+        return true;
+
+    return runJob("Commit Filters", 1, [&](Job& job)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+
+        job.stage("Applying queued filters");
+        commit(key, entries.at(key));
+    });
+}
+
+/***************************************************************************//**
+ * commitAll
+ * Author - Dan Andrus
+ *
+ * Applies the queued filters of every transformed image. Images whose
+ * filters were applied before a cancel keep them applied.
+ *
+ * Returns
+ *          true if successful, false if cancelled
+ ******************************************************************************/
+bool FrequencySession::commitAll()
+{
+    std::map<SpectrumCache::Key, Entry>::iterator it;
+    int waiting = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        for (it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (!it->second.queue.empty())
+                waiting++;
+        }
+    }
+    if (waiting == 0)
+        return true;
+
+    return runJob("Commit Filters", waiting, [&](Job& job)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+
+        for (it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (it->second.queue.empty())
+                continue;
+
+            job.stage("Applying queued filters");
+            commit(it->first, it->second);
+        }
+    });
+}
+
+/***************************************************************************//**
+ * queued
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the filters queued for an image and not yet applied, or an empty
+ *          chain if the image is not transformed
+ ******************************************************************************/
+TransferChain FrequencySession::queued(const Image& image)
+{
+    std::lock_guard<std::mutex> lock(guard);
+    Entry* entry = find(image);
+
+    return (entry != NULL) ? entry->queue : TransferChain();
+}
+
+/***************************************************************************//**
+ * find
+ * Author - Dan Andrus
+ *
+ * Looks up the entry of an image, checking that it belongs to this image
+ * rather than to one closed earlier at the same address: the dimensions must
+ * match, and at least three quarters of the sampled pixels must be within
+ * SIGNATURE_TOLERANCE of the spectrum last drawn. An entry that fails is
+ * dropped along with its spectrum. The caller holds the mutex.
+ *
+ * Returns
+ *          the entry, or NULL if the image is not transformed
+ ******************************************************************************/
+FrequencySession::Entry* FrequencySession::find(const Image& image)
+{
+    std::map<SpectrumCache::Key, Entry>::iterator it = entries.find(&image);
+
+    if (it == entries.end())
+        return NULL;
+
+    Entry& entry = it->second;
+    if (image.Height() == entry.spatial.Height()
+        && image.Width() == entry.spatial.Width())
+    {
+        std::vector<unsigned char> now = sample(image);
+        size_t same = 0;
+
+        for (size_t i = 0; i < now.size() && i < entry.signature.size(); i++)
+        {
+            if (abs((int) now[i] - (int) entry.signature[i]) <= SIGNATURE_TOLERANCE)
+                same++;
+        }
+        if (4 * same >= 3 * now.size())
+            return &entry;
+    }
+
+    cout << "Dropping frequency data left by a closed image" << endl;
+    spectra.remove(it->first);
+    entries.erase(it);
+    return NULL;
+}
+
+/***************************************************************************//**
+ * commit
+ * Author - Dan Andrus
+ *
+ * Applies the queue of one entry. The queue is only emptied once the filters
+ * are applied, so a cancelled commit can be run again. The caller holds the
+ * mutex.
+ ******************************************************************************/
+void FrequencySession::commit(SpectrumCache::Key key, Entry& entry)
+{
+    if (entry.queue.empty())
+        return;
+
+    cout << "Applying " << entry.queue.size() << " queued filter(s)" << endl;
+    spectra.applyTransfer(key, std::make_shared<TransferChain>(entry.queue));
+    entry.queue.clear();
+}
+
+/***************************************************************************//**
+ * refresh
+ * Author - Dan Andrus
+ *
+ * Brings a stale view up to date: reads the spectrum again, keeping the
+ * brightness scale, and scales it by the queued filters. The caller holds
+ * the mutex.
+ ******************************************************************************/
+void FrequencySession::refresh(SpectrumCache::Key key, Entry& entry)
+{
+    if (!entry.stale)
+        return;
+
+    entry.view.reload(spectra.spectrum(key));
+    if (!entry.queue.empty())
+    {
+        const FrequencyGeometry& geom = entry.view.geometry();
+        Buffer2D<float> h(1, geom.halfCols);
+        int first;
+        int end;
+        for (int u = 0; u < geom.rows; u++)
+        {
+            entry.queue.evaluateRow(geom, u, h[0]);
+            if (SpectrumRenderer::changedSpan(h[0], geom.halfCols, first, end))
+                entry.view.scaleSpan(u, h[0], first, end);
+        }
+    }
+    entry.stale = false;
+}
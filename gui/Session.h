@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * Session.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 18, 2015
+ *
+ * Details - Contains the FrequencySession class, which keeps the frequency
+ *           data of every open image that has been transformed.
+ ******************************************************************************/
+#pragma once
+#include <qtimagelib.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "SpectrumCache.h"
+#include "SpectrumRenderer.h"
+#include "Transfer.h"
+
+/***************************************************************************//**
+ * FrequencySession
+ *
+ * Author - Dan Andrus
+ *
+ * Tracks which images are in the frequency domain. Each transformed image
+ * keeps a copy of its spatial image, for the inverse transform, and its own
+ * queue of filters waiting to be committed. The spectra themselves live in a
+ * SpectrumCache, which drops the least recently used ones when they exceed
+ * its memory budget and rebuilds them from the spatial image when that image
+ * is worked on again.
+ *
+ * Images are identified by the address of the Image object shown in their
+ * window: the Image& passed to menu functions, or hnd.CopyImage() in
+ * interactive ones. An entry lasts until the image is transformed back.
+ * QtImageLib does not say when a window closes, so an entry can outlive its
+ * image, and another image can later be given the same address. Each entry
+ * therefore also keeps the dimensions of its image and a sample of the
+ * spectrum last drawn in its place, taken whenever the session draws it.
+ * An image found under an entry's address is only taken for that entry if
+ * its size matches and most of the sample still does, which leaves room for
+ * the circles and noise the interactive tools draw over the spectrum. An
+ * entry that does not match is dropped.
+ *
+ * The copy of the original image kept by each entry is counted against the
+ * SpectrumCache's budget, leaving less of it for spectra.
+ *
+ * Each entry also keeps a SpectrumRenderer, which draws the displayed
+ * spectrum and redraws only the bins a filter changes. Queued filters are
+ * drawn as soon as they are queued. A change the renderer was not shown, such
+ * as an edit or a filter applied without a display, marks it stale, and it
+ * reads the spectrum again, with the queue on top, before it is next used.
+ *
+ * Transforms, filters and edits run as jobs through runJob(), so the user can
+ * follow and cancel them. They return false if cancelled, in which case the
+ * image, its display and its frequency data are left as they were. The work
+ * itself runs on the job's thread while holding the session's mutex, which
+ * the quick queries take as well. cache() is meant for the GUI thread and
+ * must not be used while a job runs; since jobs run one at a time behind a
+ * modal dialog, nothing on the GUI thread can reach it then anyway.
+ ******************************************************************************/
+class FrequencySession
+{
+  public:
+    FrequencySession();
+
+    bool contains(const Image& image);
+    bool transform(Image& image);
+    bool inverse(Image& image);
+
+    bool filter(const Image& image,
+                const std::shared_ptr<const TransferFunction>& transfer,
+                Image* display);
+    bool edit(const Image& image, const SpectrumCache::Edit& change);
+    bool commit(const Image& image);
+    bool commitAll();
+    TransferChain queued(const Image& image);
+
+    SpectrumCache& cache() { return spectra; }
+
+  private:
+    struct Entry
+    {
+        Entry() : stale(false) {}
+
+        Image spatial;
+        TransferChain queue;
+        std::vector<unsigned char> signature;   // sample of the display
+        SpectrumRenderer view;      // the displayed spectrum, queue included
+        bool stale;                 // view no longer matches the spectrum
+    };
+
+    Entry* find(const Image& image);
+    void commit(SpectrumCache::Key key, Entry& entry);
+    void refresh(SpectrumCache::Key key, Entry& entry);
+
+    mutable std::mutex guard;       // held while entries or spectra are used
+    std::map<SpectrumCache::Key, Entry> entries;
+    SpectrumCache spectra;
+};
@@ -0,0 +1,197 @@
+/***************************************************************************//**
+ * Settings.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 14, 2015
+ *
+ * Details - Defines the menu options of the Settings class. None of these
+ *           modify the current image.
+ ******************************************************************************/
+
+#include "Settings.h"
+
+/***************************************************************************//**
+ * Menu_Settings_ThreadCount
+ * Author - Dan Andrus
+ *
+ * Asks the user how many threads the transforms should use and resizes the
+ * global thread pool to match. The starting value comes from the
+ * PROG3_THREADS environment variable, or the number of hardware threads.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Settings::Menu_Settings_ThreadCount(Image& image)
+{
+    int threads = ThreadPool::global().size();
+
+    if (!Dialog("Thread Count").Add(threads, "Threads", 1, 256).Show())
+        return false;
+
+    ThreadPool::global().resize(threads);
+    cout << "Using " << ThreadPool::global().size() << " threads" << endl;
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Settings_SpectrumMemory
+ * Author - Dan Andrus
+ *
+ * Asks the user how much memory, in megabytes, the frequency data of all
+ * transformed images, and the copies of the original images kept for their
+ * inverse transforms, may use. Spectra beyond that are dropped, least recently
+ * used first, and rebuilt when their image is worked on again. The starting
+ * value comes from the PROG3_SPECTRUM_MB environment variable, or 1024.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Settings::Menu_Settings_SpectrumMemory(Image& image)
+{
+    SpectrumCache& cache = T_Session.cache();
+    int megabytes = (int) (cache.budget() / (1024 * 1024));
+
+    if (!Dialog("Spectrum Memory").Add(megabytes, "Megabytes", 1, 65536).Show())
+        return false;
+
+    cache.setBudget((size_t) megabytes * 1024 * 1024);
+    cout << "Spectra use " << cache.residentBytes() / (1024 * 1024)
+         << " MB and the original images " << cache.keptBytes() / (1024 * 1024)
+         << " MB of " << megabytes << " MB, " << cache.evictions()
+         << " spectra dropped so far" << endl;
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Settings_SpectrumPrecision
+ * Author - Dan Andrus
+ *
+ * Asks the user how many bits each value of the frequency data should take:
+ * 16 (half), 32 (single) or 64 (double). Double precision keeps the inverse
+ * and Wiener filters free of the noise float rounding leaves at high
+ * thresholds, at twice the memory. Spectra already in memory are rebuilt in
+ * the new precision, filters and edits included, when next used. The
+ * starting value comes from the PROG3_PRECISION environment variable, or 32.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Settings::Menu_Settings_SpectrumPrecision(Image& image)
+{
+    SpectrumCache& cache = T_Session.cache();
+    int bits = (int) precisionBytes(cache.precision()) * 8;
+
+    if (!Dialog("Spectrum Precision").Add(bits, "Bits (16, 32 or 64)", 16, 64).Show())
+        return false;
+
+    if (bits < 24)
+        cache.setPrecision(HALF_PRECISION);
+    else if (bits < 48)
+        cache.setPrecision(SINGLE_PRECISION);
+    else
+        cache.setPrecision(DOUBLE_PRECISION);
+    cout << "Spectra are kept in " << precisionName(cache.precision())
+         << " precision" << endl;
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Settings_LivePreview
+ * Author - Dan Andrus
+ *
+ * Turns the live preview on or off. While it is on, dragging the low-pass,
+ * band-reject, Wiener, inverse or spot-reject tool shows a small version of
+ * the filtered image in a separate window, updated as the mouse moves.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Settings::Menu_Settings_LivePreview(Image& image)
+{
+    bool live = T_Live_Preview;
+
+    if (!Dialog("Live Preview").Add(live, "Preview filters while dragging").Show())
+        return false;
+
+    T_Live_Preview = live;
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Settings_ColorChannels
+ * Author - Dan Andrus
+ *
+ * Turns color transforms on or off. While on, the Fourier transform keeps the
+ * spectra of the red, green and blue channels instead of the intensity alone,
+ * every filter is applied to all three and the inverse transform gives back a
+ * color image. The spectrum shown is that of the intensity. Color spectra
+ * take three times the memory; the three channels are transformed together,
+ * which costs less than three separate transforms. Images already
+ * transformed keep the mode they were transformed in.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Settings::Menu_Settings_ColorChannels(Image& image)
+{
+    bool color = T_Color_Channels;
+
+    if (!Dialog("Color Channels").Add(color, "Transform red, green and blue").Show())
+        return false;
+
+    T_Color_Channels = color;
+    cout << "Transforms keep " << (color ? "the color channels" : "the intensity only")
+         << endl;
+    return false;
+}
+
+/***************************************************************************//**
+ * Menu_Settings_BufferPool
+ * Author - Dan Andrus
+ *
+ * Prints how well the buffer pool has done so far: the share of buffers
+ * handed out again rather than allocated, and the most memory in buffers at
+ * once. Then asks the user how many megabytes of freed buffers the pool may
+ * keep for reuse; 0 frees them all and turns the pool off. The starting
+ * value comes from the PROG3_POOL_MB environment variable, or 256.
+ *
+ * Parameters -
+ *          image - the current image (unused)
+ *
+ * Returns
+ *          false, since the image is never modified
+ ******************************************************************************/
+bool Settings::Menu_Settings_BufferPool(Image& image)
+{
+    BufferPool& pool = BufferPool::global();
+    BufferPool::Stats stats = pool.stats();
+    int megabytes = (int) (pool.limit() / (1024 * 1024));
+
+    cout << "Buffer pool: " << stats.requests << " buffers, "
+         << (stats.requests > 0 ? 100.0 * stats.hits / stats.requests : 0.0)
+         << "% reused, " << stats.highWater / (1024 * 1024) << " MB at most in use, "
+         << stats.retained / (1024 * 1024) << " MB kept in " << stats.blocks
+         << " free buffers" << endl;
+
+    if (!Dialog("Buffer Pool").Add(megabytes, "Megabytes kept for reuse", 0, 65536).Show())
+        return false;
+
+    pool.setLimit((size_t) megabytes * 1024 * 1024);
+    return false;
+}
@@ -0,0 +1,35 @@
+/***************************************************************************//**
+ * Settings.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 14, 2015
+ *
+ * Details - Contains the declaration for the Settings class.
+ ******************************************************************************/
+
+#pragma once
+#include "Toolbox.h"
+
+/***************************************************************************//**
+ * Settings
+ *
+ * Author - Dan Andrus
+ *
+ * Child of QObject class.
+ *
+ * This class is responsible for options that change how the program runs
+ * rather than what it does to an image.
+ ******************************************************************************/
+class Settings : public QObject
+{
+  Q_OBJECT;
+
+  public slots:
+    bool Menu_Settings_ThreadCount(Image& image);
+    bool Menu_Settings_SpectrumMemory(Image& image);
+    bool Menu_Settings_SpectrumPrecision(Image& image);
+    bool Menu_Settings_LivePreview(Image& image);
+    bool Menu_Settings_ColorChannels(Image& image);
+    bool Menu_Settings_BufferPool(Image& image);
+};
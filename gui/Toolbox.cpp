@@ -0,0 +1,326 @@
+#include "Toolbox.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <QCoreApplication>
+#include <QProgressDialog>
+
+FrequencySession T_Session;
+bool T_Queue_Filters;
+LivePreview T_Preview;
+bool T_Live_Preview;
+bool T_Color_Channels;
+
+// How long an operation runs before its progress dialog appears, and how
+// often the GUI thread checks on it, in milliseconds
+static const int PROGRESS_DELAY = 300;
+static const int PROGRESS_POLL = 20;
+static const int PROGRESS_STEPS = 1000;
+
+/***************************************************************************//**
+ * drawCircle
+ * Author - Dan Andrus
+ *
+ * Draws a circle on an image object. Circle is an inverted color circle,
+ * meaning each pixel that lies on the circle will have its colors and
+ * intensities inverted. Drawing the same circle twice restores the image.
+ *
+ * Only the pixels of each row that can lie on the circle are visited, so the
+ * cost grows with the circumference rather than the area of the circle.
+ *
+ * Parameters -
+ *          image - The image object to manipulate
+ *          x - The column that the origin of the circle lies on
+ *          y - The row that the origin of the circle lies on
+ *          radius - The radius of the circle to draw
+ *          thickness - The thickness in pixels to draw the border of the circle
+ ******************************************************************************/
+void drawCircle(Image& image, int x, int y, int radius, double thickness)
+{
+  int i, j, k;
+  int olimit;           // outer limit of rows
+  int first, last;      // range of column offsets that may be on the circle
+  double outer = radius + thickness / 2.0;
+  double inner = radius - thickness / 2.0;
+  
+  olimit = radius + thickness + 1;
+  
+  for (i = (y - olimit); i <= (y + olimit); i++)
+  {
+    // Double-check y boundaries
+    if (i < 0 || i >= (int) image.Height()) continue;
+    
+    double dy2 = pow(i - y, 2);
+    if (dy2 > outer * outer) continue;
+    
+    // Offsets inside the inner edge or outside the outer edge are skipped;
+    // the ones in between are checked exactly
+    last = (int) sqrt(outer * outer - dy2) + 1;
+    first = (inner > 0 && dy2 < inner * inner) ? (int) sqrt(inner * inner - dy2) : 0;
+    
+    for (k = first; k <= last; k++)
+    {
+      // Left and right of the center, once when k is 0
+      for (j = x - k; j <= x + k; j += MAX(2 * k, 1))
+      {
+        // Double check x boundaries
+        if (j < 0 || j >= (int) image.Width()) continue;
+        
+        if (abs(sqrt(pow(i - y, 2) + pow(j - x, 2)) - radius) <= (thickness / 2.0))
+        {
+          image[i][j].SetRGB(255-image[i][j].Red(),
+                            255-image[i][j].Green(),
+                            255-image[i][j].Blue());
+        }
+      }
+    }
+  }
+}
+
+CircleOverlay::CircleOverlay()
+{
+  begin();
+}
+
+/***************************************************************************//**
+ * CircleOverlay::begin
+ * Author - Dan Andrus
+ *
+ * Starts a new drag with no circles shown. Called on the initial press.
+ ******************************************************************************/
+void CircleOverlay::begin()
+{
+  for (int i = 0; i < MAX_CIRCLES; i++)
+    circles[i].drawn = false;
+
+  moves = 0;
+  total_ms = 0;
+  worst_ms = 0;
+}
+
+/***************************************************************************//**
+ * CircleOverlay::show
+ * Author - Dan Andrus
+ *
+ * Moves the circle in one slot to a new position, erasing it from its old
+ * one. Does nothing if the circle has not moved.
+ *
+ * Parameters -
+ *          image - The displayed image the circles are drawn on
+ *          x, y - The center of the circle
+ *          radius - The radius of the circle
+ *          slot - Which of the circles to move
+ ******************************************************************************/
+void CircleOverlay::show(Image& image, int x, int y, int radius, int slot)
+{
+  Circle& circle = circles[slot];
+
+  if (circle.drawn && circle.x == x && circle.y == y && circle.radius == radius)
+    return;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  if (circle.drawn)
+    drawCircle(image, circle.x, circle.y, circle.radius, 1.0);
+  drawCircle(image, x, y, radius, 1.0);
+
+  circle.x = x;
+  circle.y = y;
+  circle.radius = radius;
+  circle.drawn = true;
+
+  double ms = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+  moves++;
+  total_ms += ms;
+  worst_ms = MAX(worst_ms, ms);
+}
+
+/***************************************************************************//**
+ * CircleOverlay::hide
+ * Author - Dan Andrus
+ *
+ * Erases every circle shown, leaving the image as it was before the drag,
+ * and prints the redraw time per mouse move.
+ ******************************************************************************/
+void CircleOverlay::hide(Image& image)
+{
+  for (int i = 0; i < MAX_CIRCLES; i++)
+  {
+    if (circles[i].drawn)
+      drawCircle(image, circles[i].x, circles[i].y, circles[i].radius, 1.0);
+    circles[i].drawn = false;
+  }
+
+  if (moves > 0)
+  {
+    cout << "Preview: " << moves << " redraws, mean " << total_ms / moves
+         << " ms, worst " << worst_ms << " ms" << endl;
+  }
+  moves = 0;
+  total_ms = 0;
+  worst_ms = 0;
+}
+
+/***************************************************************************//**
+ * drawSpectrum
+ * Author - Dan Andrus
+ *
+ * Copies the picture of a SpectrumRenderer onto an image, gray levels only.
+ * Used in place of QtImageLib's dftMagnitude, which recomputes the transform
+ * itself and only works on square images whose dimensions are powers of 2.
+ *
+ * Parameters -
+ *          image - The image object to draw on, same size as the full spectrum
+ *          view - The rendered spectrum
+ ******************************************************************************/
+void drawSpectrum(Image& image, const SpectrumRenderer& view)
+{
+  const Buffer2D<unsigned char>& pixels = view.pixels();
+  int width = image.Width();
+  int height = image.Height();
+
+  for (int y = 0; y < height; y++)
+  {
+    const unsigned char* row = pixels[y];
+    for (int x = 0; x < width; x++)
+      image[y][x].SetRGB(row[x], row[x], row[x]);
+    Job::report(y + 1, height);
+  }
+}
+
+/***************************************************************************//**
+ * drawSpan
+ * Author - Dan Andrus
+ *
+ * Copies the pixels of columns first to end - 1 of row u of the half
+ * spectrum, and of their mirrors, from a SpectrumRenderer onto an image,
+ * after SpectrumRenderer::scaleSpan has redrawn them. The rest of the image
+ * is left alone.
+ ******************************************************************************/
+void drawSpan(Image& image, const SpectrumRenderer& view, int u, int first,
+              int end)
+{
+  const FrequencyGeometry& geom = view.geometry();
+  const Buffer2D<unsigned char>& pixels = view.pixels();
+  int y = geom.displayRow[u];
+  int ym = geom.displayRow[(geom.rows - u) % geom.rows];
+
+  for (int v = first; v < end; v++)
+  {
+    int x = geom.displayCol[v];
+    int value = pixels[y][x];
+    image[y][x].SetRGB(value, value, value);
+
+    // Columns 0 and cols/2 are stored for every row, mirrors included
+    if (v > 0 && 2 * v != geom.cols)
+    {
+      int xm = geom.displayCol[geom.cols - v];
+      value = pixels[ym][xm];
+      image[ym][xm].SetRGB(value, value, value);
+    }
+  }
+}
+
+/***************************************************************************//**
+ * runJob
+ * Author - Dan Andrus
+ *
+ * Runs a long operation on a thread of its own while the GUI thread keeps
+ * the event loop going. If the operation takes longer than PROGRESS_DELAY, a
+ * modal progress dialog shows how far along it is and lets the user cancel
+ * it; cancelling stops the operation at its next parallel loop range or
+ * reported row. Until the dialog is up, user input is held back so nothing
+ * else can start in the meantime.
+ *
+ * Only one job runs at a time. The work must not touch any widget, and must
+ * leave the images it was given unchanged unless it finishes, so that a
+ * cancelled operation leaves everything as it was.
+ *
+ * Parameters -
+ *          title - the name of the operation, shown on the dialog
+ *          stages - the number of times work will call job.stage()
+ *          work - the operation
+ *
+ * Returns
+ *          true if the operation finished, false if it was cancelled or
+ *          another job was already running. Any other exception thrown by
+ *          work is rethrown on the GUI thread.
+ ******************************************************************************/
+bool runJob(const char* title, int stages,
+            const std::function<void(Job& job)>& work)
+{
+  static bool running = false;
+  Job job(stages);
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool done = false;
+
+  if (running)
+  {
+    cout << "Another operation is still running" << endl;
+    return false;
+  }
+  running = true;
+
+  std::thread worker([&]
+  {
+    Job::Scope scope(job);
+    try
+    {
+      work(job);
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+    finished.notify_one();
+  });
+
+  QProgressDialog dialog(title, "Cancel", 0, PROGRESS_STEPS);
+  dialog.setWindowTitle(title);
+  dialog.setWindowModality(Qt::ApplicationModal);
+  dialog.setMinimumDuration(PROGRESS_DELAY);
+  dialog.setAutoClose(false);
+  dialog.setAutoReset(false);
+  dialog.setValue(0);
+
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (finished.wait_for(lock, std::chrono::milliseconds(PROGRESS_POLL),
+                            [&] { return done; }))
+        break;
+    }
+
+    QCoreApplication::processEvents(dialog.isVisible()
+        ? QEventLoop::AllEvents : QEventLoop::ExcludeUserInputEvents);
+    if (dialog.wasCanceled())
+      job.cancel();
+
+    dialog.setLabelText(job.label());
+    dialog.setValue((int) (job.progress() * (PROGRESS_STEPS - 1)));
+  }
+
+  worker.join();
+  running = false;
+
+  if (!error)
+    return true;
+
+  try
+  {
+    std::rethrow_exception(error);
+  }
+  catch (const JobCancelled&)
+  {
+    cout << title << " cancelled" << endl;
+  }
+  return false;
+}
@@ -0,0 +1,86 @@
+/***************************************************************************//**
+ * Toolbox.h
+ *
+ * Author - Daniel Andrus, Derek Stotz
+ *
+ * Date - April 8, 2015
+ *
+ * Details - Contains various functions which can be used by the filter
+ *           and NoiseSmoothing menus.
+ ******************************************************************************/
+#pragma once
+#define _USE_MATH_DEFINES
+#include <qtimagelib.h>
+#include <iostream>
+#include <cmath>
+#include <string>
+#include <qfiledialog.h>
+#include <stdlib.h>
+#include <cmath>
+#include <sstream>
+#include <functional>
+#include "FFT.h"
+#include "Job.h"
+#include "FrequencyGeometry.h"
+#include "Transfer.h"
+#include "ThreadPool.h"
+#include "Session.h"
+#include "Preview.h"
+
+#define MAX(x,y)  ((x)>(y)?(x):(y))
+#define MIN(x,y)  ((x)<(y)?(x):(y))
+
+using namespace std;
+
+extern FrequencySession T_Session;
+extern bool T_Queue_Filters;
+extern LivePreview T_Preview;
+extern bool T_Live_Preview;
+extern bool T_Color_Channels;
+
+void drawCircle(Image& image, int x, int y, int radius, double thickness);
+
+/***************************************************************************//**
+ * CircleOverlay
+ *
+ * Author - Dan Andrus
+ *
+ * The circles shown while the user drags an interactive filter. The circles
+ * are drawn straight onto the displayed image; since drawCircle inverts the
+ * pixels it touches, a circle is erased by drawing it again. Moving a circle
+ * therefore touches only the pixels of its old and new positions instead of
+ * copying the whole image on every mouse move.
+ *
+ * Up to MAX_CIRCLES circles can be shown at once, each in its own slot. The
+ * time spent redrawing on each move is printed when the overlay is hidden.
+ ******************************************************************************/
+class CircleOverlay
+{
+  public:
+    static const int MAX_CIRCLES = 2;
+
+    CircleOverlay();
+
+    void begin();
+    void show(Image& image, int x, int y, int radius, int slot = 0);
+    void hide(Image& image);
+
+  private:
+    struct Circle
+    {
+        int x;
+        int y;
+        int radius;
+        bool drawn;
+    };
+
+    Circle circles[MAX_CIRCLES];
+    int moves;
+    double total_ms;
+    double worst_ms;
+};
+void drawSpectrum(Image& image, const SpectrumRenderer& view);
+void drawSpan(Image& image, const SpectrumRenderer& view, int u, int first,
+              int end);
+bool runJob(const char* title, int stages,
+            const std::function<void(Job& job)>& work);
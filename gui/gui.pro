@@ -0,0 +1,25 @@
+TARGET = prog3
+DESTDIR = $$OUT_PWD/..
+
+HEADERS += \
+    NoiseSmoothing.h \
+    Filters.h \
+    Toolbox.h \
+    Benchmarks.h \
+    Settings.h \
+    Session.h \
+    Preview.h
+
+SOURCES += \
+    NoiseSmoothing.cpp \
+    Filters.cpp \
+    prog3.cpp \
+    Toolbox.cpp \
+    Benchmarks.cpp \
+    Settings.cpp \
+    Session.cpp \
+    Preview.cpp
+
+CONFIG += qtimagelib c++11
+
+include(../restore/restore.pri)
@@ -41,12 +41,16 @@ Details - The purpose of this assignment was to implement many of the image
 #include "Filters.h"
 #include "NoiseSmoothing.h"
 #include "MouseDemo.h"
+#include "Benchmarks.h"
+#include "Settings.h"
 
 /***************************************************************************//**
  * main
  * Author - Derek Stotz, Dan Andrus
  *
- * Sets up the image app, adds the menu classes and starts the GUI.
+ * Sets up the image app, adds the menu classes and starts the GUI. The
+ * global thread pool is created here so that its threads are already waiting
+ * when the first transform runs.
  *
  * Parameters -
             argc - the number of command line arguments (unused)
@@ -59,10 +63,16 @@ int main(int argc, char** argv)
 {
   Filters f;
   NoiseSmoothing ns;
+  Benchmarks b;
+  Settings s;
   ImageApp app(argc, argv);
 
+  ThreadPool::global();
+
   app.AddActions(&f);
   app.AddActions(&ns);
+  app.AddActions(&b);
+  app.AddActions(&s);
   return app.Start();
 }
 
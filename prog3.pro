@@ -1,12 +1,8 @@
-HEADERS += \
-    NoiseSmoothing.h \
-    Filters.h \
-    Toolbox.h
+# restore - the GUI-free restoration library
+# gui     - prog3, the interactive QtImageLib application
+# batch   - prog3-batch, the command line pipeline runner
+TEMPLATE = subdirs
+SUBDIRS = restore gui batch
 
-SOURCES += \
-    NoiseSmoothing.cpp \
-    Filters.cpp \
-    prog3.cpp \
-    Toolbox.cpp
-
-CONFIG += qtimagelib
+gui.depends = restore
+batch.depends = restore
@@ -0,0 +1,208 @@
+/***************************************************************************//**
+ * Buffer2D.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 6, 2015
+ *
+ * Details - Contains the Buffer2D class, a two-dimensional array stored in a
+ *           single aligned allocation. Replaces alloc2d and alloc2d_f, which
+ *           made one allocation per row. Allocations come from the global
+ *           BufferPool, so freed buffers are reused.
+ ******************************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+#include "BufferPool.h"
+
+// Alignment of the allocation and of the start of every row, in bytes. Large
+// enough for any SIMD load and matches the cache line size.
+static const size_t BUFFER2D_ALIGNMENT = BUFFER_POOL_ALIGNMENT;
+
+/***************************************************************************//**
+ * Buffer2D
+ *
+ * Author - Dan Andrus
+ *
+ * Row-major two-dimensional array that owns its memory and its dimensions.
+ * All rows live in one allocation aligned to BUFFER2D_ALIGNMENT, and each row
+ * is padded so that every row also starts on an aligned address. Rows are
+ * accessed through buffer[r][c] just like the old row-of-pointers arrays, and
+ * rowPointers() gives a T** for functions such as fft2D that still expect one.
+ *
+ * Buffers can be moved cheaply. Copying makes a deep copy of the data.
+ * Memory is taken from and given back to BufferPool::global(), so a buffer
+ * resized to the dimensions of one freed earlier usually gets its memory
+ * back without a new allocation.
+ *
+ * A buffer can also adopt() memory owned by something else, such as a mapped
+ * file, keeping the owner alive for as long as the buffer uses the memory.
+ ******************************************************************************/
+template <typename T>
+class Buffer2D
+{
+  public:
+    Buffer2D() : storage(NULL), nrows(0), ncols(0), pitch(0) {}
+
+    Buffer2D(int rows, int cols) : storage(NULL), nrows(0), ncols(0), pitch(0)
+    {
+        resize(rows, cols);
+    }
+
+    Buffer2D(const Buffer2D& other) : storage(NULL), nrows(0), ncols(0), pitch(0)
+    {
+        *this = other;
+    }
+
+    Buffer2D(Buffer2D&& other)
+        : storage(other.storage), nrows(other.nrows), ncols(other.ncols),
+          pitch(other.pitch), rowPtrs(std::move(other.rowPtrs)),
+          owner(std::move(other.owner))
+    {
+        other.storage = NULL;
+        other.nrows = other.ncols = other.pitch = 0;
+    }
+
+    ~Buffer2D()
+    {
+        release();
+    }
+
+    Buffer2D& operator=(const Buffer2D& other)
+    {
+        if (this != &other)
+        {
+            resize(other.nrows, other.ncols);
+            if (storage != NULL)
+                memcpy(storage, other.storage, bytes());
+        }
+        return *this;
+    }
+
+    Buffer2D& operator=(Buffer2D&& other)
+    {
+        if (this != &other)
+        {
+            release();
+            storage = other.storage;
+            nrows = other.nrows;
+            ncols = other.ncols;
+            pitch = other.pitch;
+            rowPtrs = std::move(other.rowPtrs);
+            owner = std::move(other.owner);
+            other.storage = NULL;
+            other.nrows = other.ncols = other.pitch = 0;
+        }
+        return *this;
+    }
+
+    /***********************************************************************//**
+     * resize
+     *
+     * Reallocates the buffer for the given dimensions. The contents are left
+     * uninitialized. Does nothing if the dimensions have not changed.
+     **************************************************************************/
+    void resize(int rows, int cols)
+    {
+        if (rows == nrows && cols == ncols && storage != NULL)
+            return;
+
+        release();
+        if (rows <= 0 || cols <= 0)
+            return;
+
+        nrows = rows;
+        ncols = cols;
+        pitch = pitchFor(cols);
+        storage = (T*) BufferPool::global().allocate(bytes());
+
+        rowPtrs.resize(rows);
+        for (int r = 0; r < rows; r++)
+            rowPtrs[r] = storage + (size_t) r * pitch;
+    }
+
+    /***********************************************************************//**
+     * adopt
+     *
+     * Makes the buffer use memory it does not own, laid out as resize()
+     * would: rows of pitchFor(cols) elements, starting on an address aligned
+     * to BUFFER2D_ALIGNMENT. The memory must stay valid while owner exists;
+     * the buffer holds on to owner until it is released or resized.
+     **************************************************************************/
+    void adopt(T* data, int rows, int cols, const std::shared_ptr<void>& owner)
+    {
+        release();
+        storage = data;
+        nrows = rows;
+        ncols = cols;
+        pitch = pitchFor(cols);
+        this->owner = owner;
+
+        rowPtrs.resize(rows);
+        for (int r = 0; r < rows; r++)
+            rowPtrs[r] = storage + (size_t) r * pitch;
+    }
+
+    /***********************************************************************//**
+     * release
+     *
+     * Frees the memory held by the buffer, leaving it empty.
+     **************************************************************************/
+    void release()
+    {
+        if (owner)
+            owner.reset();
+        else
+            BufferPool::global().release(storage, bytes());
+        storage = NULL;
+        nrows = ncols = pitch = 0;
+        rowPtrs.clear();
+    }
+
+    void fill(const T& value)
+    {
+        for (int r = 0; r < nrows; r++)
+        {
+            T* row = (*this)[r];
+            for (int c = 0; c < ncols; c++)
+                row[c] = value;
+        }
+    }
+
+    int rows() const { return nrows; }
+    int cols() const { return ncols; }
+    int stride() const { return pitch; }
+    bool empty() const { return storage == NULL; }
+    size_t bytes() const { return (size_t) nrows * pitch * sizeof(T); }
+
+    T* data() { return storage; }
+    const T* data() const { return storage; }
+    T* operator[](int r) { return storage + (size_t) r * pitch; }
+    const T* operator[](int r) const { return storage + (size_t) r * pitch; }
+    T** rowPointers() { return rowPtrs.empty() ? NULL : &rowPtrs[0]; }
+    bool adopted() const { return (bool) owner; }
+
+    /***********************************************************************//**
+     * pitchFor
+     *
+     * Returns the number of elements each row of a buffer cols wide takes,
+     * padding included.
+     **************************************************************************/
+    static int pitchFor(int cols)
+    {
+        size_t perLine = BUFFER2D_ALIGNMENT / sizeof(T);
+        return (int) (((size_t) cols + perLine - 1) / perLine * perLine);
+    }
+
+  private:
+    T* storage;
+    int nrows;
+    int ncols;
+    int pitch;                  // elements per row, including padding
+    std::vector<T*> rowPtrs;
+    std::shared_ptr<void> owner;    // set if the memory was adopted
+};
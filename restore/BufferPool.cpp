@@ -0,0 +1,273 @@
+/***************************************************************************//**
+ * BufferPool.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 29, 2015
+ *
+ * Details - Defines the BufferPool class.
+ ******************************************************************************/
+#include "BufferPool.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Smallest bucket; smaller requests are rounded up to it
+static const size_t MIN_BUCKET = 256;
+
+/***************************************************************************//**
+ * alignedAlloc
+ * Author - Dan Andrus
+ *
+ * Allocates a block aligned to BUFFER_POOL_ALIGNMENT, throwing bad_alloc if
+ * there is no memory.
+ ******************************************************************************/
+static void* alignedAlloc(size_t size)
+{
+    void* p = NULL;
+#ifdef _WIN32
+    p = _aligned_malloc(size, BUFFER_POOL_ALIGNMENT);
+#else
+    if (posix_memalign(&p, BUFFER_POOL_ALIGNMENT, size) != 0)
+        p = NULL;
+#endif
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+/***************************************************************************//**
+ * alignedFree
+ * Author - Dan Andrus
+ *
+ * Frees a block from alignedAlloc.
+ ******************************************************************************/
+static void alignedFree(void* p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+BufferPool::BufferPool(size_t limit) : keep(limit)
+{
+    counts = Stats();
+}
+
+BufferPool::~BufferPool()
+{
+    trim();
+}
+
+/***************************************************************************//**
+ * global
+ * Author - Dan Andrus
+ *
+ * Returns the pool every Buffer2D allocates from, created on first use with
+ * defaultLimit(). It is never destroyed, so buffers freed while the program
+ * exits, in whatever order, still have a pool to go back to.
+ ******************************************************************************/
+BufferPool& BufferPool::global()
+{
+    static BufferPool* pool = new BufferPool(defaultLimit());
+    return *pool;
+}
+
+/***************************************************************************//**
+ * defaultLimit
+ * Author - Dan Andrus
+ *
+ * Returns the limit in bytes given by the PROG3_POOL_MB environment
+ * variable, or 256 MB if it is not set. 0 turns the pool off.
+ ******************************************************************************/
+size_t BufferPool::defaultLimit()
+{
+    const char* env = getenv("PROG3_POOL_MB");
+    long mb = (env != NULL) ? atol(env) : 256;
+
+    if (mb < 0)
+        mb = 256;
+    return (size_t) mb * 1024 * 1024;
+}
+
+/***************************************************************************//**
+ * bucketSize
+ * Author - Dan Andrus
+ *
+ * Returns the size of the bucket a request of the given size goes to: the
+ * request rounded up to a multiple of a quarter of the largest power of 2
+ * not above it, and to at least MIN_BUCKET.
+ ******************************************************************************/
+size_t BufferPool::bucketSize(size_t bytes)
+{
+    size_t power = MIN_BUCKET;
+
+    if (bytes <= MIN_BUCKET)
+        return MIN_BUCKET;
+    while (power <= bytes / 2)
+        power *= 2;
+
+    size_t step = power / 4;
+    return (bytes + step - 1) / step * step;
+}
+
+/***************************************************************************//**
+ * allocate
+ * Author - Dan Andrus
+ *
+ * Returns a block of at least the given size, aligned to
+ * BUFFER_POOL_ALIGNMENT, reusing a free block of its bucket if there is one.
+ * Throws bad_alloc if there is no memory.
+ ******************************************************************************/
+void* BufferPool::allocate(size_t bytes)
+{
+    size_t size = bucketSize(bytes);
+
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        counts.requests++;
+        counts.inUse += size;
+        if (counts.inUse > counts.highWater)
+            counts.highWater = counts.inUse;
+
+        std::map<size_t, std::vector<void*> >::iterator it = buckets.find(size);
+        if (it != buckets.end() && !it->second.empty())
+        {
+            void* block = it->second.back();
+            it->second.pop_back();
+            counts.hits++;
+            counts.retained -= size;
+            counts.blocks--;
+            return block;
+        }
+    }
+
+    try
+    {
+        return alignedAlloc(size);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        counts.inUse -= size;
+        throw;
+    }
+}
+
+/***************************************************************************//**
+ * release
+ * Author - Dan Andrus
+ *
+ * Takes back a block from allocate(), of the size it was asked for. The
+ * block is kept for reuse if the free blocks stay within the limit, and
+ * freed otherwise. NULL is ignored.
+ ******************************************************************************/
+void BufferPool::release(void* block, size_t bytes)
+{
+    size_t size = bucketSize(bytes);
+
+    if (block == NULL)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        counts.inUse -= size;
+        if (counts.retained + size <= keep)
+        {
+            buckets[size].push_back(block);
+            counts.retained += size;
+            counts.blocks++;
+            return;
+        }
+    }
+    alignedFree(block);
+}
+
+/***************************************************************************//**
+ * setLimit
+ * Author - Dan Andrus
+ *
+ * Changes the most memory the free blocks may hold, freeing blocks right
+ * away if they no longer fit.
+ ******************************************************************************/
+void BufferPool::setLimit(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(guard);
+    keep = bytes;
+    shrink(keep);
+}
+
+size_t BufferPool::limit() const
+{
+    std::lock_guard<std::mutex> lock(guard);
+    return keep;
+}
+
+/***************************************************************************//**
+ * trim
+ * Author - Dan Andrus
+ *
+ * Frees every free block, keeping the limit.
+ ******************************************************************************/
+void BufferPool::trim()
+{
+    std::lock_guard<std::mutex> lock(guard);
+    shrink(0);
+}
+
+/***************************************************************************//**
+ * stats
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the counts since the pool was created or resetStats was called
+ ******************************************************************************/
+BufferPool::Stats BufferPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(guard);
+    return counts;
+}
+
+/***************************************************************************//**
+ * resetStats
+ * Author - Dan Andrus
+ *
+ * Sets the request and hit counts to 0 and the high-water mark to the memory
+ * in use now, so the next run can be measured on its own.
+ ******************************************************************************/
+void BufferPool::resetStats()
+{
+    std::lock_guard<std::mutex> lock(guard);
+    counts.requests = 0;
+    counts.hits = 0;
+    counts.highWater = counts.inUse;
+}
+
+/***************************************************************************//**
+ * shrink
+ * Author - Dan Andrus
+ *
+ * Frees free blocks, largest first, until they hold at most target bytes.
+ * The caller holds the mutex.
+ ******************************************************************************/
+void BufferPool::shrink(size_t target)
+{
+    std::map<size_t, std::vector<void*> >::reverse_iterator it = buckets.rbegin();
+
+    for (; it != buckets.rend() && counts.retained > target; ++it)
+    {
+        std::vector<void*>& blocks = it->second;
+        while (!blocks.empty() && counts.retained > target)
+        {
+            alignedFree(blocks.back());
+            blocks.pop_back();
+            counts.retained -= it->first;
+            counts.blocks--;
+        }
+    }
+}
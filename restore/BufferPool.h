@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * BufferPool.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 29, 2015
+ *
+ * Details - Contains the BufferPool class, which keeps the memory of freed
+ *           buffers to hand out again, so that transforms run one after
+ *           another reuse the same planes instead of allocating their own.
+ ******************************************************************************/
+#pragma once
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Alignment of every block handed out, in bytes
+static const size_t BUFFER_POOL_ALIGNMENT = 64;
+
+/***************************************************************************//**
+ * BufferPool
+ *
+ * Author - Dan Andrus
+ *
+ * Hands out aligned blocks of memory, sorted into buckets by size. Requests
+ * are rounded up to the size of their bucket: a multiple of a quarter of the
+ * power of 2 below them, so a block is at most a quarter larger than asked
+ * for, and buffers of nearly the same size, such as the planes of images a
+ * few pixels apart, share a bucket. A freed block is kept in its bucket and
+ * handed out for the next request of that bucket, unless keeping it would
+ * take the memory held by free blocks over the limit, in which case it is
+ * freed.
+ *
+ * Every Buffer2D allocates through global(), so the spectrum planes and
+ * scratch buffers of one transform are reused by the next, whether it is of
+ * the next frame of a batch or of another image in the GUI. stats() counts
+ * the requests the free blocks met (hits), the memory handed out and not
+ * yet returned, and the most of it that was ever handed out at once (the
+ * high-water mark), which is about the limit a workload needs to never
+ * allocate twice.
+ *
+ * The pool is thread-safe.
+ ******************************************************************************/
+class BufferPool
+{
+  public:
+    struct Stats
+    {
+        unsigned long long requests;
+        unsigned long long hits;
+        size_t inUse;               // bytes handed out and not returned
+        size_t highWater;           // most bytes ever in use at once
+        size_t retained;            // bytes held in free blocks
+        size_t blocks;              // number of free blocks
+    };
+
+    explicit BufferPool(size_t limit);
+    ~BufferPool();
+
+    static BufferPool& global();
+    static size_t defaultLimit();
+    static size_t bucketSize(size_t bytes);
+
+    void* allocate(size_t bytes);
+    void release(void* block, size_t bytes);
+
+    void setLimit(size_t bytes);
+    size_t limit() const;
+    void trim();
+    Stats stats() const;
+    void resetStats();
+
+  private:
+    void shrink(size_t target);
+
+    mutable std::mutex guard;
+    std::map<size_t, std::vector<void*> > buckets;  // free blocks by size
+    size_t keep;                    // most bytes held in free blocks
+    Stats counts;
+
+    BufferPool(const BufferPool&);
+    BufferPool& operator=(const BufferPool&);
+};
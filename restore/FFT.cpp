@@ -0,0 +1,824 @@
+/***************************************************************************//**
+ * FFT.cpp
+ *
+ * Author - Dan Andrus, Derek Stotz
+ *
+ * Date - May 2, 2015
+ *
+ * Details - Defines our mixed-radix fast Fourier transform. The transform is
+ *           a Stockham autosort FFT, meaning each pass reads from one buffer
+ *           and writes to the other so no bit-reversal step is needed, and
+ *           passes of different radices can be freely mixed. Everything is
+ *           instantiated for float and double at the end of the file.
+ ******************************************************************************/
+
+#define _USE_MATH_DEFINES
+#include "FFT.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+// Largest prime handled by a generic butterfly before we switch to Bluestein
+static const int MAX_GENERIC_RADIX = 31;
+
+// Bytes of each row transposed together by the column pass: one 64 byte
+// cache line, so every line read from a row is used in full. That is sixteen
+// columns of floats or eight of doubles.
+static const int COLUMN_BLOCK_BYTES = 64;
+
+/***************************************************************************//**
+ * PlanCache
+ *
+ * Author - Dan Andrus
+ *
+ * The plans built by FFTPlan<T>::get, keyed by length and direction. There is
+ * one cache for each scalar type.
+ ******************************************************************************/
+template <typename T>
+struct PlanCache
+{
+    std::map<std::pair<int, int>, const FFTPlan<T>*> plans;
+    std::mutex lock;
+
+    static PlanCache& global()
+    {
+        static PlanCache cache;
+        return cache;
+    }
+};
+
+/***************************************************************************//**
+ * Scratch
+ *
+ * Author - Dan Andrus
+ *
+ * Working buffers of one thread, kept between transforms so that transforms
+ * of the same size after the first do not allocate. Buffers only grow. There
+ * is one set for each scalar type.
+ ******************************************************************************/
+template <typename T>
+struct Scratch
+{
+    typedef std::complex<T> complex;
+
+    std::vector<complex> line;
+    std::vector<complex> work;
+    std::vector<complex> tile;
+
+    static Scratch& local()
+    {
+        static thread_local Scratch scratch;
+        return scratch;
+    }
+
+    static complex* reserve(std::vector<complex>& buffer, size_t size)
+    {
+        if (buffer.size() < size)
+            buffer.resize(size);
+        return &buffer[0];
+    }
+};
+
+/***************************************************************************//**
+ * cmul
+ * Author - Dan Andrus
+ *
+ * Multiplies two complex numbers. std::complex's operator* checks for NaN and
+ * infinity on every call, which we never need and which is noticeably slower.
+ ******************************************************************************/
+template <typename T>
+static inline std::complex<T> cmul(const std::complex<T>& a, const std::complex<T>& b)
+{
+    return std::complex<T>(a.real() * b.real() - a.imag() * b.imag(),
+                           a.real() * b.imag() + a.imag() * b.real());
+}
+
+/***************************************************************************//**
+ * itimes
+ * Author - Dan Andrus
+ *
+ * Multiplies a complex number by s*i, where s is the sign of the transform.
+ ******************************************************************************/
+template <typename T>
+static inline std::complex<T> itimes(const std::complex<T>& a, T s)
+{
+    return std::complex<T>(-s * a.imag(), s * a.real());
+}
+
+/***************************************************************************//**
+ * butterfly
+ * Author - Dan Andrus
+ *
+ * Small in-place DFTs used by each pass of the transform. The sign s is -1 for
+ * the forward transform and 1 for the inverse transform. Radix 4 is handled as
+ * its own butterfly since it needs no multiplications at all.
+ ******************************************************************************/
+template <typename T>
+static inline void butterfly2(std::complex<T>* v)
+{
+    std::complex<T> a = v[0];
+    v[0] = a + v[1];
+    v[1] = a - v[1];
+}
+
+template <typename T>
+static inline void butterfly3(std::complex<T>* v, T s)
+{
+    const T sin60 = (T) 0.86602540378443865;
+
+    std::complex<T> t1 = v[1] + v[2];
+    std::complex<T> t2 = v[0] - (T) 0.5 * t1;
+    std::complex<T> t3 = itimes((v[1] - v[2]) * sin60, s);
+
+    v[0] = v[0] + t1;
+    v[1] = t2 + t3;
+    v[2] = t2 - t3;
+}
+
+template <typename T>
+static inline void butterfly4(std::complex<T>* v, T s)
+{
+    std::complex<T> t0 = v[0] + v[2];
+    std::complex<T> t1 = v[0] - v[2];
+    std::complex<T> t2 = v[1] + v[3];
+    std::complex<T> t3 = itimes(v[1] - v[3], s);
+
+    v[0] = t0 + t2;
+    v[1] = t1 + t3;
+    v[2] = t0 - t2;
+    v[3] = t1 - t3;
+}
+
+template <typename T>
+static inline void butterfly5(std::complex<T>* v, T s)
+{
+    const T c1 = (T) 0.30901699437494742;   // cos(2pi/5)
+    const T c2 = (T) -0.80901699437494742;  // cos(4pi/5)
+    const T s1 = (T) 0.95105651629515357;   // sin(2pi/5)
+    const T s2 = (T) 0.58778525229247313;   // sin(4pi/5)
+
+    std::complex<T> t1 = v[1] + v[4];
+    std::complex<T> t2 = v[2] + v[3];
+    std::complex<T> t3 = v[1] - v[4];
+    std::complex<T> t4 = v[2] - v[3];
+
+    std::complex<T> a1 = v[0] + c1 * t1 + c2 * t2;
+    std::complex<T> a2 = v[0] + c2 * t1 + c1 * t2;
+    std::complex<T> b1 = itimes(s1 * t3 + s2 * t4, s);
+    std::complex<T> b2 = itimes(s2 * t3 - s1 * t4, s);
+
+    v[0] = v[0] + t1 + t2;
+    v[1] = a1 + b1;
+    v[4] = a1 - b1;
+    v[2] = a2 + b2;
+    v[3] = a2 - b2;
+}
+
+template <typename T>
+static inline void butterflyGeneric(std::complex<T>* v, std::complex<T>* out, int radix,
+                                    const std::complex<T>* roots)
+{
+    for (int k = 0; k < radix; k++)
+    {
+        std::complex<T> sum = v[0];
+        int index = 0;
+        for (int r = 1; r < radix; r++)
+        {
+            index += k;
+            if (index >= radix)
+                index -= radix;
+            sum += cmul(v[r], roots[index]);
+        }
+        out[k] = sum;
+    }
+    for (int k = 0; k < radix; k++)
+        v[k] = out[k];
+}
+
+/***************************************************************************//**
+ * FFTPlan
+ * Author - Dan Andrus
+ *
+ * Builds a plan for transforming arrays of length n in the given direction.
+ *
+ * Parameters -
+ *          n - the length of the transform
+ *          dir - 1 for a forward transform, -1 for an inverse transform
+ ******************************************************************************/
+template <typename T>
+FFTPlan<T>::FFTPlan(int n, int dir)
+    : n(n), dir(dir), bluestein(false), m(0), forwardM(NULL), inverseM(NULL)
+{
+    factor();
+}
+
+/***************************************************************************//**
+ * get
+ * Author - Dan Andrus
+ *
+ * Returns the plan for the given length and direction, building it the first
+ * time it is asked for. Plans are kept for the life of the program. Safe to
+ * call from several threads; the lock is not held while a plan is built, so
+ * building one plan may ask for others (Bluestein does).
+ *
+ * Parameters -
+ *          n - the length of the transform
+ *          dir - 1 for a forward transform, -1 for an inverse transform
+ *
+ * Returns
+ *          the plan
+ ******************************************************************************/
+template <typename T>
+const FFTPlan<T>& FFTPlan<T>::get(int n, int dir)
+{
+    PlanCache<T>& cache = PlanCache<T>::global();
+    std::pair<int, int> key(n, dir);
+
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        typename std::map<std::pair<int, int>, const FFTPlan*>::iterator it =
+            cache.plans.find(key);
+        if (it != cache.plans.end())
+            return *it->second;
+    }
+
+    FFTPlan* plan = new FFTPlan(n, dir);
+
+    // Another thread may have built the same plan in the meantime
+    std::lock_guard<std::mutex> guard(cache.lock);
+    const FFTPlan*& entry = cache.plans[key];
+    if (entry == NULL)
+        entry = plan;
+    else
+        delete plan;
+    return *entry;
+}
+
+/***************************************************************************//**
+ * cachedPlans
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the number of plans get() has built so far
+ ******************************************************************************/
+template <typename T>
+int FFTPlan<T>::cachedPlans()
+{
+    PlanCache<T>& cache = PlanCache<T>::global();
+    std::lock_guard<std::mutex> guard(cache.lock);
+    return (int) cache.plans.size();
+}
+
+/***************************************************************************//**
+ * workSize
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the number of complex values of scratch space execute() needs
+ ******************************************************************************/
+template <typename T>
+int FFTPlan<T>::workSize() const
+{
+    return bluestein ? 2 * m : n;
+}
+
+/***************************************************************************//**
+ * factor
+ * Author - Dan Andrus
+ *
+ * Splits the transform length into passes and precomputes the twiddle factors
+ * for each pass. Factors of 4 are taken first since they are the cheapest per
+ * point, followed by 2, 3, 5, 7 and any other small primes. If a prime factor
+ * is too large for a generic butterfly the whole transform is done through
+ * Bluestein's algorithm instead.
+ ******************************************************************************/
+template <typename T>
+void FFTPlan<T>::factor()
+{
+    std::vector<int> radices;
+    int remaining = n;
+    int p;
+
+    while (remaining % 4 == 0)
+    {
+        radices.push_back(4);
+        remaining /= 4;
+    }
+    for (p = 2; p <= MAX_GENERIC_RADIX && remaining > 1; p++)
+    {
+        while (remaining % p == 0)
+        {
+            radices.push_back(p);
+            remaining /= p;
+        }
+    }
+
+    if (remaining > 1)
+    {
+        // Large prime factor: evaluate as a convolution of power of 2 length
+        bluestein = true;
+        m = 1;
+        while (m < 2 * n - 1)
+            m *= 2;
+
+        forwardM = &get(m, 1);
+        inverseM = &get(m, -1);
+
+        // chirp[k] = exp(s * i * pi * k^2 / n), with k^2 reduced mod 2n
+        chirp.resize(n);
+        for (long long k = 0; k < n; k++)
+        {
+            double angle = (dir == 1 ? -M_PI : M_PI)
+                           * (double) ((k * k) % (2LL * n)) / n;
+            chirp[k] = complex((T) cos(angle), (T) sin(angle));
+        }
+
+        // Spectrum of the conjugate chirp, wrapped around to length m
+        chirpSpectrum.assign(m, complex(0, 0));
+        chirpSpectrum[0] = std::conj(chirp[0]);
+        for (int k = 1; k < n; k++)
+        {
+            chirpSpectrum[k] = std::conj(chirp[k]);
+            chirpSpectrum[m - k] = std::conj(chirp[k]);
+        }
+        std::vector<complex> work(forwardM->workSize());
+        forwardM->execute(&chirpSpectrum[0], &work[0]);
+        return;
+    }
+
+    // Twiddles for each pass: w[k * radix + r] = exp(s * 2pi * i * r * k / (span * radix))
+    int span = 1;
+    for (size_t i = 0; i < radices.size(); i++)
+    {
+        Stage stage;
+        stage.radix = radices[i];
+        stage.span = span;
+        stage.twiddles.resize(span * stage.radix);
+
+        for (int k = 0; k < span; k++)
+        {
+            for (int r = 0; r < stage.radix; r++)
+            {
+                double angle = (dir == 1 ? -2.0 : 2.0) * M_PI * r * k
+                               / ((double) span * stage.radix);
+                stage.twiddles[k * stage.radix + r] =
+                    complex((T) cos(angle), (T) sin(angle));
+            }
+        }
+
+        if (stage.radix > 5)
+        {
+            stage.roots.resize(stage.radix);
+            for (int r = 0; r < stage.radix; r++)
+            {
+                double angle = (dir == 1 ? -2.0 : 2.0) * M_PI * r / stage.radix;
+                stage.roots[r] = complex((T) cos(angle), (T) sin(angle));
+            }
+        }
+
+        stages.push_back(stage);
+        span *= stage.radix;
+    }
+}
+
+/***************************************************************************//**
+ * execute
+ * Author - Dan Andrus
+ *
+ * Runs the unnormalized transform in place.
+ *
+ * Parameters -
+ *          data - the n complex values to transform
+ *          work - scratch space of at least workSize() complex values
+ ******************************************************************************/
+template <typename T>
+void FFTPlan<T>::execute(complex* data, complex* work) const
+{
+    if (bluestein)
+        bluesteinExecute(data, work);
+    else
+        stockham(data, work);
+}
+
+/***************************************************************************//**
+ * stockham
+ * Author - Dan Andrus
+ *
+ * Runs every pass of the transform, ping-ponging between the data and work
+ * arrays. Butterfly j of a pass with radix R reads the points j + r*n/R and
+ * writes the points (j/span)*span*R + j%span + r*span, which leaves the output
+ * in natural order without a separate reordering step.
+ ******************************************************************************/
+template <typename T>
+void FFTPlan<T>::stockham(complex* data, complex* work) const
+{
+    complex* in = data;
+    complex* out = work;
+    complex v[MAX_GENERIC_RADIX];
+    complex tmp[MAX_GENERIC_RADIX];
+    T s = (dir == 1) ? -1 : 1;
+
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        const Stage& stage = stages[i];
+        const int radix = stage.radix;
+        const int span = stage.span;
+        const int q = n / radix;
+        const complex* tw = &stage.twiddles[0];
+
+        for (int b = 0; b < q; b += span)
+        {
+            for (int k = 0; k < span; k++)
+            {
+                int j = b + k;
+                complex* dst = out + b * radix + k;
+
+                v[0] = in[j];
+                if (k == 0)
+                {
+                    for (int r = 1; r < radix; r++)
+                        v[r] = in[j + r * q];
+                }
+                else
+                {
+                    for (int r = 1; r < radix; r++)
+                        v[r] = cmul(in[j + r * q], tw[k * radix + r]);
+                }
+
+                switch (radix)
+                {
+                    case 2: butterfly2(v); break;
+                    case 3: butterfly3(v, s); break;
+                    case 4: butterfly4(v, s); break;
+                    case 5: butterfly5(v, s); break;
+                    default: butterflyGeneric(v, tmp, radix, &stage.roots[0]);
+                }
+
+                for (int r = 0; r < radix; r++)
+                    dst[r * span] = v[r];
+            }
+        }
+
+        complex* swap = in;
+        in = out;
+        out = swap;
+    }
+
+    // An odd number of passes leaves the result in the work array
+    if (in != data)
+    {
+        for (int i = 0; i < n; i++)
+            data[i] = in[i];
+    }
+}
+
+/***************************************************************************//**
+ * bluesteinExecute
+ * Author - Dan Andrus
+ *
+ * Computes the transform through Bluestein's algorithm by rewriting
+ * nk = (n^2 + k^2 - (k-n)^2) / 2, which turns the DFT into a convolution with
+ * a chirp. The convolution is done with power of 2 transforms of length m.
+ ******************************************************************************/
+template <typename T>
+void FFTPlan<T>::bluesteinExecute(complex* data, complex* work) const
+{
+    complex* a = work;
+    complex* sub = work + m;
+    int k;
+
+    for (k = 0; k < n; k++)
+        a[k] = cmul(data[k], chirp[k]);
+    for (; k < m; k++)
+        a[k] = complex(0, 0);
+
+    forwardM->execute(a, sub);
+    for (k = 0; k < m; k++)
+        a[k] = cmul(a[k], chirpSpectrum[k]);
+    inverseM->execute(a, sub);
+
+    T scale = (T) 1 / m;
+    for (k = 0; k < n; k++)
+        data[k] = cmul(a[k], chirp[k]) * scale;
+}
+
+/***************************************************************************//**
+ * mixedFFT1D
+ * Author - Dan Andrus
+ *
+ * Transforms a single array of complex values of any length. Like fft2D, the
+ * forward transform is scaled by 1/n and the inverse transform is not scaled.
+ *
+ * Parameters -
+ *          dir - 1 for the forward transform, -1 for the inverse transform
+ *          n - the length of the array
+ *          data - the values to transform in place
+ ******************************************************************************/
+template <typename T>
+void mixedFFT1D(int dir, int n, std::complex<T>* data)
+{
+    const FFTPlan<T>& plan = FFTPlan<T>::get(n, dir);
+    Scratch<T>& scratch = Scratch<T>::local();
+
+    plan.execute(data, Scratch<T>::reserve(scratch.work, plan.workSize()));
+
+    if (dir == 1)
+    {
+        T scale = (T) 1 / n;
+        for (int i = 0; i < n; i++)
+            data[i] *= scale;
+    }
+}
+
+/***************************************************************************//**
+ * transformColumns
+ * Author - Dan Andrus
+ *
+ * Transforms the first ncols columns of one or more 2D arrays stacked one
+ * above the other, split across the global thread pool. Columns are handled
+ * in blocks of COLUMN_BLOCK_BYTES: each block is transposed into contiguous
+ * lines, transformed, scaled and transposed back, so the rows are read and
+ * written a whole cache line at a time instead of one value at a time. The
+ * blocks of every array are shared out together, so small arrays keep all
+ * the threads busy.
+ *
+ * Parameters -
+ *          plan - the plan for the column length, the rows of one array
+ *          real - the real parts, overwritten with the result
+ *          imag - the imaginary parts, overwritten with the result
+ *          ncols - the number of columns to transform
+ *          scale - factor applied to every result
+ *          planes - the number of arrays, each plan.size() rows
+ ******************************************************************************/
+template <typename T>
+static void transformColumns(const FFTPlan<T>& plan, T** real, T** imag,
+                             int ncols, T scale, int planes = 1)
+{
+    const int block = COLUMN_BLOCK_BYTES / sizeof(T);
+    const int rows = plan.size();
+    const int blocks = (ncols + block - 1) / block;
+
+    ThreadPool::global().parallelFor(blocks * planes, [&](int begin, int end)
+    {
+        Scratch<T>& scratch = Scratch<T>::local();
+        std::complex<T>* tile = Scratch<T>::reserve(scratch.tile, (size_t) block * rows);
+        std::complex<T>* work = Scratch<T>::reserve(scratch.work, plan.workSize());
+
+        for (int task = begin; task < end; task++)
+        {
+            int b = task % blocks;
+            int first = (task / blocks) * rows;
+            int c0 = b * block;
+            int width = std::min(block, ncols - c0);
+            int r;
+            int j;
+
+            for (r = 0; r < rows; r++)
+            {
+                const T* re = real[first + r] + c0;
+                const T* im = imag[first + r] + c0;
+                for (j = 0; j < width; j++)
+                    tile[(size_t) j * rows + r] = std::complex<T>(re[j], im[j]);
+            }
+
+            for (j = 0; j < width; j++)
+                plan.execute(&tile[(size_t) j * rows], work);
+
+            for (r = 0; r < rows; r++)
+            {
+                T* re = real[first + r] + c0;
+                T* im = imag[first + r] + c0;
+                for (j = 0; j < width; j++)
+                {
+                    re[j] = tile[(size_t) j * rows + r].real() * scale;
+                    im[j] = tile[(size_t) j * rows + r].imag() * scale;
+                }
+            }
+        }
+    });
+}
+
+/***************************************************************************//**
+ * mixedFFT2D
+ * Author - Dan Andrus, Derek Stotz
+ *
+ * Drop-in replacement for QtImageLib's fft2D that works on images of any
+ * width and height. Transforms every row, then every column, with both passes
+ * split across the global thread pool. The forward transform is scaled by
+ * 1/(rows*cols) and the inverse transform is not scaled.
+ *
+ * Parameters -
+ *          dir - 1 for the forward transform, -1 for the inverse transform
+ *          rows - the number of rows in the arrays
+ *          cols - the number of columns in the arrays
+ *          real - the real parts, overwritten with the result
+ *          imag - the imaginary parts, overwritten with the result
+ ******************************************************************************/
+template <typename T>
+void mixedFFT2D(int dir, int rows, int cols, T** real, T** imag)
+{
+    const FFTPlan<T>& rowPlan = FFTPlan<T>::get(cols, dir);
+    const FFTPlan<T>& colPlan = FFTPlan<T>::get(rows, dir);
+
+    // Transform rows
+    T scale = (dir == 1) ? (T) 1 / cols : 1;
+    ThreadPool::global().parallelFor(rows, [&](int begin, int end)
+    {
+        Scratch<T>& scratch = Scratch<T>::local();
+        std::complex<T>* line = Scratch<T>::reserve(scratch.line, cols);
+        std::complex<T>* work = Scratch<T>::reserve(scratch.work, rowPlan.workSize());
+
+        for (int r = begin; r < end; r++)
+        {
+            int c;
+
+            for (c = 0; c < cols; c++)
+                line[c] = std::complex<T>(real[r][c], imag[r][c]);
+
+            rowPlan.execute(line, work);
+
+            for (c = 0; c < cols; c++)
+            {
+                real[r][c] = line[c].real() * scale;
+                imag[r][c] = line[c].imag() * scale;
+            }
+        }
+    });
+
+    // Transform columns
+    transformColumns(colPlan, real, imag, cols, (dir == 1) ? (T) 1 / rows : (T) 1);
+}
+
+/***************************************************************************//**
+ * realFFT2D
+ * Author - Dan Andrus
+ *
+ * Forward transform of a real image into the half spectrum. Rows are
+ * transformed two at a time by packing one into the real part and the other
+ * into the imaginary part of a single complex transform, then separating them
+ * using conjugate symmetry. Only the cols/2 + 1 stored columns go through the
+ * column pass. Both passes are split across the global thread pool. Scaled by
+ * 1/(rows*cols) like mixedFFT2D.
+ *
+ * Several images of the same size, such as the channels of a color image, can
+ * be transformed together by stacking them one above the other. Their rows
+ * are all independent and go through the row pass as one image; the column
+ * pass transforms each image's columns separately. Every image shares the
+ * same plans and each pass is a single split across the thread pool.
+ *
+ * Parameters -
+ *          spatial - the image data (unchanged)
+ *          real - receives the real parts, rows x halfSpectrumCols(cols)
+ *          imag - receives the imaginary parts, rows x halfSpectrumCols(cols)
+ *          planes - the number of images stacked in spatial, and so in real
+ *                   and imag
+ ******************************************************************************/
+template <typename T>
+void realFFT2D(const Buffer2D<T>& spatial, Buffer2D<T>& real, Buffer2D<T>& imag,
+               int planes)
+{
+    int total = spatial.rows();
+    int rows = total / planes;
+    int cols = spatial.cols();
+    int half = halfSpectrumCols(cols);
+    const FFTPlan<T>& rowPlan = FFTPlan<T>::get(cols, 1);
+    const FFTPlan<T>& colPlan = FFTPlan<T>::get(rows, 1);
+
+    real.resize(total, half);
+    imag.resize(total, half);
+
+    // Transform rows in pairs
+    T scale = (T) 0.5 / cols;
+    ThreadPool::global().parallelFor((total + 1) / 2, [&](int begin, int end)
+    {
+        Scratch<T>& scratch = Scratch<T>::local();
+        std::complex<T>* line = Scratch<T>::reserve(scratch.line, cols);
+        std::complex<T>* work = Scratch<T>::reserve(scratch.work, rowPlan.workSize());
+
+        for (int r = 2 * begin; r < 2 * end && r < total; r += 2)
+        {
+            bool pair = (r + 1 < total);
+            int c;
+
+            for (c = 0; c < cols; c++)
+                line[c] = std::complex<T>(spatial[r][c], pair ? spatial[r + 1][c] : 0);
+
+            rowPlan.execute(line, work);
+
+            // X1 = (Z[k] + conj(Z[-k])) / 2, X2 = (Z[k] - conj(Z[-k])) / 2i
+            for (c = 0; c < half; c++)
+            {
+                std::complex<T> z = line[c];
+                std::complex<T> zm = std::conj(line[(cols - c) % cols]);
+                std::complex<T> sum = z + zm;
+                std::complex<T> diff = z - zm;
+
+                real[r][c] = sum.real() * scale;
+                imag[r][c] = sum.imag() * scale;
+                if (pair)
+                {
+                    real[r + 1][c] = diff.imag() * scale;
+                    imag[r + 1][c] = -diff.real() * scale;
+                }
+            }
+        }
+    });
+
+    // Transform the stored columns
+    transformColumns(colPlan, real.rowPointers(), imag.rowPointers(), half,
+                     (T) 1 / rows, planes);
+}
+
+/***************************************************************************//**
+ * inverseRealFFT2D
+ * Author - Dan Andrus
+ *
+ * Inverse transform of a half spectrum back into a real image. The columns
+ * are transformed first, then pairs of rows are rebuilt from their stored
+ * halves and inverted with a single complex transform. The imaginary parts of
+ * the zero and Nyquist columns are ignored, which gives the same result as
+ * keeping only the real part of a full complex inverse transform. Both passes
+ * are split across the global thread pool. Stacked spectra are inverted
+ * together, as realFFT2D transforms them.
+ *
+ * Parameters -
+ *          real - the real parts, rows x halfSpectrumCols(cols) (overwritten)
+ *          imag - the imaginary parts, rows x halfSpectrumCols(cols) (overwritten)
+ *          spatial - receives the image data, rows x cols
+ *          cols - the number of columns in the image
+ *          planes - the number of spectra stacked in real and imag
+ ******************************************************************************/
+template <typename T>
+void inverseRealFFT2D(Buffer2D<T>& real, Buffer2D<T>& imag, Buffer2D<T>& spatial,
+                      int cols, int planes)
+{
+    int total = real.rows();
+    int rows = total / planes;
+    int half = halfSpectrumCols(cols);
+    const FFTPlan<T>& rowPlan = FFTPlan<T>::get(cols, -1);
+    const FFTPlan<T>& colPlan = FFTPlan<T>::get(rows, -1);
+
+    spatial.resize(total, cols);
+
+    // Transform the stored columns
+    transformColumns(colPlan, real.rowPointers(), imag.rowPointers(), half, (T) 1,
+                     planes);
+
+    // Transform rows in pairs, Z = X1 + i*X2
+    ThreadPool::global().parallelFor((total + 1) / 2, [&](int begin, int end)
+    {
+        Scratch<T>& scratch = Scratch<T>::local();
+        std::complex<T>* line = Scratch<T>::reserve(scratch.line, cols);
+        std::complex<T>* work = Scratch<T>::reserve(scratch.work, rowPlan.workSize());
+
+        for (int r = 2 * begin; r < 2 * end && r < total; r += 2)
+        {
+            bool pair = (r + 1 < total);
+            int c;
+
+            for (c = 0; c < half; c++)
+            {
+                bool edge = (c == 0 || 2 * c == cols);
+                std::complex<T> x1(real[r][c], edge ? 0 : imag[r][c]);
+                std::complex<T> x2(0, 0);
+                if (pair)
+                    x2 = std::complex<T>(real[r + 1][c], edge ? 0 : imag[r + 1][c]);
+
+                line[c] = std::complex<T>(x1.real() - x2.imag(), x1.imag() + x2.real());
+                if (c > 0 && !edge)
+                {
+                    x1 = std::conj(x1);
+                    x2 = std::conj(x2);
+                    line[cols - c] = std::complex<T>(x1.real() - x2.imag(),
+                                                     x1.imag() + x2.real());
+                }
+            }
+
+            rowPlan.execute(line, work);
+
+            for (c = 0; c < cols; c++)
+            {
+                spatial[r][c] = line[c].real();
+                if (pair)
+                    spatial[r + 1][c] = line[c].imag();
+            }
+        }
+    });
+}
+
+template class FFTPlan<float>;
+template class FFTPlan<double>;
+template void mixedFFT1D(int dir, int n, cfloat* data);
+template void mixedFFT1D(int dir, int n, cdouble* data);
+template void mixedFFT2D(int dir, int rows, int cols, float** real, float** imag);
+template void mixedFFT2D(int dir, int rows, int cols, double** real, double** imag);
+template void realFFT2D(const Buffer2D<float>& spatial, Buffer2D<float>& real,
+                        Buffer2D<float>& imag, int planes);
+template void realFFT2D(const Buffer2D<double>& spatial, Buffer2D<double>& real,
+                        Buffer2D<double>& imag, int planes);
+template void inverseRealFFT2D(Buffer2D<float>& real, Buffer2D<float>& imag,
+                               Buffer2D<float>& spatial, int cols, int planes);
+template void inverseRealFFT2D(Buffer2D<double>& real, Buffer2D<double>& imag,
+                               Buffer2D<double>& spatial, int cols, int planes);
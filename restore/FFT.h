@@ -0,0 +1,152 @@
+/***************************************************************************//**
+ * FFT.h
+ *
+ * Author - Dan Andrus, Derek Stotz
+ *
+ * Date - May 2, 2015
+ *
+ * Details - Contains the declarations for our own fast Fourier transform.
+ *           Unlike the fft2D supplied by QtImageLib, this transform is not
+ *           restricted to square images whose dimensions are powers of 2.
+ *           Lengths are factored into radix 2, 3, 4, 5 and 7 butterflies
+ *           (other small primes use a generic butterfly) and lengths with
+ *           a large prime factor fall back on Bluestein's algorithm.
+ *
+ *           Images are real, so their frequency data is conjugate symmetric.
+ *           realFFT2D and inverseRealFFT2D store only the non-redundant half
+ *           of it, rows x (cols/2 + 1), which halves both the memory and the
+ *           work of the transform.
+ *
+ *           Everything is templated on the scalar type. FFT.cpp instantiates
+ *           float, used throughout, and double, for spectra that need the
+ *           extra precision (see Spectrum).
+ ******************************************************************************/
+#pragma once
+#include <complex>
+#include <vector>
+#include "Buffer2D.h"
+
+typedef std::complex<float> cfloat;
+typedef std::complex<double> cdouble;
+
+/***************************************************************************//**
+ * FFTPlan
+ *
+ * Author - Dan Andrus
+ *
+ * Holds everything needed to run a one-dimensional transform of a fixed
+ * length in a fixed direction: the factorization of the length, the twiddle
+ * factors for each pass and, for awkward lengths, the Bluestein chirp.
+ *
+ * The transform computed by execute() is unnormalized. The direction follows
+ * the fft2D convention: 1 for the forward transform (negative exponent), -1
+ * for the inverse transform.
+ *
+ * Building a plan costs a few trigonometric calls per point, which is a large
+ * part of a transform of a small image. get() keeps every plan it builds, so
+ * transforms of the same size after the first one skip that work; this is
+ * what the 2D transforms use. A plan is never changed after it is built, so
+ * one plan can be executed by any number of threads at once.
+ *
+ * T is float or double. The twiddle factors are always computed in double
+ * and rounded to T.
+ ******************************************************************************/
+template <typename T>
+class FFTPlan
+{
+  public:
+    typedef std::complex<T> complex;
+
+    FFTPlan(int n, int dir);
+
+    static const FFTPlan& get(int n, int dir);
+    static int cachedPlans();
+
+    int size() const { return n; }
+    int direction() const { return dir; }
+    int workSize() const;
+
+    void execute(complex* data, complex* work) const;
+
+  private:
+    struct Stage
+    {
+        int radix;                  // butterfly size of this pass
+        int span;                   // product of the radices of earlier passes
+        std::vector<complex> twiddles;
+        std::vector<complex> roots; // radix-th roots of unity (generic passes)
+    };
+
+    void factor();
+    void stockham(complex* data, complex* work) const;
+    void bluesteinExecute(complex* data, complex* work) const;
+
+    int n;
+    int dir;
+    std::vector<Stage> stages;
+
+    // Bluestein state, only used when n has a large prime factor
+    bool bluestein;
+    int m;
+    std::vector<complex> chirp;
+    std::vector<complex> chirpSpectrum;
+    const FFTPlan* forwardM;
+    const FFTPlan* inverseM;
+
+    FFTPlan(const FFTPlan&);
+    FFTPlan& operator=(const FFTPlan&);
+};
+
+template <typename T>
+void mixedFFT1D(int dir, int n, std::complex<T>* data);
+template <typename T>
+void mixedFFT2D(int dir, int rows, int cols, T** real, T** imag);
+template <typename T>
+void realFFT2D(const Buffer2D<T>& spatial, Buffer2D<T>& real, Buffer2D<T>& imag,
+               int planes = 1);
+template <typename T>
+void inverseRealFFT2D(Buffer2D<T>& real, Buffer2D<T>& imag, Buffer2D<T>& spatial,
+                      int cols, int planes = 1);
+
+/***************************************************************************//**
+ * halfSpectrumCols
+ * Author - Dan Andrus
+ *
+ * Returns the number of columns stored for the frequency data of a real image
+ * with the given number of columns. Only the columns 0 through cols/2 are kept
+ * since the rest are complex conjugates of those.
+ ******************************************************************************/
+inline int halfSpectrumCols(int cols)
+{
+    return cols / 2 + 1;
+}
+
+/***************************************************************************//**
+ * halfSpectrumIndex
+ * Author - Dan Andrus
+ *
+ * Finds where a bin of the full frequency data of a real image is stored in
+ * the half spectrum. A bin F(r, c) with c > cols/2 is not stored, but equals
+ * the conjugate of the stored bin F(-r, -c).
+ *
+ * Parameters -
+ *          r, c - the row and column of the bin in the full spectrum
+ *          rows, cols - the dimensions of the full spectrum
+ *          hr, hc - set to the row and column of the stored bin
+ *
+ * Returns
+ *          true if the bin is the conjugate of the stored bin, false if it is
+ *          the stored bin itself
+ ******************************************************************************/
+inline bool halfSpectrumIndex(int r, int c, int rows, int cols, int& hr, int& hc)
+{
+    if (c <= cols / 2)
+    {
+        hr = r;
+        hc = c;
+        return false;
+    }
+    hr = (rows - r) % rows;
+    hc = cols - c;
+    return true;
+}
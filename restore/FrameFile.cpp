@@ -0,0 +1,225 @@
+/***************************************************************************//**
+ * FrameFile.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 22, 2015
+ *
+ * Details - Reads and writes frame files through MappedFile.
+ ******************************************************************************/
+#include "FrameFile.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+
+static const char FRAME_FILE_MAGIC[8] = { 'P', 'R', 'O', 'G', '3', 'F', 'R', 'M' };
+static const uint32_t FRAME_FILE_BYTE_ORDER = 0x01020304;
+
+/***************************************************************************//**
+ * roundUp
+ * Author - Dan Andrus
+ *
+ * Returns n rounded up to a multiple of FRAME_FILE_ALIGNMENT.
+ ******************************************************************************/
+static uint64_t roundUp(uint64_t n)
+{
+    return (n + FRAME_FILE_ALIGNMENT - 1) / FRAME_FILE_ALIGNMENT * FRAME_FILE_ALIGNMENT;
+}
+
+/***************************************************************************//**
+ * checkHeader
+ * Author - Dan Andrus
+ *
+ * Checks that a header describes a frame this version can read and that the
+ * file is large enough to hold it.
+ *
+ * Returns
+ *          true if it does, false with error set if not
+ ******************************************************************************/
+static bool checkHeader(const FrameFileHeader& header, uint64_t size, std::string& error)
+{
+    bool frequency = (header.domain == FrameFileHeader::FREQUENCY);
+
+    if (memcmp(header.magic, FRAME_FILE_MAGIC, sizeof(FRAME_FILE_MAGIC)) != 0)
+        error = "not a frame file";
+    else if (header.byteOrder != FRAME_FILE_BYTE_ORDER)
+        error = "written on a machine with a different byte order";
+    else if (header.version > FRAME_FILE_VERSION)
+        error = "written by a newer version";
+    else if (header.precision != sizeof(float))
+        error = "only float frames are supported";
+    else if (header.layout != FrameFileHeader::PLANAR_ROWS)
+        error = "unknown layout";
+    else if (header.domain != FrameFileHeader::SPATIAL && !frequency)
+        error = "unknown domain";
+    else if (header.rows <= 0 || header.cols <= 0
+             || header.planeCols != (frequency ? header.cols / 2 + 1 : header.cols)
+             || header.stride < header.planeCols
+             || header.planes != (frequency ? 2u : 1u))
+        error = "bad dimensions";
+    else if (header.planeBytes > size
+             || header.planeBytes < (uint64_t) header.rows * header.stride * sizeof(float)
+             || header.dataOffset < sizeof(FrameFileHeader) + (uint64_t) header.historyBytes
+             || header.dataOffset + header.planes * header.planeBytes > size)
+        error = "file is truncated or damaged";
+
+    return error.empty();
+}
+
+/***************************************************************************//**
+ * isFrameFile
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          true if the file starts like a frame file
+ ******************************************************************************/
+bool isFrameFile(const std::string& path)
+{
+    char magic[sizeof(FRAME_FILE_MAGIC)];
+    FILE* in = fopen(path.c_str(), "rb");
+    bool match = false;
+
+    if (in == NULL)
+        return false;
+
+    match = (fread(magic, 1, sizeof(magic), in) == sizeof(magic)
+             && memcmp(magic, FRAME_FILE_MAGIC, sizeof(magic)) == 0);
+    fclose(in);
+    return match;
+}
+
+/***************************************************************************//**
+ * readFrameFile
+ * Author - Dan Andrus
+ *
+ * Maps a frame file into a frame. The planes use the mapped file directly,
+ * so reading costs nothing up front and each part of the data is paged in
+ * from the file only when it is first used. Changes made to the frame stay
+ * in memory and never reach the file.
+ *
+ * Parameters -
+ *          path - the file to read
+ *          frame - replaced by the frame in the file
+ *          error - set to a description of the problem on failure
+ *
+ * Returns
+ *          true if successful, false if the file could not be read
+ ******************************************************************************/
+bool readFrameFile(const std::string& path, Frame& frame, std::string& error)
+{
+    std::shared_ptr<MappedFile> file = MappedFile::open(path, MappedFile::COPY_ON_WRITE,
+                                                        error);
+    FrameFileHeader header;
+
+    if (!file)
+        return false;
+
+    memset(&header, 0, sizeof(header));
+    if (file->size() >= sizeof(header))
+        memcpy(&header, file->data(), sizeof(header));
+    if (!checkHeader(header, file->size(), error))
+    {
+        error = path + ": " + error;
+        return false;
+    }
+
+    bool frequency = (header.domain == FrameFileHeader::FREQUENCY);
+    Buffer2D<float>* planes[2] = { &frame.spatial, NULL };
+    if (frequency)
+    {
+        planes[0] = &frame.real;
+        planes[1] = &frame.imag;
+    }
+
+    frame.spatial.release();
+    frame.real.release();
+    frame.imag.release();
+    frame.cols = header.cols;
+    frame.frequency = frequency;
+    frame.history.assign(file->data() + sizeof(header), header.historyBytes);
+
+    for (uint32_t p = 0; p < header.planes; p++)
+    {
+        float* data = (float*) (file->data() + header.dataOffset + p * header.planeBytes);
+
+        // Files written by writeFrameFile are laid out just as a Buffer2D is
+        if (header.stride == Buffer2D<float>::pitchFor(header.planeCols)
+            && (size_t) data % BUFFER2D_ALIGNMENT == 0)
+        {
+            planes[p]->adopt(data, header.rows, header.planeCols, file);
+            continue;
+        }
+
+        planes[p]->resize(header.rows, header.planeCols);
+        for (int r = 0; r < header.rows; r++)
+            memcpy((*planes[p])[r], data + (size_t) r * header.stride,
+                   header.planeCols * sizeof(float));
+    }
+    return true;
+}
+
+/***************************************************************************//**
+ * writeFrameFile
+ * Author - Dan Andrus
+ *
+ * Writes a frame to a new frame file through a mapping of the file. The file
+ * must not be the one the frame was read from.
+ *
+ * Parameters -
+ *          path - the file to write, replaced if it exists
+ *          frame - the frame to write, in either domain
+ *          error - set to a description of the problem on failure
+ *
+ * Returns
+ *          true if successful, false if the file could not be written
+ ******************************************************************************/
+bool writeFrameFile(const std::string& path, const Frame& frame, std::string& error)
+{
+    const Buffer2D<float>* planes[2] = { &frame.spatial, NULL };
+    FrameFileHeader header;
+
+    if (frame.frequency)
+    {
+        planes[0] = &frame.real;
+        planes[1] = &frame.imag;
+    }
+    if (planes[0]->empty())
+    {
+        error = "Nothing to write to " + path;
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FRAME_FILE_MAGIC, sizeof(FRAME_FILE_MAGIC));
+    header.byteOrder = FRAME_FILE_BYTE_ORDER;
+    header.version = FRAME_FILE_VERSION;
+    header.precision = sizeof(float);
+    header.layout = FrameFileHeader::PLANAR_ROWS;
+    header.domain = frame.frequency ? FrameFileHeader::FREQUENCY : FrameFileHeader::SPATIAL;
+    header.rows = planes[0]->rows();
+    header.cols = frame.frequency ? frame.cols : frame.spatial.cols();
+    header.planeCols = planes[0]->cols();
+    header.stride = Buffer2D<float>::pitchFor(header.planeCols);
+    header.planes = frame.frequency ? 2 : 1;
+    header.historyBytes = (uint32_t) frame.history.size();
+    header.planeBytes = roundUp((uint64_t) header.rows * header.stride * sizeof(float));
+    header.dataOffset = (uint32_t) roundUp(sizeof(header) + frame.history.size());
+
+    std::shared_ptr<MappedFile> file = MappedFile::create(path,
+        (size_t) (header.dataOffset + header.planes * header.planeBytes), error);
+    if (!file)
+        return false;
+
+    memcpy(file->data(), &header, sizeof(header));
+    memcpy(file->data() + sizeof(header), frame.history.data(), frame.history.size());
+
+    for (uint32_t p = 0; p < header.planes; p++)
+    {
+        float* data = (float*) (file->data() + header.dataOffset + p * header.planeBytes);
+
+        for (int r = 0; r < header.rows; r++)
+            memcpy(data + (size_t) r * header.stride, (*planes[p])[r],
+                   header.planeCols * sizeof(float));
+    }
+    return file->sync(error);
+}
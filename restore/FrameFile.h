@@ -0,0 +1,68 @@
+/***************************************************************************//**
+ * FrameFile.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 22, 2015
+ *
+ * Details - Contains the frame file format, which stores the intensities or
+ *           the half spectrum of an image as raw floats so it can be mapped
+ *           straight back into memory, and the functions that read and write
+ *           it.
+ ******************************************************************************/
+#pragma once
+#include <stdint.h>
+#include <string>
+#include "Pipeline.h"
+
+// Suffix used for frame files
+static const char* const FRAME_FILE_SUFFIX = "p3f";
+
+static const uint32_t FRAME_FILE_VERSION = 1;
+
+// Planes start at multiples of this many bytes, so that they are aligned
+// wherever the system maps the file
+static const uint32_t FRAME_FILE_ALIGNMENT = 4096;
+
+/***************************************************************************//**
+ * FrameFileHeader
+ *
+ * Author - Dan Andrus
+ *
+ * The start of a frame file. It is followed by historyBytes of text listing
+ * the pipeline stages the frame went through, then zeros up to dataOffset,
+ * where the planes begin.
+ *
+ * A spatial frame has one plane of rows x cols intensities. A frequency frame
+ * has two planes, the real then the imaginary parts of the half spectrum,
+ * rows x (cols/2 + 1), as left by realFFT2D: the forward transform is divided
+ * by rows * cols. Each plane is stored row by row with stride values per row,
+ * the padding included, and takes planeBytes.
+ *
+ * Values are stored in the byte order of the machine that wrote the file,
+ * which byteOrder identifies.
+ ******************************************************************************/
+struct FrameFileHeader
+{
+    enum Domain { SPATIAL = 0, FREQUENCY = 1 };
+    enum Layout { PLANAR_ROWS = 0 };
+
+    char magic[8];              // "PROG3FRM"
+    uint32_t byteOrder;         // 0x01020304
+    uint32_t version;           // FRAME_FILE_VERSION
+    uint32_t dataOffset;        // bytes before the first plane
+    uint32_t precision;         // bytes per value; 4 for float
+    uint32_t layout;            // a Layout
+    uint32_t domain;            // a Domain
+    int32_t rows;               // height of the image
+    int32_t cols;               // width of the image
+    int32_t planeCols;          // values per row: cols or cols/2 + 1
+    int32_t stride;             // values per row, padding included
+    uint32_t planes;            // 1 or 2
+    uint32_t historyBytes;      // length of the history text
+    uint64_t planeBytes;        // bytes per plane, padding included
+};
+
+bool isFrameFile(const std::string& path);
+bool readFrameFile(const std::string& path, Frame& frame, std::string& error);
+bool writeFrameFile(const std::string& path, const Frame& frame, std::string& error);
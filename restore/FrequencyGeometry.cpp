@@ -0,0 +1,87 @@
+/***************************************************************************//**
+ * FrequencyGeometry.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 9, 2015
+ *
+ * Details - Builds and caches the frequency lookup tables.
+ ******************************************************************************/
+
+#include "FrequencyGeometry.h"
+#include <map>
+#include <mutex>
+#include <utility>
+
+/***************************************************************************//**
+ * get
+ * Author - Dan Andrus
+ *
+ * Returns the lookup tables for the given image size, building them the
+ * first time the size is seen. Safe to call from several threads.
+ *
+ * Parameters -
+ *          rows - the height of the image
+ *          cols - the width of the image
+ *
+ * Returns
+ *          the tables for the image size
+ ******************************************************************************/
+const FrequencyGeometry& FrequencyGeometry::get(int rows, int cols)
+{
+    static std::map<std::pair<int, int>, FrequencyGeometry*> cache;
+    static std::mutex lock;
+
+    std::lock_guard<std::mutex> guard(lock);
+    FrequencyGeometry*& entry = cache[std::make_pair(rows, cols)];
+    if (entry == NULL)
+        entry = new FrequencyGeometry(rows, cols);
+    return *entry;
+}
+
+/***************************************************************************//**
+ * FrequencyGeometry
+ * Author - Dan Andrus
+ *
+ * Fills in every table for the given image size.
+ ******************************************************************************/
+FrequencyGeometry::FrequencyGeometry(int rows, int cols)
+    : rows(rows), cols(cols), halfCols(cols / 2 + 1),
+      origin_x(cols / 2), origin_y(rows / 2),
+      rowDist2(rows), colDist2(cols), spectrumRow(rows), conjugateRow(rows),
+      spectrumCol(cols), mirroredCol(cols), displayRow(rows), displayCol(cols),
+      freqRow(rows), freqCol(cols / 2 + 1), freqRowDist2(rows),
+      freqColDist2(cols / 2 + 1)
+{
+    for (int y = 0; y < rows; y++)
+    {
+        int u = (y - origin_y + rows) % rows;
+
+        rowDist2[y] = (float) (y - origin_y) * (y - origin_y);
+        spectrumRow[y] = u;
+        conjugateRow[y] = (rows - u) % rows;
+        displayRow[u] = y;
+    }
+
+    for (int x = 0; x < cols; x++)
+    {
+        int v = (x - origin_x + cols) % cols;
+
+        colDist2[x] = (float) (x - origin_x) * (x - origin_x);
+        mirroredCol[x] = (v > cols / 2);
+        spectrumCol[x] = mirroredCol[x] ? cols - v : v;
+        displayCol[v] = x;
+    }
+
+    for (int u = 0; u < rows; u++)
+    {
+        freqRow[u] = (float) (displayRow[u] - origin_y);
+        freqRowDist2[u] = freqRow[u] * freqRow[u];
+    }
+
+    for (int v = 0; v < halfCols; v++)
+    {
+        freqCol[v] = (float) (displayCol[v] - origin_x);
+        freqColDist2[v] = freqCol[v] * freqCol[v];
+    }
+}
@@ -0,0 +1,72 @@
+/***************************************************************************//**
+ * FrequencyGeometry.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 9, 2015
+ *
+ * Details - Contains the FrequencyGeometry class, which holds lookup tables
+ *           relating the displayed frequency image to the stored half
+ *           spectrum, so that filters no longer recompute distances and
+ *           modulo shifts for every pixel.
+ ******************************************************************************/
+#pragma once
+#include <vector>
+
+/***************************************************************************//**
+ * FrequencyGeometry
+ *
+ * Author - Dan Andrus
+ *
+ * Lookup tables for one image size. The frequency image is displayed with
+ * the zero frequency at (origin_x, origin_y) = (cols/2, rows/2), so the pixel
+ * at display position (y, x) is the bin (y - origin_y, x - origin_x) of the
+ * full spectrum, wrapped around.
+ *
+ * The squared distance of a display pixel from the center is
+ * rowDist2[y] + colDist2[x]. Since both tables are one-dimensional this costs
+ * a single addition per pixel and O(rows + cols) memory rather than a full
+ * rows x cols table.
+ *
+ * Filters that walk the half spectrum directly use the spectrum-ordered
+ * tables instead: bin (u, v) of the half spectrum is drawn at offset
+ * (freqRow[u], freqCol[v]) from the center, at squared distance
+ * freqRowDist2[u] + freqColDist2[v].
+ *
+ * The pixel's bin is stored in the half spectrum at row
+ * (mirroredCol[x] ? conjugateRow[y] : spectrumRow[y]) and column
+ * spectrumCol[x]. When mirroredCol[x] is set the pixel shows the conjugate of
+ * that stored bin.
+ *
+ * Tables are built once per image size by get() and kept for the life of the
+ * program.
+ ******************************************************************************/
+class FrequencyGeometry
+{
+  public:
+    static const FrequencyGeometry& get(int rows, int cols);
+
+    int rows;
+    int cols;
+    int halfCols;
+    int origin_x;
+    int origin_y;
+
+    std::vector<float> rowDist2;    // (y - origin_y)^2 for each display row
+    std::vector<float> colDist2;    // (x - origin_x)^2 for each display column
+    std::vector<int> spectrumRow;   // stored row of display row y
+    std::vector<int> conjugateRow;  // stored row of the mirror of display row y
+    std::vector<int> spectrumCol;   // stored column of display column x
+    std::vector<char> mirroredCol;  // display column x is not stored directly
+
+    std::vector<int> displayRow;    // display row of spectrum row u
+    std::vector<int> displayCol;    // display column of spectrum column v
+
+    std::vector<float> freqRow;     // signed offset from the center of row u
+    std::vector<float> freqCol;     // signed offset of stored column v
+    std::vector<float> freqRowDist2;
+    std::vector<float> freqColDist2;
+
+  private:
+    FrequencyGeometry(int rows, int cols);
+};
@@ -0,0 +1,466 @@
+/***************************************************************************//**
+ * GaussianSmoother.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 27, 2015
+ *
+ * Details - Defines the GaussianSmoother class.
+ ******************************************************************************/
+#define _USE_MATH_DEFINES
+#include "GaussianSmoother.h"
+#include "FFT.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include "Transfer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Estimated cost per pixel of each method, in units of one multiply-add of
+// the convolution: per pair of taps, per bit of log2(rows * cols) for the
+// transforms, and in all for the recursive filter
+static const double CONVOLUTION_COST = 1.0;
+static const double FREQUENCY_COST = 12.0;
+static const double RECURSIVE_COST = 60.0;
+
+// Least deviation the recursive filter is used for; below it its error grows
+static const double RECURSIVE_MIN_DEVIATION = 2.0;
+
+// Deviations of padding on each side of the recursive filter's input
+static const double RECURSIVE_PAD = 5.0;
+
+// Columns filtered together by the recursive filter's vertical pass
+static const int RECURSIVE_STRIP = 64;
+
+/***************************************************************************//**
+ * smoothingKernel
+ * Author - Dan Andrus
+ *
+ * Computes the kernel whose circular convolution along an axis of n pixels
+ * equals multiplying its transform by exp(-f^2 / 2r^2), f running over the
+ * signed frequencies of the axis, by transforming those gains back in
+ * double. The kernel is cut off at the fewest taps w either side of its
+ * center that leave out at most SMOOTH_KERNEL_TOLERANCE of its absolute sum.
+ * The ripple of a wide cutoff (see GaussianSmoother) is counted like any
+ * other tail, so such kernels usually come out too long.
+ *
+ * Returns
+ *          taps 0 to w, or none if w would exceed MAX_SMOOTH_KERNEL
+ ******************************************************************************/
+static std::vector<float> smoothingKernel(double radius, int n)
+{
+    std::vector<cdouble> kernel(n);
+    std::vector<float> taps;
+
+    for (int k = 0; k < n; k++)
+    {
+        double f = (k <= n / 2) ? k : k - n;
+        kernel[k] = exp(-f * f / (2.0 * radius * radius));
+    }
+    mixedFFT1D(-1, n, &kernel[0]);
+
+    // Absolute sum of the taps beyond w, from the middle inwards
+    double tail = (n % 2 == 0) ? fabs(kernel[n / 2].real()) / n : 0;
+    int w = (n - 1) / 2;
+    while (w > 0 && tail + 2 * fabs(kernel[w].real()) / n <= SMOOTH_KERNEL_TOLERANCE)
+    {
+        tail += 2 * fabs(kernel[w].real()) / n;
+        w--;
+    }
+    if (w > MAX_SMOOTH_KERNEL || (w == (n - 1) / 2 && tail > SMOOTH_KERNEL_TOLERANCE))
+        return taps;
+
+    for (int m = 0; m <= w; m++)
+        taps.push_back((float) (kernel[m].real() / n));
+    return taps;
+}
+
+/***************************************************************************//**
+ * GaussianSmoother
+ * Author - Dan Andrus
+ *
+ * Prepares to smooth images of the given size with GaussianLowPass(radius).
+ * The kernels are computed here, so one smoother should be reused for
+ * images of the same size.
+ ******************************************************************************/
+GaussianSmoother::GaussianSmoother(double radius, int rows, int cols)
+    : radius(radius), rows(rows), cols(cols),
+      rowKernel(smoothingKernel(radius, cols)),
+      colKernel(smoothingKernel(radius, rows)),
+      requested(SMOOTH_AUTO), approximate(false)
+{
+    if (rowKernel.empty() || colKernel.empty())
+    {
+        rowKernel.clear();
+        colKernel.clear();
+    }
+}
+
+/***************************************************************************//**
+ * GaussianSmoother::available
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          true if the method can be used for this radius and size
+ ******************************************************************************/
+bool GaussianSmoother::available(SmoothingMethod method) const
+{
+    double deviation = std::min(rows, cols) / (2 * M_PI * radius);
+
+    switch (method)
+    {
+        case SMOOTH_CONVOLUTION:
+            return !rowKernel.empty();
+
+        case SMOOTH_RECURSIVE:
+            return deviation >= RECURSIVE_MIN_DEVIATION;
+
+        default:
+            return true;
+    }
+}
+
+/***************************************************************************//**
+ * GaussianSmoother::method
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the method run() uses: the one set with setMethod, if it is
+ *          available, otherwise the cheapest one allowed
+ ******************************************************************************/
+SmoothingMethod GaussianSmoother::method() const
+{
+    if (requested != SMOOTH_AUTO)
+        return available(requested) ? requested : SMOOTH_FREQUENCY;
+
+    SmoothingMethod best = SMOOTH_FREQUENCY;
+    double cost = FREQUENCY_COST * log2((double) rows * cols);
+
+    if (approximate && available(SMOOTH_RECURSIVE) && RECURSIVE_COST < cost)
+    {
+        best = SMOOTH_RECURSIVE;
+        cost = RECURSIVE_COST;
+    }
+    if (available(SMOOTH_CONVOLUTION)
+        && CONVOLUTION_COST * (rowKernel.size() + colKernel.size()) < cost)
+        best = SMOOTH_CONVOLUTION;
+    return best;
+}
+
+/***************************************************************************//**
+ * GaussianSmoother::kernelRadius
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the taps either side of the center of the kernel along a column
+ *          (vertical) or a row, or -1 if the convolution is not available
+ ******************************************************************************/
+int GaussianSmoother::kernelRadius(bool vertical) const
+{
+    return (int) (vertical ? colKernel.size() : rowKernel.size()) - 1;
+}
+
+/***************************************************************************//**
+ * GaussianSmoother::run
+ * Author - Dan Andrus
+ *
+ * Smooths an image of the size given to the constructor, in place.
+ ******************************************************************************/
+void GaussianSmoother::run(Buffer2D<float>& image) const
+{
+    switch (method())
+    {
+        case SMOOTH_CONVOLUTION:
+            convolve(image);
+            break;
+
+        case SMOOTH_RECURSIVE:
+            recursive(image);
+            break;
+
+        default:
+            frequency(image);
+            break;
+    }
+}
+
+/***************************************************************************//**
+ * GaussianSmoother::name
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the name of a method, for messages
+ ******************************************************************************/
+const char* GaussianSmoother::name(SmoothingMethod method)
+{
+    switch (method)
+    {
+        case SMOOTH_FREQUENCY:
+            return "frequency";
+        case SMOOTH_CONVOLUTION:
+            return "convolution";
+        case SMOOTH_RECURSIVE:
+            return "recursive";
+        default:
+            return "auto";
+    }
+}
+
+/***************************************************************************//**
+ * GaussianSmoother::frequency
+ * Author - Dan Andrus
+ *
+ * Smooths an image through its spectrum.
+ ******************************************************************************/
+void GaussianSmoother::frequency(Buffer2D<float>& image) const
+{
+    Buffer2D<float> real;
+    Buffer2D<float> imag;
+
+    realFFT2D(image, real, imag);
+    applyTransfer(GaussianLowPass(radius), real, imag, cols);
+    inverseRealFFT2D(real, imag, image, cols);
+}
+
+/***************************************************************************//**
+ * GaussianSmoother::convolve
+ * Author - Dan Andrus
+ *
+ * Convolves an image with the row kernel into a scratch image and the
+ * scratch image with the column kernel back into the image. Each row is
+ * copied with w pixels wrapped around on either side, so the row pass never
+ * checks for the edges. The column pass builds an output row from the rows
+ * above and below it, so the row being summed into stays in the cache. Both
+ * passes split the rows across the global thread pool, and each output is
+ * summed in the same order however they are split.
+ ******************************************************************************/
+void GaussianSmoother::convolve(Buffer2D<float>& image) const
+{
+    const float* kx = &rowKernel[0];
+    const float* ky = &colKernel[0];
+    int wx = (int) rowKernel.size() - 1;
+    int wy = (int) colKernel.size() - 1;
+    Buffer2D<float> scratch(rows, cols);
+
+    ThreadPool::global().parallelFor(rows, [&](int begin, int end)
+    {
+        Buffer2D<float> padded(1, cols + 2 * wx);
+        float* p = padded[0];
+
+        for (int r = begin; r < end; r++)
+        {
+            const float* in = image[r];
+            float* out = scratch[r];
+            int c = 0;
+
+            memcpy(p, in + cols - wx, wx * sizeof(float));
+            memcpy(p + wx, in, cols * sizeof(float));
+            memcpy(p + wx + cols, in, wx * sizeof(float));
+
+            for (; c + VFLOAT_WIDTH <= cols; c += VFLOAT_WIDTH)
+            {
+                const float* q = p + c + wx;
+                vfloat sum = vloadu<vfloat>(q) * vfloat(kx[0]);
+                for (int j = 1; j <= wx; j++)
+                    sum = sum + (vloadu<vfloat>(q - j) + vloadu<vfloat>(q + j)) * vfloat(kx[j]);
+                vstore(out + c, sum);
+            }
+            for (; c < cols; c++)
+            {
+                const float* q = p + c + wx;
+                float sum = q[0] * kx[0];
+                for (int j = 1; j <= wx; j++)
+                    sum += (q[-j] + q[j]) * kx[j];
+                out[c] = sum;
+            }
+        }
+    });
+
+    ThreadPool::global().parallelFor(rows, [&](int begin, int end)
+    {
+        for (int r = begin; r < end; r++)
+        {
+            const float* in = scratch[r];
+            float* out = image[r];
+            int c;
+
+            for (c = 0; c + VFLOAT_WIDTH <= cols; c += VFLOAT_WIDTH)
+                vstore(out + c, vload<vfloat>(in + c) * vfloat(ky[0]));
+            for (; c < cols; c++)
+                out[c] = in[c] * ky[0];
+
+            for (int j = 1; j <= wy; j++)
+            {
+                const float* above = scratch[(r - j + rows) % rows];
+                const float* below = scratch[(r + j) % rows];
+                vfloat tap(ky[j]);
+
+                for (c = 0; c + VFLOAT_WIDTH <= cols; c += VFLOAT_WIDTH)
+                    vstore(out + c, vload<vfloat>(out + c)
+                           + (vload<vfloat>(above + c) + vload<vfloat>(below + c)) * tap);
+                for (; c < cols; c++)
+                    out[c] += (above[c] + below[c]) * ky[j];
+            }
+        }
+    });
+}
+
+/***************************************************************************//**
+ * RecursiveGaussian
+ *
+ * Author - Dan Andrus
+ *
+ * The coefficients of Young and van Vliet's recursive Gaussian for a
+ * deviation of at least half a pixel, normalized so that each pass is
+ *
+ *      w[i] = B x[i] + a1 w[i - 1] + a2 w[i - 2] + a3 w[i - 3]
+ *
+ * forwards and the same backwards, and pad, the samples of padding needed
+ * on each side for the response to die away.
+ ******************************************************************************/
+struct RecursiveGaussian
+{
+    explicit RecursiveGaussian(double deviation)
+    {
+        double q = (deviation >= 2.5) ? 0.98711 * deviation - 0.96330
+                                      : 3.97156 - 4.14554 * sqrt(1 - 0.26891 * deviation);
+        double b0 = 1.57825 + 2.44413 * q + 1.4281 * q * q + 0.422205 * q * q * q;
+        double b1 = 2.44413 * q + 2.85619 * q * q + 1.26661 * q * q * q;
+        double b2 = -(1.4281 * q * q + 1.26661 * q * q * q);
+        double b3 = 0.422205 * q * q * q;
+
+        a1 = (float) (b1 / b0);
+        a2 = (float) (b2 / b0);
+        a3 = (float) (b3 / b0);
+        B = 1.0f - a1 - a2 - a3;
+        pad = (int) ceil(RECURSIVE_PAD * deviation) + 3;
+    }
+
+    float B;
+    float a1;
+    float a2;
+    float a3;
+    int pad;
+};
+
+/***************************************************************************//**
+ * GaussianSmoother::recursive
+ * Author - Dan Andrus
+ *
+ * Runs the recursive filter along every row, then down every column. Each
+ * line is padded by wrapping around. Rows are filtered one by one across the
+ * global thread pool. Columns are filtered RECURSIVE_STRIP at a time with
+ * vfloat, the forward pass of a strip kept in a scratch buffer for the
+ * backward pass, and the strips split across the pool.
+ ******************************************************************************/
+void GaussianSmoother::recursive(Buffer2D<float>& image) const
+{
+    RecursiveGaussian across(cols / (2 * M_PI * radius));
+    RecursiveGaussian down(rows / (2 * M_PI * radius));
+
+    ThreadPool::global().parallelFor(rows, [&](int begin, int end)
+    {
+        const RecursiveGaussian& g = across;
+        int n = cols + 2 * g.pad;
+        std::vector<float> w(n);
+
+        for (int r = begin; r < end; r++)
+        {
+            float* row = image[r];
+            int first = ((-g.pad) % cols + cols) % cols;
+            float w1 = row[first], w2 = w1, w3 = w1;
+
+            for (int i = 0, c = first; i < n; i++)
+            {
+                w[i] = g.B * row[c] + g.a1 * w1 + g.a2 * w2 + g.a3 * w3;
+                w3 = w2;
+                w2 = w1;
+                w1 = w[i];
+                if (++c == cols)
+                    c = 0;
+            }
+
+            float y1 = w[n - 1], y2 = y1, y3 = y1;
+            for (int i = n - 1; i >= g.pad; i--)
+            {
+                float y = g.B * w[i] + g.a1 * y1 + g.a2 * y2 + g.a3 * y3;
+                y3 = y2;
+                y2 = y1;
+                y1 = y;
+                if (i < g.pad + cols)
+                    row[i - g.pad] = y;
+            }
+        }
+    });
+
+    int strips = (cols + RECURSIVE_STRIP - 1) / RECURSIVE_STRIP;
+    ThreadPool::global().parallelFor(strips, [&](int begin, int end)
+    {
+        const RecursiveGaussian& g = down;
+        int n = rows + 2 * g.pad;
+        Buffer2D<float> w(n, RECURSIVE_STRIP);
+        Buffer2D<float> history(3, RECURSIVE_STRIP);
+
+        for (int s = begin; s < end; s++)
+        {
+            int c0 = s * RECURSIVE_STRIP;
+            int width = std::min(RECURSIVE_STRIP, cols - c0);
+            int vectors = width - width % VFLOAT_WIDTH;
+            int first = ((-g.pad) % rows + rows) % rows;
+
+            for (int c = 0; c < width; c++)
+            {
+                float start = image[first][c0 + c];
+                history[0][c] = history[1][c] = history[2][c] = start;
+            }
+
+            // Forward, w[i] from the three rows before it
+            for (int i = 0, r = first; i < n; i++)
+            {
+                const float* x = image[r] + c0;
+                const float* w1 = (i > 0) ? w[i - 1] : history[0];
+                const float* w2 = (i > 1) ? w[i - 2] : history[1];
+                const float* w3 = (i > 2) ? w[i - 3] : history[2];
+                float* out = w[i];
+                int c = 0;
+
+                for (; c < vectors; c += VFLOAT_WIDTH)
+                    vstore(out + c, vfloat(g.B) * vload<vfloat>(x + c)
+                           + vfloat(g.a1) * vload<vfloat>(w1 + c)
+                           + vfloat(g.a2) * vload<vfloat>(w2 + c)
+                           + vfloat(g.a3) * vload<vfloat>(w3 + c));
+                for (; c < width; c++)
+                    out[c] = g.B * x[c] + g.a1 * w1[c] + g.a2 * w2[c] + g.a3 * w3[c];
+
+                if (++r == rows)
+                    r = 0;
+            }
+
+            // Backward, keeping the last three outputs in history
+            for (int c = 0; c < width; c++)
+                history[0][c] = history[1][c] = history[2][c] = w[n - 1][c];
+
+            for (int i = n - 1; i >= g.pad; i--)
+            {
+                const float* y1 = history[(i + 1) % 3];
+                const float* y2 = history[(i + 2) % 3];
+                float* y3 = history[i % 3];
+                const float* x = w[i];
+                int c = 0;
+
+                // y3 is the oldest and becomes the newest
+                for (; c < vectors; c += VFLOAT_WIDTH)
+                    vstore(y3 + c, vfloat(g.B) * vload<vfloat>(x + c)
+                           + vfloat(g.a1) * vload<vfloat>(y1 + c)
+                           + vfloat(g.a2) * vload<vfloat>(y2 + c)
+                           + vfloat(g.a3) * vload<vfloat>(y3 + c));
+                for (; c < width; c++)
+                    y3[c] = g.B * x[c] + g.a1 * y1[c] + g.a2 * y2[c] + g.a3 * y3[c];
+
+                if (i < g.pad + rows)
+                    memcpy(image[i - g.pad] + c0, y3, width * sizeof(float));
+            }
+        }
+    });
+}
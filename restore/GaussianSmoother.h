@@ -0,0 +1,113 @@
+/***************************************************************************//**
+ * GaussianSmoother.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 27, 2015
+ *
+ * Details - Contains the GaussianSmoother class, which applies the Gaussian
+ *           low-pass filter to an image in whichever domain is cheapest.
+ ******************************************************************************/
+#pragma once
+#include <vector>
+#include "Buffer2D.h"
+
+// Largest fraction of a convolution kernel's weight that may be cut off
+static const double SMOOTH_KERNEL_TOLERANCE = 1e-4;
+
+// Most taps either side of the center of a convolution kernel
+static const int MAX_SMOOTH_KERNEL = 128;
+
+// Ways GaussianSmoother can filter an image
+enum SmoothingMethod
+{
+    SMOOTH_AUTO,                    // pick the cheapest of the others
+    SMOOTH_FREQUENCY,               // fft, GaussianLowPass, ifft
+    SMOOTH_CONVOLUTION,             // separable convolution in the spatial domain
+    SMOOTH_RECURSIVE                // Young-van Vliet recursive filter
+};
+
+/***************************************************************************//**
+ * GaussianSmoother
+ *
+ * Author - Dan Andrus
+ *
+ * Gives the result of transforming an image, applying GaussianLowPass(radius)
+ * and transforming it back, without necessarily doing either transform.
+ *
+ * The low-pass gain exp(-(fy^2 + fx^2) / 2r^2) is the product of a gain for
+ * the rows and one for the columns, so the filter is a convolution with a
+ * row kernel followed by one with a column kernel, wrapping around the edges
+ * of the image as the transform does. Each kernel is computed as the exact
+ * inverse transform of its gains, for the image's own width or height, so it
+ * matches the frequency path for any size, powers of two or not. A kernel is
+ * a Gaussian of about N / (2 pi r) pixels' deviation, so the wider the
+ * cutoff, the shorter it is. It is cut off where the taps left out add up to
+ * SMOOTH_KERNEL_TOLERANCE, which bounds the difference from the frequency
+ * path to that fraction of the image's range.
+ *
+ * When the cutoff is so wide that the gain at the highest frequency of an
+ * axis is more than about 1%, the kernel is a large center tap with a ripple
+ * of alternating sign, left by the gains wrapping around at that frequency.
+ * The ripple's taps only fall off as 1/w^2, so their sum stays above the
+ * tolerance well past MAX_SMOOTH_KERNEL, and the convolution is not
+ * available. It becomes available again only once the gains are nearly flat,
+ * above about 93% at the highest frequency. The convolution therefore
+ * covers radii up to about a sixth of the image's shorter side, and from
+ * about 1.3 to 1.6 times its longer side on: for example r <= 78 and
+ * r >= 818 at 480x641, r <= 131 and r >= 1577 at 1023x769, and r <= 170 at
+ * 1080x1920. Radii between go through the transforms. An axis short enough
+ * for its whole kernel to fit in MAX_SMOOTH_KERNEL taps either side has no
+ * such gap, so at 256x256 and below every radius is covered.
+ *
+ * The methods are
+ *
+ * - SMOOTH_FREQUENCY: the transforms, exact and costing O(log N) per pixel
+ *   whatever the radius.
+ * - SMOOTH_CONVOLUTION: the two kernels applied in turn, a row or a group of
+ *   columns at a time with vfloat. It costs one multiply-add per pair of taps
+ *   and differs from the frequency path by rounding only. It is available
+ *   while both kernels are at most MAX_SMOOTH_KERNEL taps either side of
+ *   their center.
+ * - SMOOTH_RECURSIVE: the recursive Gaussian of Young and van Vliet, "Recursive
+ *   implementation of the Gaussian filter" (1995), run forwards and backwards
+ *   along each axis. Its cost does not depend on the radius at all, but it
+ *   only approximates a Gaussian: the result differs from the frequency path
+ *   by up to about a percent of the image's local contrast. The image is
+ *   padded by wrapping around so that its edges blend as in the other paths.
+ *   It is available for deviations of at least two pixels in each direction,
+ *   below which its error grows quickly.
+ *
+ * SMOOTH_AUTO picks the convolution when it is available and cheaper than
+ * the transforms, and the transforms otherwise. The recursive filter is only
+ * picked automatically if approximations are allowed, in which case it
+ * replaces the transforms.
+ ******************************************************************************/
+class GaussianSmoother
+{
+  public:
+    GaussianSmoother(double radius, int rows, int cols);
+
+    void setMethod(SmoothingMethod method) { requested = method; }
+    void setApproximate(bool allowed) { approximate = allowed; }
+
+    SmoothingMethod method() const;
+    bool available(SmoothingMethod method) const;
+    int kernelRadius(bool vertical) const;
+    void run(Buffer2D<float>& image) const;
+
+    static const char* name(SmoothingMethod method);
+
+  private:
+    void frequency(Buffer2D<float>& image) const;
+    void convolve(Buffer2D<float>& image) const;
+    void recursive(Buffer2D<float>& image) const;
+
+    double radius;
+    int rows;
+    int cols;
+    std::vector<float> rowKernel;   // taps 0 to w of the kernel along a row
+    std::vector<float> colKernel;   // and along a column; empty if too long
+    SmoothingMethod requested;
+    bool approximate;
+};
@@ -0,0 +1,170 @@
+/***************************************************************************//**
+ * Job.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 20, 2015
+ *
+ * Details - Defines the Job class.
+ ******************************************************************************/
+#include "Job.h"
+#include <algorithm>
+
+// Job of the operation running on this thread, if any
+static thread_local Job* T_Current_Job = NULL;
+
+// Parts a stage is divided into when tracking its progress
+static const int STAGE_PARTS = 1 << 20;
+
+Job::Job(int stages)
+    : stopped(false), name(""), stages(std::max(1, stages)), started(0),
+      loopDone(0), loopTotal(0), loopStart(0), loopShare(0)
+{
+}
+
+/***************************************************************************//**
+ * check
+ * Author - Dan Andrus
+ *
+ * Throws JobCancelled if the job has been cancelled.
+ ******************************************************************************/
+void Job::check() const
+{
+    if (stopped)
+        throw JobCancelled();
+}
+
+/***************************************************************************//**
+ * stage
+ * Author - Dan Andrus
+ *
+ * Starts the next stage of the operation.
+ *
+ * Parameters -
+ *          label - what the stage does, shown to the user; must stay valid
+ *                  for the life of the job
+ ******************************************************************************/
+void Job::stage(const char* label)
+{
+    check();
+    loopDone = 0;
+    loopTotal = 0;
+    loopStart = 0;
+    loopShare = 0;
+    name = label;
+    started++;
+}
+
+/***************************************************************************//**
+ * progress
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the fraction of the operation done, from 0 to 1
+ ******************************************************************************/
+double Job::progress() const
+{
+    double done = std::max(0, started - 1) + (double) stageDone() / STAGE_PARTS;
+
+    return std::min(1.0, done / stages);
+}
+
+/***************************************************************************//**
+ * beginLoop
+ * Author - Dan Andrus
+ *
+ * Starts a loop of total iterations within the current stage. Called by
+ * ThreadPool::parallelFor.
+ ******************************************************************************/
+void Job::beginLoop(int total)
+{
+    check();
+    loopStart = stageDone();
+    startLoop(total, (STAGE_PARTS - loopStart) / 2);
+}
+
+/***************************************************************************//**
+ * advance
+ * Author - Dan Andrus
+ *
+ * Records that done more iterations of the current loop have finished, then
+ * throws JobCancelled if the job has been cancelled. Safe to call from
+ * several threads at once.
+ ******************************************************************************/
+void Job::advance(int done)
+{
+    loopDone += done;
+    check();
+}
+
+/***************************************************************************//**
+ * current
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the job installed on the calling thread, or NULL
+ ******************************************************************************/
+Job* Job::current()
+{
+    return T_Current_Job;
+}
+
+/***************************************************************************//**
+ * report
+ * Author - Dan Andrus
+ *
+ * Progress of a loop run on the calling thread alone. Does nothing if no job
+ * is installed; otherwise throws JobCancelled if the job has been cancelled.
+ *
+ * Parameters -
+ *          done - iterations finished so far
+ *          total - iterations in the loop
+ ******************************************************************************/
+void Job::report(int done, int total)
+{
+    Job* job = T_Current_Job;
+
+    if (job == NULL)
+        return;
+
+    if (done == 1 || job->loopTotal != total)
+    {
+        job->loopStart = job->stageDone();
+        job->startLoop(total, STAGE_PARTS - job->loopStart);
+    }
+    job->loopDone = done;
+    job->check();
+}
+
+void Job::startLoop(int total, int share)
+{
+    loopDone = 0;
+    loopTotal = total;
+    loopShare = share;
+}
+
+/***************************************************************************//**
+ * stageDone
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the parts of the current stage done, out of STAGE_PARTS
+ ******************************************************************************/
+int Job::stageDone() const
+{
+    int total = loopTotal;
+    double fraction = (total > 0) ? std::min(1.0, (double) loopDone / total) : 0.0;
+
+    return loopStart + (int) (loopShare * fraction);
+}
+
+Job::Scope::Scope(Job& job)
+    : previous(T_Current_Job)
+{
+    T_Current_Job = &job;
+}
+
+Job::Scope::~Scope()
+{
+    T_Current_Job = previous;
+}
@@ -0,0 +1,96 @@
+/***************************************************************************//**
+ * Job.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 20, 2015
+ *
+ * Details - Contains the Job class, which lets a long operation running on
+ *           one thread report its progress to another and be cancelled from
+ *           it.
+ ******************************************************************************/
+#pragma once
+#include <atomic>
+#include <exception>
+
+/***************************************************************************//**
+ * JobCancelled
+ *
+ * Author - Dan Andrus
+ *
+ * Thrown out of an operation when its job has been cancelled.
+ ******************************************************************************/
+class JobCancelled : public std::exception
+{
+  public:
+    const char* what() const throw() { return "job cancelled"; }
+};
+
+/***************************************************************************//**
+ * Job
+ *
+ * Author - Dan Andrus
+ *
+ * Progress and cancellation of one operation. The thread doing the work
+ * installs the job with a Job::Scope; from then on every ThreadPool loop it
+ * starts counts finished chunks towards the progress and throws JobCancelled
+ * from the next chunk once the job is cancelled, so transforms and filters
+ * need no changes of their own. Loops that do not go through the pool call
+ * Job::report() instead.
+ *
+ * An operation is split into a fixed number of stages of equal weight, each
+ * started with stage(). Since the number of loops in a stage is not known
+ * ahead of time, each loop is given half of what is left of its stage, so
+ * progress never goes backwards; a loop reported through report() is given
+ * all of it. Any thread may read progress() and label() or call cancel().
+ ******************************************************************************/
+class Job
+{
+  public:
+    explicit Job(int stages = 1);
+
+    void cancel() { stopped = true; }
+    bool cancelled() const { return stopped; }
+    void check() const;
+
+    void stage(const char* label);
+    const char* label() const { return name; }
+    double progress() const;
+
+    void beginLoop(int total);
+    void advance(int done);
+
+    static Job* current();
+    static void report(int done, int total);
+
+    /***********************************************************************//**
+     * Scope
+     *
+     * Makes a job the current job of the calling thread until destroyed.
+     **************************************************************************/
+    class Scope
+    {
+      public:
+        explicit Scope(Job& job);
+        ~Scope();
+
+      private:
+        Job* previous;
+    };
+
+  private:
+    std::atomic<bool> stopped;
+    std::atomic<const char*> name;
+    std::atomic<int> stages;
+    std::atomic<int> started;
+    std::atomic<int> loopDone;
+    std::atomic<int> loopTotal;
+    std::atomic<int> loopStart;     // parts of the stage done before the loop
+    std::atomic<int> loopShare;     // parts of the stage given to the loop
+
+    void startLoop(int total, int share);
+    int stageDone() const;
+
+    Job(const Job&);
+    Job& operator=(const Job&);
+};
@@ -0,0 +1,229 @@
+/***************************************************************************//**
+ * MappedFile.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 22, 2015
+ *
+ * Details - Defines the MappedFile class.
+ ******************************************************************************/
+#include "MappedFile.h"
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***************************************************************************//**
+ * systemError
+ * Author - Dan Andrus
+ *
+ * Returns a description of the last failed system call on a file.
+ ******************************************************************************/
+static std::string systemError(const char* what, const std::string& path)
+{
+    std::ostringstream out;
+
+#ifdef _WIN32
+    out << what << " " << path << " failed (error " << GetLastError() << ")";
+#else
+    out << what << " " << path << ": " << strerror(errno);
+#endif
+    return out.str();
+}
+
+MappedFile::~MappedFile()
+{
+    if (base == NULL)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+#else
+    munmap(base, length);
+#endif
+}
+
+/***************************************************************************//**
+ * open
+ * Author - Dan Andrus
+ *
+ * Maps an existing file.
+ *
+ * Parameters -
+ *          path - the file to map
+ *          access - READ_ONLY, or COPY_ON_WRITE to be allowed to change the
+ *                   data in memory without changing the file
+ *          error - set to a description of the problem on failure
+ *
+ * Returns
+ *          the mapping, or NULL if the file could not be mapped
+ ******************************************************************************/
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path, Access access,
+                                             std::string& error)
+{
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    file->path = path;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        error = systemError("Opening", path);
+        return std::shared_ptr<MappedFile>();
+    }
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0)
+    {
+        error = "Cannot map empty file " + path;
+        CloseHandle(handle);
+        return std::shared_ptr<MappedFile>();
+    }
+
+    // The view keeps the file and the mapping object open by itself
+    HANDLE mapping = CreateFileMappingA(handle, NULL,
+        (access == COPY_ON_WRITE) ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL)
+    {
+        file->base = (char*) MapViewOfFile(mapping,
+            (access == COPY_ON_WRITE) ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    CloseHandle(handle);
+    file->length = (size_t) size.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+
+    if (fd < 0)
+    {
+        error = systemError("Opening", path);
+        return std::shared_ptr<MappedFile>();
+    }
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        error = "Cannot map empty file " + path;
+        close(fd);
+        return std::shared_ptr<MappedFile>();
+    }
+
+    // The mapping keeps the file open by itself
+    file->length = (size_t) info.st_size;
+    void* base = mmap(NULL, file->length,
+                      (access == COPY_ON_WRITE) ? PROT_READ | PROT_WRITE : PROT_READ,
+                      MAP_PRIVATE, fd, 0);
+    close(fd);
+    file->base = (base == MAP_FAILED) ? NULL : (char*) base;
+#endif
+
+    if (file->base == NULL)
+    {
+        error = systemError("Mapping", path);
+        return std::shared_ptr<MappedFile>();
+    }
+    return file;
+}
+
+/***************************************************************************//**
+ * create
+ * Author - Dan Andrus
+ *
+ * Creates a file of the given size, replacing any file already there, and
+ * maps it for writing. The contents start out as zeros.
+ *
+ * Parameters -
+ *          path - the file to create
+ *          size - the size of the file in bytes
+ *          error - set to a description of the problem on failure
+ *
+ * Returns
+ *          the mapping, or NULL if the file could not be created
+ ******************************************************************************/
+std::shared_ptr<MappedFile> MappedFile::create(const std::string& path, size_t size,
+                                               std::string& error)
+{
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    file->path = path;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        error = systemError("Creating", path);
+        return std::shared_ptr<MappedFile>();
+    }
+
+    // Making a mapping larger than the file extends the file
+    unsigned long long bytes = size;
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READWRITE,
+                                        (DWORD) (bytes >> 32), (DWORD) bytes, NULL);
+    if (mapping != NULL)
+    {
+        file->base = (char*) MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    CloseHandle(handle);
+#else
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+    {
+        error = systemError("Creating", path);
+        return std::shared_ptr<MappedFile>();
+    }
+    if (ftruncate(fd, (off_t) size) != 0)
+    {
+        error = systemError("Resizing", path);
+        close(fd);
+        return std::shared_ptr<MappedFile>();
+    }
+
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    file->base = (base == MAP_FAILED) ? NULL : (char*) base;
+#endif
+
+    if (file->base == NULL)
+    {
+        error = systemError("Mapping", path);
+        return std::shared_ptr<MappedFile>();
+    }
+    file->length = size;
+    return file;
+}
+
+/***************************************************************************//**
+ * sync
+ * Author - Dan Andrus
+ *
+ * Writes any changes made through a created mapping out to the file and
+ * waits for them to finish.
+ *
+ * Returns
+ *          true if successful, false with error set if not
+ ******************************************************************************/
+bool MappedFile::sync(std::string& error)
+{
+#ifdef _WIN32
+    if (!FlushViewOfFile(base, 0))
+#else
+    if (msync(base, length, MS_SYNC) != 0)
+#endif
+    {
+        error = systemError("Writing", path);
+        return false;
+    }
+    return true;
+}
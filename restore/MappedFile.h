@@ -0,0 +1,55 @@
+/***************************************************************************//**
+ * MappedFile.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 22, 2015
+ *
+ * Details - Contains the MappedFile class, a file mapped into memory with
+ *           mmap on POSIX systems and a file mapping object on Windows.
+ ******************************************************************************/
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/***************************************************************************//**
+ * MappedFile
+ *
+ * Author - Dan Andrus
+ *
+ * The whole of a file mapped into the address space. Nothing is read until
+ * it is touched, and the system pages the data in and out as needed, so a
+ * file larger than memory can still be mapped and worked on.
+ *
+ * A file opened COPY_ON_WRITE can be changed in memory without the changes
+ * reaching the file: each page changed is copied first. A file made by
+ * create() is mapped shared, so what is written to it ends up in the file.
+ * The mapping is removed when the object is destroyed.
+ ******************************************************************************/
+class MappedFile
+{
+  public:
+    enum Access { READ_ONLY, COPY_ON_WRITE };
+
+    ~MappedFile();
+
+    static std::shared_ptr<MappedFile> open(const std::string& path, Access access,
+                                            std::string& error);
+    static std::shared_ptr<MappedFile> create(const std::string& path, size_t size,
+                                              std::string& error);
+
+    char* data() const { return base; }
+    size_t size() const { return length; }
+    bool sync(std::string& error);
+
+  private:
+    MappedFile() : base(NULL), length(0) {}
+
+    std::string path;
+    char* base;
+    size_t length;
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
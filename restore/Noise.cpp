@@ -0,0 +1,293 @@
+/***************************************************************************//**
+ * Noise.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 24, 2015
+ *
+ * Details - Defines the Philox4x32 generator and the Gaussian and periodic
+ *           noise generators.
+ ******************************************************************************/
+#define _USE_MATH_DEFINES
+#include "Noise.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+// Philox4x32-10 multipliers and Weyl sequence constants
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+static const int PHILOX_ROUNDS = 10;
+
+// Philox blocks generated at a time by gaussianSamples, four samples each
+static const int NOISE_BATCH = 64;
+
+/***************************************************************************//**
+ * Philox4x32::block
+ * Author - Dan Andrus
+ *
+ * Generates the four words of a single block.
+ ******************************************************************************/
+void Philox4x32::block(uint64_t key, uint64_t counter, uint32_t out[4])
+{
+    blocks(key, counter, 1, out, out + 1, out + 2, out + 3);
+}
+
+/***************************************************************************//**
+ * Philox4x32::blocks
+ * Author - Dan Andrus
+ *
+ * Generates count consecutive blocks, starting at the given counter. Word j
+ * of block i is stored in xj[i]. The rounds run over all blocks at once on
+ * separate arrays so that the compiler can vectorize the multiplications.
+ *
+ * Parameters -
+ *          key - The key, usually the seed
+ *          counter - The counter of the first block
+ *          count - The number of blocks
+ *          x0, x1, x2, x3 - Receive the words of each block
+ ******************************************************************************/
+void Philox4x32::blocks(uint64_t key, uint64_t counter, int count,
+                        uint32_t* x0, uint32_t* x1, uint32_t* x2, uint32_t* x3)
+{
+    for (int i = 0; i < count; i++)
+    {
+        uint64_t c = counter + i;
+        x0[i] = (uint32_t) c;
+        x1[i] = (uint32_t) (c >> 32);
+        x2[i] = 0;
+        x3[i] = 0;
+    }
+
+    uint32_t k0 = (uint32_t) key;
+    uint32_t k1 = (uint32_t) (key >> 32);
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            uint64_t p0 = (uint64_t) PHILOX_M0 * x0[i];
+            uint64_t p1 = (uint64_t) PHILOX_M1 * x2[i];
+            uint32_t y0 = (uint32_t) (p1 >> 32) ^ x1[i] ^ k0;
+            uint32_t y2 = (uint32_t) (p0 >> 32) ^ x3[i] ^ k1;
+
+            x1[i] = (uint32_t) p1;
+            x3[i] = (uint32_t) p0;
+            x0[i] = y0;
+            x2[i] = y2;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+/***************************************************************************//**
+ * boxMuller
+ * Author - Dan Andrus
+ *
+ * Turns a pair of uniform values into a pair of independent standard normal
+ * values, scaled by stddev: with r = sqrt(-2 ln u) and t = 2 pi a,
+ * z0 = r cos t and z1 = r sin t. Instead of reducing t, sin and cos are
+ * evaluated at pi a, which lies in [-pi/2, pi/2) where short Taylor series
+ * are accurate to float precision, and doubled with the double angle
+ * formulas.
+ *
+ * Parameters -
+ *          u - Uniform in (0, 1]
+ *          a - Uniform in [-1/2, 1/2)
+ *          stddev - The standard deviation of the results
+ *          z0, z1 - Receive the results
+ ******************************************************************************/
+template <typename V>
+static inline void boxMuller(V u, V a, V stddev, V& z0, V& z1)
+{
+    V r = vsqrt(V(-2.0f) * vlog(u)) * stddev;
+    V x = a * V(3.14159265f);
+    V x2 = x * x;
+
+    V s = V(-2.5052108e-8f);
+    s = s * x2 + V(2.7557319e-6f);
+    s = s * x2 + V(-1.9841270e-4f);
+    s = s * x2 + V(8.3333333e-3f);
+    s = s * x2 + V(-1.6666667e-1f);
+    s = s * x2 * x + x;
+
+    V c = V(2.0876757e-9f);
+    c = c * x2 + V(-2.7557319e-7f);
+    c = c * x2 + V(2.4801587e-5f);
+    c = c * x2 + V(-1.3888889e-3f);
+    c = c * x2 + V(4.1666667e-2f);
+    c = c * x2 + V(-0.5f);
+    c = c * x2 + V(1.0f);
+
+    z0 = r * (c * c - s * s);
+    z1 = r * (V(2.0f) * s * c);
+}
+
+/***************************************************************************//**
+ * gaussianSamples
+ * Author - Dan Andrus
+ *
+ * Writes samples first to first + n - 1 of the Gaussian noise stream of a
+ * seed. Block k of the Philox stream gives samples 4k to 4k + 3: words 0 and
+ * 1 give the first pair through boxMuller and words 2 and 3 the second. A
+ * sample therefore depends only on the seed and its index, never on how a
+ * caller splits the stream.
+ *
+ * The top 24 bits of each word are used, so the uniform values are exact in
+ * float. This bounds the samples to about 5.8 standard deviations, which a
+ * sample exceeds with probability 7e-9.
+ *
+ * Parameters -
+ *          seed - Selects the stream
+ *          first - The index of the first sample
+ *          n - The number of samples
+ *          stddev - The standard deviation of the samples
+ *          out - Receives the samples
+ ******************************************************************************/
+void gaussianSamples(uint64_t seed, uint64_t first, int n, float stddev, float* out)
+{
+    alignas(BUFFER2D_ALIGNMENT) uint32_t words[4][NOISE_BATCH];
+    alignas(BUFFER2D_ALIGNMENT) float uniform[4][NOISE_BATCH];
+    alignas(BUFFER2D_ALIGNMENT) float normal[4][NOISE_BATCH];
+    uint64_t counter = first / 4;
+    int skip = (int) (first % 4);
+
+    while (n > 0)
+    {
+        Philox4x32::blocks(seed, counter, NOISE_BATCH,
+                           words[0], words[1], words[2], words[3]);
+
+        for (int i = 0; i < NOISE_BATCH; i++)
+        {
+            uniform[0][i] = (float) ((words[0][i] >> 8) + 1) * (1.0f / 16777216.0f);
+            uniform[1][i] = (float) (words[1][i] >> 8) * (1.0f / 16777216.0f) - 0.5f;
+            uniform[2][i] = (float) ((words[2][i] >> 8) + 1) * (1.0f / 16777216.0f);
+            uniform[3][i] = (float) (words[3][i] >> 8) * (1.0f / 16777216.0f) - 0.5f;
+        }
+
+        for (int p = 0; p < 4; p += 2)
+        {
+            int i = 0;
+            for (; i + VFLOAT_WIDTH <= NOISE_BATCH; i += VFLOAT_WIDTH)
+            {
+                vfloat z0;
+                vfloat z1;
+                boxMuller(vload<vfloat>(uniform[p] + i), vload<vfloat>(uniform[p + 1] + i),
+                          vfloat(stddev), z0, z1);
+                vstore(normal[p] + i, z0);
+                vstore(normal[p + 1] + i, z1);
+            }
+            for (; i < NOISE_BATCH; i++)
+                boxMuller(uniform[p][i], uniform[p + 1][i], stddev,
+                          normal[p][i], normal[p + 1][i]);
+        }
+
+        // Interleave the four samples of each block back into stream order
+        int count = std::min(n, 4 * NOISE_BATCH - skip);
+        for (int i = 0; i < count; i++)
+        {
+            int index = skip + i;
+            out[i] = normal[index % 4][index / 4];
+        }
+
+        out += count;
+        n -= count;
+        counter += NOISE_BATCH;
+        skip = 0;
+    }
+}
+
+/***************************************************************************//**
+ * addGaussianNoise
+ * Author - Dan Andrus
+ *
+ * Adds zero-mean Gaussian noise to every pixel of an image. Pixel (r, c)
+ * receives sample r * cols + c of the seed's stream, so the same seed gives
+ * the same noise on an image of the same size whatever the number of
+ * threads. Rows are split across the global thread pool.
+ *
+ * Parameters -
+ *          image - The image to add noise to
+ *          stddev - The standard deviation of the noise
+ *          seed - Selects the noise
+ ******************************************************************************/
+void addGaussianNoise(Buffer2D<float>& image, double stddev, uint64_t seed)
+{
+    int cols = image.cols();
+
+    ThreadPool::global().parallelFor(image.rows(), [&](int begin, int end)
+    {
+        Buffer2D<float> noise(1, cols);
+        for (int r = begin; r < end; r++)
+        {
+            float* row = image[r];
+            float* z = noise[0];
+            int c = 0;
+
+            gaussianSamples(seed, (uint64_t) r * cols, cols, (float) stddev, z);
+            for (; c + VFLOAT_WIDTH <= cols; c += VFLOAT_WIDTH)
+                vstore(row + c, vload<vfloat>(row + c) + vload<vfloat>(z + c));
+            for (; c < cols; c++)
+                row[c] += z[c];
+        }
+    });
+}
+
+/***************************************************************************//**
+ * addPeriodicNoise
+ * Author - Dan Andrus
+ *
+ * Adds the sinusoid
+ *
+ *      amplitude * cos(2 pi (fy * r / rows + fx * c / cols) + phase)
+ *
+ * to an image. Its spectrum is a pair of spikes drawn at offsets (fy, fx)
+ * and (-fy, -fx) from the center of the displayed spectrum, which the notch
+ * stage of a pipeline and the spot reject tool remove. The cosine is split
+ * into a row part and a column part, so each pixel costs two multiplications.
+ *
+ * Parameters -
+ *          image - The image to add the interference to
+ *          fy, fx - The frequency, in cycles per image height and width
+ *          amplitude - The amplitude, in gray levels
+ *          phase - The phase at the top left pixel, in radians
+ ******************************************************************************/
+void addPeriodicNoise(Buffer2D<float>& image, double fy, double fx,
+                      double amplitude, double phase)
+{
+    int rows = image.rows();
+    int cols = image.cols();
+    Buffer2D<float> wave(2, cols);
+
+    for (int c = 0; c < cols; c++)
+    {
+        double angle = 2 * M_PI * fx * c / cols;
+        wave[0][c] = (float) (amplitude * cos(angle));
+        wave[1][c] = (float) (amplitude * sin(angle));
+    }
+
+    ThreadPool::global().parallelFor(rows, [&](int begin, int end)
+    {
+        const float* cosx = wave[0];
+        const float* sinx = wave[1];
+
+        for (int r = begin; r < end; r++)
+        {
+            double angle = 2 * M_PI * fy * r / rows + phase;
+            float cosy = (float) cos(angle);
+            float siny = (float) sin(angle);
+            float* row = image[r];
+            int c = 0;
+
+            for (; c + VFLOAT_WIDTH <= cols; c += VFLOAT_WIDTH)
+                vstore(row + c, vload<vfloat>(row + c) + vfloat(cosy) * vload<vfloat>(cosx + c)
+                                - vfloat(siny) * vload<vfloat>(sinx + c));
+            for (; c < cols; c++)
+                row[c] += cosy * cosx[c] - siny * sinx[c];
+        }
+    });
+}
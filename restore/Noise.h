@@ -0,0 +1,39 @@
+/***************************************************************************//**
+ * Noise.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 24, 2015
+ *
+ * Details - Contains a counter-based random number generator, the Gaussian
+ *           noise generator built on it and a generator of periodic
+ *           interference.
+ ******************************************************************************/
+#pragma once
+#include <stdint.h>
+#include "Buffer2D.h"
+
+/***************************************************************************//**
+ * Philox4x32
+ *
+ * Author - Dan Andrus
+ *
+ * The Philox4x32-10 generator of Salmon et al., "Parallel Random Numbers: As
+ * Easy as 1, 2, 3". Rather than stepping a state, it maps a 64-bit key and a
+ * 64-bit counter to four random 32-bit words through ten rounds of
+ * multiplications. Any block can be had directly from its counter, so every
+ * thread can generate its own part of a stream without sharing any state and
+ * the stream comes out the same however the work is split.
+ ******************************************************************************/
+class Philox4x32
+{
+  public:
+    static void block(uint64_t key, uint64_t counter, uint32_t out[4]);
+    static void blocks(uint64_t key, uint64_t counter, int count,
+                       uint32_t* x0, uint32_t* x1, uint32_t* x2, uint32_t* x3);
+};
+
+void gaussianSamples(uint64_t seed, uint64_t first, int n, float stddev, float* out);
+void addGaussianNoise(Buffer2D<float>& image, double stddev, uint64_t seed);
+void addPeriodicNoise(Buffer2D<float>& image, double fy, double fx,
+                      double amplitude, double phase = 0);
@@ -0,0 +1,277 @@
+/***************************************************************************//**
+ * PeakDetector.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 26, 2015
+ *
+ * Details - Defines the PeakDetector class.
+ ******************************************************************************/
+#include "PeakDetector.h"
+#include "FrequencyGeometry.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+// Frequencies either side of an axis frequency whose median is its background
+static const int AXIS_WINDOW = 8;
+
+// Least ratio of a peak's power to that of any frequency two pixels from it
+static const float PEAK_ISOLATION = 4;
+
+/***************************************************************************//**
+ * median
+ * Author - Dan Andrus
+ *
+ * Returns the median of n values, reordering them.
+ ******************************************************************************/
+static float median(float* values, int n)
+{
+    std::nth_element(values, values + n / 2, values + n);
+    return values[n / 2];
+}
+
+/***************************************************************************//**
+ * axisMedians
+ * Author - Dan Andrus
+ *
+ * Replaces each of n powers along an axis with the median of the powers
+ * within AXIS_WINDOW of it.
+ ******************************************************************************/
+static std::vector<float> axisMedians(const std::vector<float>& power)
+{
+    int n = (int) power.size();
+    std::vector<float> medians(n);
+    std::vector<float> window;
+
+    for (int i = 0; i < n; i++)
+    {
+        int begin = std::max(0, i - AXIS_WINDOW);
+        int end = std::min(n, i + AXIS_WINDOW + 1);
+        window.assign(power.begin() + begin, power.begin() + end);
+        medians[i] = median(&window[0], end - begin);
+    }
+    return medians;
+}
+
+/***************************************************************************//**
+ * refine
+ * Author - Dan Andrus
+ *
+ * Returns the offset, between -1/2 and 1/2, of the vertex of the parabola
+ * through the log powers of a peak and its two neighbours along one axis.
+ ******************************************************************************/
+static double refine(float before, float peak, float after)
+{
+    double l = log(std::max(before, FLT_MIN));
+    double c = log(std::max(peak, FLT_MIN));
+    double r = log(std::max(after, FLT_MIN));
+    double curvature = l - 2 * c + r;
+
+    if (curvature >= 0)
+        return 0;
+    return std::min(0.5, std::max(-0.5, 0.5 * (l - r) / curvature));
+}
+
+/***************************************************************************//**
+ * PeakDetector::detect
+ * Author - Dan Andrus
+ *
+ * Finds the peaks of a half spectrum, as described for the class. The
+ * spectrum is only read. Powers are computed and peaks looked for with the
+ * rows split across the global thread pool.
+ *
+ * Parameters -
+ *          real - The real parts of the half spectrum
+ *          imag - The imaginary parts of the half spectrum
+ *          cols - The number of columns of the full spectrum
+ *
+ * Returns
+ *          the peaks found, strongest first
+ ******************************************************************************/
+std::vector<SpectrumPeak> PeakDetector::detect(const Buffer2D<float>& real,
+                                               const Buffer2D<float>& imag,
+                                               int cols) const
+{
+    const FrequencyGeometry& geom = FrequencyGeometry::get(real.rows(), cols);
+    int rows = geom.rows;
+    int halfCols = geom.halfCols;
+    int rings = (int) sqrt((double) geom.origin_y * geom.origin_y
+                           + (double) geom.origin_x * geom.origin_x) + 2;
+    Buffer2D<float> power(rows, halfCols);
+    std::vector<SpectrumPeak> peaks;
+    std::mutex found;
+
+    ThreadPool::global().parallelFor(rows, [&](int begin, int end)
+    {
+        for (int u = begin; u < end; u++)
+        {
+            for (int v = 0; v < halfCols; v++)
+                power[u][v] = real[u][v] * real[u][v] + imag[u][v] * imag[u][v];
+        }
+    });
+
+    // Sort the powers off the axes by ring, then take each ring's median
+    std::vector<int> ring(rows * halfCols);
+    std::vector<int> start(rings + 1, 0);
+    std::vector<float> sorted((rows - 1) * (halfCols - 1));
+    std::vector<float> background(rings, 0.0f);
+
+    for (int u = 1; u < rows; u++)
+    {
+        for (int v = 1; v < halfCols; v++)
+        {
+            int d = (int) (sqrt(geom.freqRowDist2[u] + geom.freqColDist2[v]) + 0.5f);
+            ring[u * halfCols + v] = d;
+            start[d + 1]++;
+        }
+    }
+    for (int d = 0; d < rings; d++)
+        start[d + 1] += start[d];
+
+    std::vector<int> next(start.begin(), start.end() - 1);
+    for (int u = 1; u < rows; u++)
+    {
+        for (int v = 1; v < halfCols; v++)
+            sorted[next[ring[u * halfCols + v]]++] = power[u][v];
+    }
+
+    ThreadPool::global().parallelFor(rings, [&](int begin, int end)
+    {
+        for (int d = begin; d < end; d++)
+        {
+            if (start[d + 1] > start[d])
+                background[d] = median(&sorted[start[d]], start[d + 1] - start[d]);
+        }
+    });
+
+    // The vertical axis in display order, and the horizontal axis
+    std::vector<float> axis(rows);
+    for (int y = 0; y < rows; y++)
+        axis[y] = power[geom.spectrumRow[y]][0];
+    std::vector<float> columnMedians = axisMedians(axis);
+    std::vector<float> rowMedians = axisMedians(std::vector<float>(power[0], power[0] + halfCols));
+
+    // Power of the bin drawn at offset (du, dv) from bin (u, v)
+    auto at = [&](int u, int v, int du, int dv) -> float
+    {
+        u = (u + du + rows) % rows;
+        v += dv;
+        if (v < 0 || v >= halfCols)
+        {
+            u = (rows - u) % rows;
+            v = (cols - v) % cols;
+        }
+        return power[u][v];
+    };
+
+    float limit = (float) (threshold * threshold);
+    float minRadius2 = (float) (minRadius * minRadius);
+
+    ThreadPool::global().parallelFor(rows, [&](int begin, int end)
+    {
+        std::vector<SpectrumPeak> local;
+
+        for (int u = begin; u < end; u++)
+        {
+            float fy = geom.freqRow[u];
+            bool mirrored = (fy < 0 && (rows - u) % rows != u);
+
+            for (int v = 0; v < halfCols; v++)
+            {
+                float fx = geom.freqCol[v];
+                float p = power[u][v];
+                float level;
+
+                if (geom.freqRowDist2[u] + geom.freqColDist2[v] < minRadius2)
+                    continue;
+
+                // Columns 0 and cols / 2 hold both a peak and its mirror
+                if (mirrored && (v == 0 || fx < 0))
+                    continue;
+
+                if (v == 0)
+                    level = columnMedians[geom.displayRow[u]];
+                else if (u == 0)
+                    level = rowMedians[v];
+                else
+                    level = background[ring[u * halfCols + v]];
+
+                if (p == 0 || p < limit * level)
+                    continue;
+
+                bool highest = true;
+                for (int du = -1; du <= 1 && highest; du++)
+                {
+                    for (int dv = -1; dv <= 1 && highest; dv++)
+                        highest = (du == 0 && dv == 0) || at(u, v, du, dv) <= p;
+                }
+                if (!highest)
+                    continue;
+
+                // A spike stands alone; the ridge of a long edge does not.
+                // The ridges along the axes are left to the axis medians
+                float ridge = 0;
+                for (int du = -2; du <= 2 && u != 0 && v != 0; du++)
+                {
+                    for (int dv = -2; dv <= 2; dv += (du == -2 || du == 2) ? 1 : 4)
+                        ridge = std::max(ridge, at(u, v, du, dv));
+                }
+                if (ridge * PEAK_ISOLATION > p)
+                    continue;
+
+                SpectrumPeak peak;
+                peak.fy = fy + refine(at(u, v, -1, 0), p, at(u, v, 1, 0));
+                peak.fx = fx + refine(at(u, v, 0, -1), p, at(u, v, 0, 1));
+                peak.magnitude = sqrt((double) p);
+                peak.ratio = (level > 0) ? sqrt((double) p / level)
+                                         : std::numeric_limits<double>::infinity();
+                if (peak.fx < 0)
+                {
+                    peak.fy = -peak.fy;
+                    peak.fx = -peak.fx;
+                }
+                local.push_back(peak);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(found);
+        peaks.insert(peaks.end(), local.begin(), local.end());
+    });
+
+    // Strongest first, and in the same order however the rows were split
+    std::sort(peaks.begin(), peaks.end(), [](const SpectrumPeak& a, const SpectrumPeak& b)
+    {
+        if (a.ratio != b.ratio)
+            return a.ratio > b.ratio;
+        if (a.magnitude != b.magnitude)
+            return a.magnitude > b.magnitude;
+        if (a.fy != b.fy)
+            return a.fy < b.fy;
+        return a.fx < b.fx;
+    });
+
+    if ((int) peaks.size() > maxPeaks)
+        peaks.resize(std::max(0, maxPeaks));
+    return peaks;
+}
+
+/***************************************************************************//**
+ * PeakDetector::notches
+ * Author - Dan Andrus
+ *
+ * Returns a notch bank removing every peak and its mirror with a Gaussian
+ * notch of the given radius.
+ ******************************************************************************/
+GaussianNotchBank PeakDetector::notches(const std::vector<SpectrumPeak>& peaks,
+                                        double radius)
+{
+    GaussianNotchBank bank;
+
+    for (size_t i = 0; i < peaks.size(); i++)
+        bank.add(peaks[i].fy, peaks[i].fx, radius);
+    return bank;
+}
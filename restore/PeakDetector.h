@@ -0,0 +1,94 @@
+/***************************************************************************//**
+ * PeakDetector.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 26, 2015
+ *
+ * Details - Contains the PeakDetector class, which finds the spikes that
+ *           periodic noise leaves in a spectrum so that they can be notched
+ *           out without clicking on each one.
+ ******************************************************************************/
+#pragma once
+#include <vector>
+#include "Buffer2D.h"
+#include "Transfer.h"
+
+// Default ratio of a peak's magnitude to the median magnitude at its distance
+static const double DEFAULT_PEAK_THRESHOLD = 8;
+
+// Default distance from the center within which no peaks are looked for
+static const double DEFAULT_PEAK_MIN_RADIUS = 8;
+
+// Default radius of the notches that remove the peaks found
+static const double DEFAULT_PEAK_NOTCH_RADIUS = 3;
+
+// Default number of peaks kept
+static const int DEFAULT_MAX_PEAKS = 32;
+
+/***************************************************************************//**
+ * SpectrumPeak
+ *
+ * Author - Dan Andrus
+ *
+ * One spike and, implicitly, its mirror at (-fy, -fx). The frequency is an
+ * offset from the center of the displayed spectrum, refined to a fraction of
+ * a pixel, with fx >= 0. ratio is the magnitude of the spike over the median
+ * magnitude at its distance from the center.
+ ******************************************************************************/
+struct SpectrumPeak
+{
+    double fy;
+    double fx;
+    double magnitude;
+    double ratio;
+};
+
+/***************************************************************************//**
+ * PeakDetector
+ *
+ * Author - Dan Andrus
+ *
+ * Finds the peaks of a half spectrum that stand out from the rest of the
+ * frequencies at the same distance from the center. The median power of
+ * every ring of frequencies one pixel wide is taken as the background, which
+ * follows the fall-off of the image's own spectrum but which a few spikes
+ * cannot pull up. A frequency is a peak if its magnitude is at least
+ * threshold times the median of its ring, at least that of its eight
+ * neighbours and PEAK_ISOLATION times the power of any frequency two pixels
+ * away. The last test rejects the maxima along the ridge that a long
+ * straight edge puts across the spectrum, which a spike, even one between
+ * two frequencies, does not have. It is not applied on the axes.
+ *
+ * The row and column through the center are compared with a median of
+ * their own instead, taken over the frequencies of the same axis within
+ * AXIS_WINDOW pixels. The edges of an image that does not wrap around put a
+ * ridge of power along the axes which the ring medians would mistake for
+ * peaks, while the stripes of scanner lines, exactly horizontal or
+ * vertical, put their spikes on the axes.
+ *
+ * Each peak's position is refined by fitting a parabola to its log power and
+ * that of its neighbours, along each axis. Peaks are returned strongest
+ * first, one per mirrored pair, at most maxPeaks of them.
+ ******************************************************************************/
+class PeakDetector
+{
+  public:
+    PeakDetector() : threshold(DEFAULT_PEAK_THRESHOLD),
+                     minRadius(DEFAULT_PEAK_MIN_RADIUS), maxPeaks(DEFAULT_MAX_PEAKS) {}
+
+    void setThreshold(double ratio) { threshold = ratio; }
+    void setMinRadius(double radius) { minRadius = radius; }
+    void setMaxPeaks(int count) { maxPeaks = count; }
+
+    std::vector<SpectrumPeak> detect(const Buffer2D<float>& real,
+                                     const Buffer2D<float>& imag, int cols) const;
+
+    static GaussianNotchBank notches(const std::vector<SpectrumPeak>& peaks,
+                                     double radius);
+
+  private:
+    double threshold;
+    double minRadius;
+    int maxPeaks;
+};
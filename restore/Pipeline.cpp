@@ -0,0 +1,720 @@
+/***************************************************************************//**
+ * Pipeline.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 16, 2015
+ *
+ * Details - Defines the Pipeline class: parsing of pipeline specifications
+ *           and running them on a frame.
+ ******************************************************************************/
+#include "Pipeline.h"
+#include "FFT.h"
+#include "GaussianSmoother.h"
+#include "Noise.h"
+#include "PeakDetector.h"
+#include "TiledFilter.h"
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+
+/***************************************************************************//**
+ * StageOptions
+ *
+ * Author - Dan Andrus
+ *
+ * The options given to one stage, split into plain words and key=value pairs.
+ * Keys are checked off as they are read so that misspelled or unsupported
+ * options can be reported instead of silently ignored.
+ ******************************************************************************/
+struct StageOptions
+{
+    std::string name;
+    std::set<std::string> words;
+    std::map<std::string, double> values;
+    std::string error;
+
+    bool parse(const std::string& text);
+    bool word(const char* w) { return words.erase(w) > 0; }
+    bool require(const char* key, double& value);
+    void optional(const char* key, double& value);
+    bool finish();
+};
+
+/***************************************************************************//**
+ * StageOptions::parse
+ * Author - Dan Andrus
+ *
+ * Splits one stage into its name and options.
+ ******************************************************************************/
+bool StageOptions::parse(const std::string& text)
+{
+    std::istringstream in(text);
+    std::string token;
+
+    if (!(in >> name))
+    {
+        error = "empty stage";
+        return false;
+    }
+
+    while (in >> token)
+    {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos)
+        {
+            words.insert(token);
+            continue;
+        }
+
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+        char* end = NULL;
+        double number = strtod(value.c_str(), &end);
+
+        if (key.empty() || value.empty() || *end != '\0')
+        {
+            error = "bad option '" + token + "' in stage '" + name + "'";
+            return false;
+        }
+        values[key] = number;
+    }
+    return true;
+}
+
+/***************************************************************************//**
+ * StageOptions::require
+ * Author - Dan Andrus
+ *
+ * Reads a key=value option that must be present.
+ ******************************************************************************/
+bool StageOptions::require(const char* key, double& value)
+{
+    std::map<std::string, double>::iterator it = values.find(key);
+
+    if (it == values.end())
+    {
+        if (error.empty())
+            error = "stage '" + name + "' needs " + key + "=";
+        return false;
+    }
+    value = it->second;
+    values.erase(it);
+    return true;
+}
+
+/***************************************************************************//**
+ * StageOptions::optional
+ * Author - Dan Andrus
+ *
+ * Reads a key=value option, leaving value unchanged if it is not present.
+ ******************************************************************************/
+void StageOptions::optional(const char* key, double& value)
+{
+    std::map<std::string, double>::iterator it = values.find(key);
+
+    if (it != values.end())
+    {
+        value = it->second;
+        values.erase(it);
+    }
+}
+
+/***************************************************************************//**
+ * StageOptions::finish
+ * Author - Dan Andrus
+ *
+ * Checks that every option given was used.
+ ******************************************************************************/
+bool StageOptions::finish()
+{
+    if (!error.empty())
+        return false;
+
+    if (!words.empty())
+        error = "unknown option '" + *words.begin() + "' in stage '" + name + "'";
+    else if (!values.empty())
+        error = "unknown option '" + values.begin()->first + "' in stage '" + name + "'";
+
+    return error.empty();
+}
+
+/***************************************************************************//**
+ * trim
+ * Author - Dan Andrus
+ *
+ * Returns a string without its leading and trailing whitespace.
+ ******************************************************************************/
+static std::string trim(const std::string& s)
+{
+    size_t first = s.find_first_not_of(" \t\r\n");
+    size_t last = s.find_last_not_of(" \t\r\n");
+
+    if (first == std::string::npos)
+        return std::string();
+    return s.substr(first, last - first + 1);
+}
+
+/***************************************************************************//**
+ * expandValue
+ * Author - Dan Andrus
+ *
+ * Splits the value of an option into the values it lists. Values are
+ * separated by commas, and A..B stands for every whole number from A to B.
+ *
+ * Returns
+ *          false with error set if a range is not valid
+ ******************************************************************************/
+static bool expandValue(const std::string& value, std::vector<std::string>& values,
+                        std::string& error)
+{
+    size_t begin = 0;
+
+    while (begin <= value.size())
+    {
+        size_t comma = value.find(',', begin);
+        if (comma == std::string::npos)
+            comma = value.size();
+
+        std::string item = value.substr(begin, comma - begin);
+        size_t dots = item.find("..");
+        begin = comma + 1;
+
+        if (dots == std::string::npos)
+        {
+            values.push_back(item);
+            continue;
+        }
+
+        std::string from = item.substr(0, dots);
+        std::string to = item.substr(dots + 2);
+        char* end_from = NULL;
+        char* end_to = NULL;
+        long first = strtol(from.c_str(), &end_from, 10);
+        long last = strtol(to.c_str(), &end_to, 10);
+
+        if (from.empty() || to.empty() || *end_from != '\0' || *end_to != '\0'
+            || first > last || (size_t) (last - first) >= MAX_PIPELINE_VARIANTS)
+        {
+            error = "bad range '" + item + "'";
+            return false;
+        }
+        for (long n = first; n <= last; n++)
+        {
+            std::ostringstream text;
+            text << n;
+            values.push_back(text.str());
+        }
+    }
+    return true;
+}
+
+/***************************************************************************//**
+ * Pipeline::expand
+ * Author - Dan Andrus
+ *
+ * Expands a specification whose options may list several values, as in
+ *
+ *      fft | blur r=2,4 | ifft | noise sd=5 seed=1..3
+ *
+ * into one specification for each combination of the values, six here. The
+ * first option listing several values changes slowest. A specification
+ * without lists gives itself, with its stages normalized as describe() would
+ * show them.
+ *
+ * Parameters -
+ *          spec - the stages, separated by '|'
+ *          specs - receives the specifications
+ *          error - set to a description of the problem if expanding fails
+ *
+ * Returns
+ *          true if successful, false if a range is invalid or there are
+ *          more than MAX_PIPELINE_VARIANTS combinations
+ ******************************************************************************/
+bool Pipeline::expand(const std::string& spec, std::vector<std::string>& specs,
+                      std::string& error)
+{
+    // Every token of the specification with the values it stands for; '|'
+    // separators are kept as tokens of their own
+    std::vector<std::vector<std::string> > tokens;
+    size_t begin = 0;
+    size_t count = 1;
+
+    specs.clear();
+    error.clear();
+
+    while (begin <= spec.size())
+    {
+        size_t bar = spec.find('|', begin);
+        if (bar == std::string::npos)
+            bar = spec.size();
+
+        std::istringstream in(spec.substr(begin, bar - begin));
+        std::string token;
+        begin = bar + 1;
+
+        if (!tokens.empty())
+            tokens.push_back(std::vector<std::string>(1, "|"));
+
+        while (in >> token)
+        {
+            std::vector<std::string> values;
+            size_t eq = token.find('=');
+
+            if (eq == std::string::npos)
+                values.push_back(token);
+            else
+            {
+                std::vector<std::string> listed;
+                if (!expandValue(token.substr(eq + 1), listed, error))
+                    return false;
+                for (size_t i = 0; i < listed.size(); i++)
+                    values.push_back(token.substr(0, eq + 1) + listed[i]);
+            }
+
+            count *= values.size();
+            if (count > MAX_PIPELINE_VARIANTS)
+            {
+                error = "too many combinations of options";
+                return false;
+            }
+            tokens.push_back(values);
+        }
+    }
+
+    // Count through the combinations like an odometer, last token fastest
+    std::vector<size_t> index(tokens.size(), 0);
+    for (size_t n = 0; n < count; n++)
+    {
+        std::string text;
+        for (size_t t = 0; t < tokens.size(); t++)
+        {
+            if (!text.empty())
+                text += " ";
+            text += tokens[t][index[t]];
+        }
+        specs.push_back(text);
+
+        for (size_t t = tokens.size(); t-- > 0; )
+        {
+            if (++index[t] < tokens[t].size())
+                break;
+            index[t] = 0;
+        }
+    }
+    return true;
+}
+
+/***************************************************************************//**
+ * Pipeline::parse
+ * Author - Dan Andrus
+ *
+ * Replaces the stages of the pipeline with the ones given by a specification.
+ *
+ * Parameters -
+ *          spec - the stages, separated by '|'
+ *          error - set to a description of the problem if parsing fails
+ *          frequency - true if the pipeline is for frames that are already
+ *                      in the frequency domain, such as spectra read from
+ *                      frame files
+ *
+ * Returns
+ *          true if successful, false if the specification is invalid, in which
+ *          case the pipeline is left empty
+ ******************************************************************************/
+bool Pipeline::parse(const std::string& spec, std::string& error, bool frequency)
+{
+    size_t begin = 0;
+
+    stages.clear();
+    start = frequency;
+    error.clear();
+
+    while (begin <= spec.size())
+    {
+        size_t bar = spec.find('|', begin);
+        if (bar == std::string::npos)
+            bar = spec.size();
+
+        Stage stage;
+        StageOptions options;
+        std::shared_ptr<const TransferFunction> transfer;
+        stage.text = trim(spec.substr(begin, bar - begin));
+        begin = bar + 1;
+
+        if (!options.parse(stage.text))
+        {
+            error = options.error;
+            break;
+        }
+
+        const std::string& name = options.name;
+
+        if (name == "fft" || name == "ifft")
+        {
+            stage.kind = (name == "fft") ? FORWARD : INVERSE;
+            if (frequency == (name == "fft"))
+            {
+                error = "'" + name + "' used while the image is already in the "
+                      + (frequency ? "frequency" : "spatial") + " domain";
+                break;
+            }
+            frequency = (name == "fft");
+        }
+        else if (name == "noise" || name == "periodic")
+        {
+            double sd = 0, seed = 1, fx = 0, fy = 0, a = 0, phase = 0;
+            stage.kind = SPATIAL;
+
+            if (name == "noise")
+            {
+                options.optional("seed", seed);
+                if (seed < 0 || seed != floor(seed))
+                    options.error = "seed must be a whole number, not less than 0";
+                else if (options.require("sd", sd))
+                    stage.change = [sd, seed](Buffer2D<float>& image)
+                    {
+                        addGaussianNoise(image, sd, (uint64_t) seed);
+                    };
+            }
+            else
+            {
+                options.optional("phase", phase);
+                if (options.require("fx", fx) && options.require("fy", fy)
+                    && options.require("a", a))
+                    stage.change = [fy, fx, a, phase](Buffer2D<float>& image)
+                    {
+                        addPeriodicNoise(image, fy, fx, a, phase);
+                    };
+            }
+        }
+        else if (name == "autonotch")
+        {
+            double t = DEFAULT_PEAK_THRESHOLD, r = DEFAULT_PEAK_NOTCH_RADIUS;
+            double max = DEFAULT_MAX_PEAKS;
+            stage.kind = ADAPTIVE;
+
+            options.optional("t", t);
+            options.optional("r", r);
+            options.optional("max", max);
+            if (max < 1 || max != floor(max))
+                options.error = "max must be a whole number, at least 1";
+            else if (t <= 0 || r <= 0)
+                options.error = "t and r must be greater than 0";
+            else
+                stage.adapt = [t, r, max](Frame& frame)
+                {
+                    PeakDetector detector;
+                    detector.setThreshold(t);
+                    detector.setMaxPeaks((int) max);
+
+                    std::vector<SpectrumPeak> peaks
+                        = detector.detect(frame.real, frame.imag, frame.cols);
+                    if (!peaks.empty())
+                        applyTransfer(PeakDetector::notches(peaks, r), frame.real,
+                                      frame.imag, frame.cols);
+                };
+        }
+        else
+        {
+            double r = 0, lo = 0, hi = 0, fx = 0, fy = 0, K = 0;
+            double t = DEFAULT_INVERSE_THRESHOLD;
+            bool gaussian = !options.word("ideal");
+            options.word("gaussian");
+            stage.kind = FILTER;
+
+            if (name == "lowpass")
+            {
+                if (options.require("r", r))
+                {
+                    if (gaussian)
+                        transfer.reset(new GaussianLowPass(r));
+                    else
+                        transfer.reset(new IdealLowPass(r));
+                    stage.smoothing = gaussian ? r : 0;
+                }
+            }
+            else if (name == "bandreject")
+            {
+                if (options.require("lo", lo) && options.require("hi", hi))
+                {
+                    if (gaussian)
+                        transfer.reset(new GaussianBandReject(lo, hi));
+                    else
+                        transfer.reset(new IdealBandReject(lo, hi));
+                }
+            }
+            else if (name == "blur")
+            {
+                // The H that GaussianInverse and GaussianWiener divide by
+                if (options.require("r", r))
+                {
+                    transfer.reset(new GaussianLowPass(r));
+                    stage.smoothing = r;
+                }
+            }
+            else if (name == "notch")
+            {
+                if (options.require("fx", fx) && options.require("fy", fy)
+                    && options.require("r", r))
+                    transfer.reset(new GaussianSpotReject(fy, fx, r));
+            }
+            else if (name == "inverse")
+            {
+                options.optional("t", t);
+                if (options.require("r", r))
+                    transfer.reset(new GaussianInverse(r, t));
+            }
+            else if (name == "wiener")
+            {
+                options.optional("t", t);
+                if (options.require("r", r) && options.require("K", K))
+                    transfer.reset(new GaussianWiener(r, K, t));
+            }
+            else
+            {
+                error = "unknown stage '" + name + "'";
+                break;
+            }
+
+            // Only the low-pass and band-reject filters have an ideal form
+            if (!gaussian && name != "lowpass" && name != "bandreject")
+                options.words.insert("ideal");
+        }
+
+        if (!options.finish())
+        {
+            error = options.error;
+            break;
+        }
+        if ((stage.kind == FILTER || stage.kind == ADAPTIVE) && !frequency)
+        {
+            error = "'" + options.name + "' needs the frequency domain, add 'fft' before it";
+            break;
+        }
+        if (stage.kind == SPATIAL && frequency)
+        {
+            error = "'" + options.name + "' needs the spatial domain, add 'ifft' before it";
+            break;
+        }
+
+        // Fold a filter into the filter stage before it, if there is one
+        if (stage.kind == FILTER && !stages.empty() && stages.back().kind == FILTER)
+        {
+            // Gaussian low-passes multiply into one with 1/R^2 = sum 1/r^2
+            Stage& previous = stages.back();
+            if (previous.smoothing > 0 && stage.smoothing > 0)
+                previous.smoothing = 1 / sqrt(1 / (previous.smoothing * previous.smoothing)
+                                              + 1 / (stage.smoothing * stage.smoothing));
+            else
+                previous.smoothing = 0;
+
+            previous.filters->add(transfer);
+            previous.text += " | " + stage.text;
+            continue;
+        }
+        if (stage.kind == FILTER)
+        {
+            stage.filters = std::make_shared<TransferChain>();
+            stage.filters->add(transfer);
+        }
+        stages.push_back(stage);
+    }
+
+    if (!error.empty())
+        stages.clear();
+    return error.empty();
+}
+
+/***************************************************************************//**
+ * Pipeline::run
+ * Author - Dan Andrus
+ *
+ * Runs every stage on a frame in order and adds them to its history.
+ *
+ * Parameters -
+ *          frame - the image to process, in the domain the pipeline was
+ *                  parsed for
+ ******************************************************************************/
+void Pipeline::run(Frame& frame) const
+{
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        const Stage& stage = stages[i];
+
+        if (!frame.history.empty())
+            frame.history += " | ";
+        frame.history += stage.text;
+
+        if (stage.kind == FORWARD)
+        {
+            size_t last = runSmoothed(frame, i);
+            for (size_t j = i + 1; j <= last; j++)
+                frame.history += " | " + stages[j].text;
+            if (last > i)
+            {
+                i = last;
+                continue;
+            }
+        }
+
+        if (stage.kind == FORWARD && tile > 0)
+        {
+            size_t last = runTiled(frame, i);
+            for (size_t j = i + 1; j <= last; j++)
+                frame.history += " | " + stages[j].text;
+            if (last > i)
+            {
+                i = last;
+                continue;
+            }
+        }
+
+        switch (stage.kind)
+        {
+            case FORWARD:
+                frame.cols = frame.spatial.cols();
+                realFFT2D(frame.spatial, frame.real, frame.imag);
+                frame.spatial.release();
+                frame.frequency = true;
+                break;
+
+            case INVERSE:
+                inverseRealFFT2D(frame.real, frame.imag, frame.spatial, frame.cols);
+                frame.real.release();
+                frame.imag.release();
+                frame.frequency = false;
+                break;
+
+            case FILTER:
+                applyTransfer(*stage.filters, frame.real, frame.imag, frame.cols);
+                break;
+
+            case SPATIAL:
+                stage.change(frame.spatial);
+                break;
+
+            case ADAPTIVE:
+                stage.adapt(frame);
+                break;
+        }
+    }
+}
+
+/***************************************************************************//**
+ * Pipeline::runSmoothed
+ * Author - Dan Andrus
+ *
+ * Runs the fft at stage first, the Gaussian low-pass after it and the ifft
+ * that ends it as a GaussianSmoother. With a tile size set, the smoothing is
+ * left to runTiled unless the smoother can skip the transforms.
+ *
+ * Returns
+ *          the index of the ifft, or first if the stages that follow are not
+ *          a Gaussian low-pass ending in an ifft, in which case nothing is done
+ ******************************************************************************/
+size_t Pipeline::runSmoothed(Frame& frame, size_t first) const
+{
+    size_t last = first + 2;
+
+    if (last >= stages.size() || stages[first + 1].kind != FILTER
+        || stages[first + 1].smoothing <= 0 || stages[last].kind != INVERSE)
+        return first;
+
+    GaussianSmoother smoother(stages[first + 1].smoothing,
+                              frame.spatial.rows(), frame.spatial.cols());
+    if (tile > 0 && smoother.method() == SMOOTH_FREQUENCY)
+        return first;
+
+    smoother.run(frame.spatial);
+    frame.cols = frame.spatial.cols();
+    return last;
+}
+
+/***************************************************************************//**
+ * Pipeline::runTiled
+ * Author - Dan Andrus
+ *
+ * Runs the fft at stage first, the filters after it and the ifft that ends
+ * them as one tiled filter.
+ *
+ * Returns
+ *          the index of the ifft, or first if the stages that follow are not
+ *          filters ending in an ifft, in which case nothing is done
+ ******************************************************************************/
+size_t Pipeline::runTiled(Frame& frame, size_t first) const
+{
+    TransferChain none;
+    const TransferFunction* filters = &none;
+    size_t last = first + 1;
+    Buffer2D<float> result;
+
+    if (last < stages.size() && stages[last].kind == FILTER)
+        filters = stages[last++].filters.get();
+    if (last >= stages.size() || stages[last].kind != INVERSE)
+        return first;
+
+    TiledFilter tiled(*filters, frame.spatial.rows(), frame.spatial.cols(), tile);
+    tiled.run(frame.spatial, result);
+    frame.spatial = std::move(result);
+    frame.cols = frame.spatial.cols();
+    return last;
+}
+
+/***************************************************************************//**
+ * Pipeline::endsInFrequency
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          true if the pipeline leaves images in the frequency domain
+ ******************************************************************************/
+bool Pipeline::endsInFrequency() const
+{
+    bool frequency = start;
+
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        if (stages[i].kind == FORWARD || stages[i].kind == INVERSE)
+            frequency = (stages[i].kind == FORWARD);
+    }
+    return frequency;
+}
+
+/***************************************************************************//**
+ * Pipeline::describe
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the stages of the pipeline, normalized and separated by " | "
+ ******************************************************************************/
+std::string Pipeline::describe() const
+{
+    std::string text;
+
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        if (i > 0)
+            text += " | ";
+        text += stages[i].text;
+    }
+    return text;
+}
+
+/***************************************************************************//**
+ * Pipeline::onlyFilters
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the filters of a pipeline for spatial frames made of an fft, one
+ *          run of filters and an ifft, or NULL for any other pipeline
+ ******************************************************************************/
+const TransferFunction* Pipeline::onlyFilters() const
+{
+    if (start || stages.size() != 3 || stages[0].kind != FORWARD
+        || stages[1].kind != FILTER || stages[2].kind != INVERSE)
+        return NULL;
+    return stages[1].filters.get();
+}
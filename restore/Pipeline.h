@@ -0,0 +1,153 @@
+/***************************************************************************//**
+ * Pipeline.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 16, 2015
+ *
+ * Details - Contains the Pipeline class, which runs a sequence of restoration
+ *           steps written as text, such as
+ *
+ *               fft | lowpass gaussian r=40 | wiener K=0.01 r=30 | ifft
+ *
+ *           so that the same filters used by the menus can be applied to
+ *           images without the GUI.
+ ******************************************************************************/
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Buffer2D.h"
+#include "Transfer.h"
+
+// Threshold on 1/H used by the inverse and Wiener filters
+static const double DEFAULT_INVERSE_THRESHOLD = 1000000;
+
+// Most combinations Pipeline::expand will produce
+static const size_t MAX_PIPELINE_VARIANTS = 100000;
+
+/***************************************************************************//**
+ * Frame
+ *
+ * Author - Dan Andrus
+ *
+ * One image moving through a pipeline: its intensities while it is in the
+ * spatial domain and its half spectrum while it is in the frequency domain.
+ * cols is the width of the image, which the half spectrum alone does not
+ * determine. history lists the stages the frame has been through, separated
+ * by " | ", and is saved with it in frame files.
+ ******************************************************************************/
+struct Frame
+{
+    Frame() : cols(0), frequency(false) {}
+
+    Buffer2D<float> spatial;
+    Buffer2D<float> real;
+    Buffer2D<float> imag;
+    int cols;
+    bool frequency;
+    std::string history;
+};
+
+/***************************************************************************//**
+ * Pipeline
+ *
+ * Author - Dan Andrus
+ *
+ * A parsed list of stages, separated by '|'. Each stage is a name followed by
+ * options, which are either words or key=value pairs:
+ *
+ *      fft                                     to the frequency domain
+ *      ifft                                    back to the spatial domain
+ *      lowpass [ideal|gaussian] r=R            low-pass filter, radius R
+ *      bandreject [ideal|gaussian] lo=A hi=B   band-reject filter
+ *      notch fx=X fy=Y r=R                     Gaussian spot reject at (X, Y)
+ *                                              and its mirror
+ *      inverse r=R [t=T]                       inverse of a Gaussian blur
+ *      wiener r=R K=K [t=T]                    Wiener filter for a Gaussian blur
+ *      autonotch [t=T] [r=R] [max=N]           notches of radius R on the
+ *                                              periodic noise peaks found
+ *                                              with threshold T
+ *
+ * and, to degrade images rather than restore them,
+ *
+ *      blur r=R                                the Gaussian blur undone by
+ *                                              inverse and wiener r=R
+ *      noise sd=S [seed=N]                     additive Gaussian noise
+ *      periodic fx=X fy=Y a=A [phase=P]        a sinusoid of amplitude A
+ *                                              whose spectrum is a spike at
+ *                                              (X, Y) and its mirror
+ *
+ * Frequencies and radii are in pixels from the center of the displayed
+ * spectrum, as in the menus. Filters default to gaussian, t defaults to
+ * DEFAULT_INVERSE_THRESHOLD and seed to 1. autonotch defaults to the
+ * PeakDetector defaults. Filters, blur and autonotch included, may only
+ * appear while the image is in the frequency domain, and noise and periodic
+ * only while it is in the spatial domain. parse() checks this, so run()
+ * cannot fail on a pipeline that parsed when given a frame in the domain it
+ * was parsed for.
+ *
+ * Consecutive filters are combined into one TransferChain when parsed, so a
+ * run of filters costs a single pass over the spectrum.
+ *
+ * With a tile size set, every fft that is followed by its filters and an
+ * ifft is run as a TiledFilter instead, so the image never has a whole
+ * spectrum in memory. The result then differs slightly from the untiled
+ * one; see TiledFilter. autonotch looks for peaks in the whole spectrum, so
+ * an fft whose filters include it is never tiled.
+ *
+ * An fft followed by nothing but Gaussian low-pass and blur filters and an
+ * ifft is a Gaussian smoothing, and is run as a GaussianSmoother, which
+ * skips the transforms when a convolution is cheaper. It is only tiled if
+ * the transforms are the cheapest way after all.
+ *
+ * onlyFilters() recognizes a pipeline that is nothing but an fft, filters
+ * and an ifft, which a StackFilter can run on many frames at once.
+ *
+ * expand() turns a specification whose options list several values into
+ * one specification per combination, for running a grid of parameters.
+ ******************************************************************************/
+class Pipeline
+{
+  public:
+    Pipeline() : start(false), tile(0) {}
+
+    static bool expand(const std::string& spec, std::vector<std::string>& specs,
+                       std::string& error);
+
+    bool parse(const std::string& spec, std::string& error, bool frequency = false);
+    void run(Frame& frame) const;
+
+    void setTileSize(int size) { tile = size; }
+    int tileSize() const { return tile; }
+
+    bool empty() const { return stages.empty(); }
+    bool startsInFrequency() const { return start; }
+    bool endsInFrequency() const;
+    std::string describe() const;
+    const TransferFunction* onlyFilters() const;
+
+  private:
+    enum StageKind { FORWARD, INVERSE, FILTER, SPATIAL, ADAPTIVE };
+
+    struct Stage
+    {
+        Stage() : smoothing(0) {}
+
+        StageKind kind;
+        std::string text;
+        std::shared_ptr<TransferChain> filters;
+        std::function<void(Buffer2D<float>&)> change;  // for SPATIAL stages
+        std::function<void(Frame&)> adapt;             // for ADAPTIVE stages
+        double smoothing;   // radius of the one Gaussian low-pass the filters
+                            // amount to, or 0 if they are anything else
+    };
+
+    size_t runSmoothed(Frame& frame, size_t first) const;
+    size_t runTiled(Frame& frame, size_t first) const;
+
+    std::vector<Stage> stages;
+    bool start;                     // parsed for frames in the frequency domain
+    int tile;                       // 0 to filter whole frames
+};
@@ -0,0 +1,234 @@
+/***************************************************************************//**
+ * Precision.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 23, 2015
+ *
+ * Details - Contains the precisions frequency data can be kept in, and half,
+ *           a 16-bit floating point type used only to store values. All
+ *           arithmetic on half values is done after converting them to
+ *           float.
+ ******************************************************************************/
+#pragma once
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include "Buffer2D.h"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+/***************************************************************************//**
+ * Precision
+ *
+ * Author - Dan Andrus
+ *
+ * How many bits each value of a spectrum is stored in. Single precision is
+ * the default. Double precision takes twice the memory and is somewhat
+ * slower, but the inverse and Wiener filters, which can multiply the highest
+ * frequencies by up to their threshold, amplify rounding errors in float
+ * into visible noise. Half precision takes half the memory of float but
+ * keeps only 11 significant bits, and values below about 6e-8 become zero.
+ ******************************************************************************/
+enum Precision
+{
+    HALF_PRECISION,
+    SINGLE_PRECISION,
+    DOUBLE_PRECISION
+};
+
+inline const char* precisionName(Precision precision)
+{
+    static const char* const names[] = { "half", "single", "double" };
+    return names[precision];
+}
+
+inline size_t precisionBytes(Precision precision)
+{
+    static const size_t bytes[] = { 2, 4, 8 };
+    return bytes[precision];
+}
+
+/***************************************************************************//**
+ * parsePrecision
+ * Author - Dan Andrus
+ *
+ * Reads a precision from its name, as given by precisionName, or its number
+ * of bits.
+ *
+ * Returns
+ *          true if the name was recognized
+ ******************************************************************************/
+inline bool parsePrecision(const std::string& name, Precision& precision)
+{
+    if (name == "half" || name == "16")
+        precision = HALF_PRECISION;
+    else if (name == "single" || name == "float" || name == "32")
+        precision = SINGLE_PRECISION;
+    else if (name == "double" || name == "64")
+        precision = DOUBLE_PRECISION;
+    else
+        return false;
+    return true;
+}
+
+/***************************************************************************//**
+ * half
+ *
+ * Author - Dan Andrus
+ *
+ * An IEEE 754 binary16 value: 1 sign bit, 5 exponent bits and 10 fraction
+ * bits. Only a storage type; use halfToFloat and floatToHalf, or convertRow
+ * for whole rows, to get at the value.
+ ******************************************************************************/
+struct half
+{
+    uint16_t bits;
+};
+
+/***************************************************************************//**
+ * floatToHalf
+ * Author - Dan Andrus
+ *
+ * Rounds a float to the nearest half, ties to even. Values too large for a
+ * half become infinity and values too small become zero.
+ ******************************************************************************/
+inline half floatToHalf(float value)
+{
+    uint32_t x;
+    half h;
+
+    memcpy(&x, &value, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    int exponent = (int) ((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = x & 0x7fffff;
+
+    if (((x >> 23) & 0xff) == 0xff)
+    {
+        // Infinity stays infinity, any NaN becomes a quiet NaN
+        h.bits = (uint16_t) (sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+        return h;
+    }
+    if (exponent >= 0x1f)
+    {
+        h.bits = (uint16_t) (sign | 0x7c00);
+        return h;
+    }
+
+    uint32_t bits;
+    uint32_t rest;
+    uint32_t halfway;
+
+    if (exponent <= 0)
+    {
+        // Subnormal half, counted in units of 2^-24
+        if (exponent < -10)
+        {
+            h.bits = (uint16_t) sign;
+            return h;
+        }
+        int shift = 14 - exponent;
+        mantissa |= 0x800000;
+        bits = mantissa >> shift;
+        rest = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }
+    else
+    {
+        bits = ((uint32_t) exponent << 10) | (mantissa >> 13);
+        rest = mantissa & 0x1fff;
+        halfway = 0x1000;
+    }
+
+    // A carry out of the fraction correctly moves on to the next exponent
+    if (rest > halfway || (rest == halfway && (bits & 1)))
+        bits++;
+    h.bits = (uint16_t) (sign | bits);
+    return h;
+}
+
+/***************************************************************************//**
+ * halfToFloat
+ * Author - Dan Andrus
+ *
+ * Returns the exact float value of a half.
+ ******************************************************************************/
+inline float halfToFloat(half h)
+{
+    uint32_t sign = (uint32_t) (h.bits & 0x8000) << 16;
+    uint32_t exponent = (h.bits >> 10) & 0x1f;
+    uint32_t mantissa = h.bits & 0x3ff;
+    uint32_t x;
+    float value;
+
+    if (exponent == 0)
+    {
+        value = (float) mantissa * (1.0f / 16777216.0f);
+        return sign ? -value : value;
+    }
+
+    if (exponent == 0x1f)
+        x = sign | 0x7f800000 | (mantissa << 13);
+    else
+        x = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    memcpy(&value, &x, sizeof(value));
+    return value;
+}
+
+/***************************************************************************//**
+ * convertRow
+ * Author - Dan Andrus
+ *
+ * Converts n values from one scalar type to another. Conversions to and from
+ * half use the F16C instructions, eight values at a time, when compiled with
+ * them.
+ ******************************************************************************/
+template <typename From, typename To>
+inline void convertRow(const From* from, To* to, int n)
+{
+    for (int i = 0; i < n; i++)
+        to[i] = (To) from[i];
+}
+
+inline void convertRow(const float* from, half* to, int n)
+{
+    int i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i packed = _mm256_cvtps_ph(_mm256_loadu_ps(from + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*) (to + i), packed);
+    }
+#endif
+    for (; i < n; i++)
+        to[i] = floatToHalf(from[i]);
+}
+
+inline void convertRow(const half* from, float* to, int n)
+{
+    int i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(to + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (from + i))));
+#endif
+    for (; i < n; i++)
+        to[i] = halfToFloat(from[i]);
+}
+
+/***************************************************************************//**
+ * convertBuffer
+ * Author - Dan Andrus
+ *
+ * Copies a buffer into one of another scalar type, resizing it to match.
+ ******************************************************************************/
+template <typename From, typename To>
+void convertBuffer(const Buffer2D<From>& from, Buffer2D<To>& to)
+{
+    to.resize(from.rows(), from.cols());
+    for (int r = 0; r < from.rows(); r++)
+        convertRow(from[r], to[r], from.cols());
+}
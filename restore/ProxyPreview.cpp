@@ -0,0 +1,217 @@
+/***************************************************************************//**
+ * ProxyPreview.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 19, 2015
+ *
+ * Details - Defines the ProxyPreview class.
+ ******************************************************************************/
+#include "ProxyPreview.h"
+#include "FFT.h"
+#include <algorithm>
+#include <chrono>
+
+/***************************************************************************//**
+ * copyBuffer
+ * Author - Dan Andrus
+ *
+ * Copies one buffer into another, resizing the destination to match.
+ ******************************************************************************/
+static void copyBuffer(const Buffer2D<float>& from, Buffer2D<float>& to)
+{
+    to.resize(from.rows(), from.cols());
+    for (int r = 0; r < from.rows(); r++)
+        std::copy(from[r], from[r] + from.cols(), to[r]);
+}
+
+ProxyPreview::ProxyPreview()
+    : stopping(false), working(false), proxyCols(0), generation(0),
+      resultGeneration(0), takenGeneration(0), resultMs(0)
+{
+    worker = std::thread(&ProxyPreview::workerLoop, this);
+}
+
+ProxyPreview::~ProxyPreview()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+/***************************************************************************//**
+ * setSource
+ * Author - Dan Andrus
+ *
+ * Keeps the lowest frequencies of a half spectrum for later requests. The
+ * proxy has the same shape as the image, scaled down so its larger dimension
+ * is at most size, and is kept in single precision whatever the precision of
+ * the spectrum. Any request in progress is abandoned.
+ *
+ * Parameters -
+ *          spectrum - the half spectrum of the image
+ *          size - the largest dimension of the proxy
+ ******************************************************************************/
+void ProxyPreview::setSource(const Spectrum& spectrum, int size)
+{
+    int rows = spectrum.rows;
+    int cols = spectrum.cols;
+    Buffer2D<float> line(2, halfSpectrumCols(cols));
+    double scale = std::min(1.0, (double) size / std::max(rows, cols));
+    int prows = std::max(1, (int) (rows * scale + 0.5));
+    int pcols = std::max(1, (int) (cols * scale + 0.5));
+    int half = halfSpectrumCols(pcols);
+
+    std::lock_guard<std::mutex> guard(lock);
+    generation++;
+    pending.reset();
+
+    sourceReal.resize(prows, half);
+    sourceImag.resize(prows, half);
+    proxyCols = pcols;
+
+    // Row u of the proxy holds frequency u, or u - prows past the middle, as
+    // laid out by FrequencyGeometry. Columns are frequencies 0 to pcols/2 in
+    // both spectra
+    for (int u = 0; u < prows; u++)
+    {
+        int f = (u < prows - prows / 2) ? u : u - prows;
+        int r = (f + rows) % rows;
+
+        spectrum.readRow(r, line[0], line[1]);
+        std::copy(line[0], line[0] + half, sourceReal[u]);
+        std::copy(line[1], line[1] + half, sourceImag[u]);
+    }
+}
+
+/***************************************************************************//**
+ * request
+ * Author - Dan Andrus
+ *
+ * Asks for the proxy image filtered by a transfer function, replacing any
+ * earlier request. Returns right away.
+ ******************************************************************************/
+void ProxyPreview::request(const std::shared_ptr<const TransferFunction>& transfer)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        generation++;
+        pending = transfer;
+    }
+    wake.notify_one();
+}
+
+/***************************************************************************//**
+ * cancel
+ * Author - Dan Andrus
+ *
+ * Abandons the current request. A result already finished can still be
+ * taken.
+ ******************************************************************************/
+void ProxyPreview::cancel()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    generation++;
+    pending.reset();
+}
+
+/***************************************************************************//**
+ * take
+ * Author - Dan Andrus
+ *
+ * Gets the newest finished result, if it has not been taken yet.
+ *
+ * Parameters -
+ *          image - receives the filtered proxy image
+ *          ms - receives the time from request to result
+ *
+ * Returns
+ *          true if there was a new result
+ ******************************************************************************/
+bool ProxyPreview::take(Buffer2D<float>& image, double& ms)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (resultGeneration == takenGeneration)
+        return false;
+
+    copyBuffer(result, image);
+    ms = resultMs;
+    takenGeneration = resultGeneration;
+    return true;
+}
+
+/***************************************************************************//**
+ * busy
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          true if a request is waiting or being worked on
+ ******************************************************************************/
+bool ProxyPreview::busy()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return working || pending;
+}
+
+/***************************************************************************//**
+ * workerLoop
+ * Author - Dan Andrus
+ *
+ * Runs on the preview thread: waits for a request, filters a copy of the
+ * proxy spectrum and inverts it, checking before each step whether a newer
+ * request has come in.
+ ******************************************************************************/
+void ProxyPreview::workerLoop()
+{
+    Buffer2D<float> real;
+    Buffer2D<float> imag;
+    Buffer2D<float> spatial;
+
+    for (;;)
+    {
+        std::shared_ptr<const TransferFunction> job;
+        bool current;
+        unsigned jobGeneration;
+        int cols;
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            working = false;
+            wake.wait(guard, [this] { return stopping || pending; });
+            if (stopping)
+                return;
+
+            job.swap(pending);
+            jobGeneration = generation;
+            cols = proxyCols;
+            copyBuffer(sourceReal, real);
+            copyBuffer(sourceImag, imag);
+            working = true;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        applyTransfer(*job, real, imag, cols);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            current = (jobGeneration == generation);
+        }
+        if (!current)
+            continue;
+
+        inverseRealFFT2D(real, imag, spatial, cols);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (jobGeneration == generation)
+        {
+            copyBuffer(spatial, result);
+            resultGeneration = jobGeneration;
+            resultMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+    }
+}
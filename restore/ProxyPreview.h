@@ -0,0 +1,76 @@
+/***************************************************************************//**
+ * ProxyPreview.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 19, 2015
+ *
+ * Details - Contains the ProxyPreview class, which computes a small, quick
+ *           approximation of what a filter will do to an image while the
+ *           user is still choosing the filter.
+ ******************************************************************************/
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "Buffer2D.h"
+#include "Spectrum.h"
+#include "Transfer.h"
+
+/***************************************************************************//**
+ * ProxyPreview
+ *
+ * Author - Dan Andrus
+ *
+ * Keeps only the lowest frequencies of a spectrum, at most DEFAULT_SIZE of
+ * them across its larger dimension, and turns them back into a small image
+ * after multiplying by a candidate transfer function. Since transfer
+ * functions are defined on frequencies in pixels from the center, the same
+ * function applies unchanged to the cropped spectrum. The result is a
+ * downscaled version of what the filter would give on the full image.
+ *
+ * Work is done on a thread of its own so the caller never waits. Only the
+ * newest request matters: a request replaces one that has not started, and
+ * a job whose request has been replaced is abandoned before its inverse
+ * transform and its result is never published. take() returns each finished
+ * result once.
+ ******************************************************************************/
+class ProxyPreview
+{
+  public:
+    static const int DEFAULT_SIZE = 256;
+
+    ProxyPreview();
+    ~ProxyPreview();
+
+    void setSource(const Spectrum& spectrum, int size = DEFAULT_SIZE);
+    void request(const std::shared_ptr<const TransferFunction>& transfer);
+    void cancel();
+    bool take(Buffer2D<float>& image, double& ms);
+    bool busy();
+
+  private:
+    void workerLoop();
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread worker;
+    bool stopping;
+    bool working;
+
+    Buffer2D<float> sourceReal;
+    Buffer2D<float> sourceImag;
+    int proxyCols;
+
+    std::shared_ptr<const TransferFunction> pending;
+    unsigned generation;
+
+    Buffer2D<float> result;
+    unsigned resultGeneration;
+    unsigned takenGeneration;
+    double resultMs;
+
+    ProxyPreview(const ProxyPreview&);
+    ProxyPreview& operator=(const ProxyPreview&);
+};
@@ -0,0 +1,222 @@
+/***************************************************************************//**
+ * Simd.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 12, 2015
+ *
+ * Details - A small wrapper around SSE and AVX registers so that the filter
+ *           kernels can be written once. vfloat holds VFLOAT_WIDTH floats:
+ *           8 when compiled with AVX2, 4 with SSE2 and 1 otherwise, in which
+ *           case vfloat is simply float. Every function also has a plain
+ *           float overload, so a kernel written as a template over the value
+ *           type handles the leftover columns at the end of a row with the
+ *           same code. Loads are templates, vload<V>(p), since they cannot be
+ *           overloaded on their return type.
+ ******************************************************************************/
+#pragma once
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VFLOAT_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VFLOAT_WIDTH 4
+#else
+#define VFLOAT_WIDTH 1
+#endif
+
+/***************************************************************************//**
+ * Scalar overloads
+ *
+ * Used for the last few columns of a row and when no SIMD is available.
+ ******************************************************************************/
+template <typename V> V vload(const float* p);
+template <typename V> V vloadu(const float* p);
+
+template <> inline float vload<float>(const float* p) { return *p; }
+template <> inline float vloadu<float>(const float* p) { return *p; }
+inline void vstore(float* p, float a) { *p = a; }
+inline float vmin(float a, float b) { return a < b ? a : b; }
+inline float vmax(float a, float b) { return a > b ? a : b; }
+inline float vsqrt(float a) { return std::sqrt(a); }
+inline float vexp(float a) { return std::exp(a); }
+inline float vlog(float a) { return std::log(a); }
+inline bool vless(float a, float b) { return a < b; }
+inline bool vlessEqual(float a, float b) { return a <= b; }
+inline bool vand(bool a, bool b) { return a && b; }
+inline float vselect(bool mask, float a, float b) { return mask ? a : b; }
+
+#if VFLOAT_WIDTH == 8
+
+/***************************************************************************//**
+ * vfloat (AVX2)
+ ******************************************************************************/
+struct vfloat
+{
+    __m256 v;
+    vfloat() {}
+    vfloat(__m256 v) : v(v) {}
+    vfloat(float f) : v(_mm256_set1_ps(f)) {}
+};
+
+inline vfloat operator+(vfloat a, vfloat b) { return _mm256_add_ps(a.v, b.v); }
+inline vfloat operator-(vfloat a, vfloat b) { return _mm256_sub_ps(a.v, b.v); }
+inline vfloat operator*(vfloat a, vfloat b) { return _mm256_mul_ps(a.v, b.v); }
+inline vfloat operator/(vfloat a, vfloat b) { return _mm256_div_ps(a.v, b.v); }
+inline vfloat operator-(vfloat a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+
+template <> inline vfloat vload<vfloat>(const float* p) { return _mm256_load_ps(p); }
+template <> inline vfloat vloadu<vfloat>(const float* p) { return _mm256_loadu_ps(p); }
+inline void vstore(float* p, vfloat a) { _mm256_store_ps(p, a.v); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm256_min_ps(a.v, b.v); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm256_max_ps(a.v, b.v); }
+inline vfloat vsqrt(vfloat a) { return _mm256_sqrt_ps(a.v); }
+inline vfloat vless(vfloat a, vfloat b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline vfloat vlessEqual(vfloat a, vfloat b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+inline vfloat vand(vfloat a, vfloat b) { return _mm256_and_ps(a.v, b.v); }
+inline vfloat vselect(vfloat mask, vfloat a, vfloat b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+
+typedef __m256i vint;
+inline vint vroundToInt(vfloat a) { return _mm256_cvtps_epi32(a.v); }
+inline vfloat vtoFloat(vint a) { return _mm256_cvtepi32_ps(a); }
+inline vfloat vpow2i(vint n)
+{
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23));
+}
+inline vint vexponent(vfloat a)
+{
+    return _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(a.v), 23), _mm256_set1_epi32(127));
+}
+inline vfloat vmantissa(vfloat a)
+{
+    __m256i bits = _mm256_castps_si256(a.v);
+    bits = _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff));
+    bits = _mm256_or_si256(bits, _mm256_set1_epi32(0x3f800000));
+    return _mm256_castsi256_ps(bits);
+}
+
+#elif VFLOAT_WIDTH == 4
+
+/***************************************************************************//**
+ * vfloat (SSE2)
+ ******************************************************************************/
+struct vfloat
+{
+    __m128 v;
+    vfloat() {}
+    vfloat(__m128 v) : v(v) {}
+    vfloat(float f) : v(_mm_set1_ps(f)) {}
+};
+
+inline vfloat operator+(vfloat a, vfloat b) { return _mm_add_ps(a.v, b.v); }
+inline vfloat operator-(vfloat a, vfloat b) { return _mm_sub_ps(a.v, b.v); }
+inline vfloat operator*(vfloat a, vfloat b) { return _mm_mul_ps(a.v, b.v); }
+inline vfloat operator/(vfloat a, vfloat b) { return _mm_div_ps(a.v, b.v); }
+inline vfloat operator-(vfloat a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+
+template <> inline vfloat vload<vfloat>(const float* p) { return _mm_load_ps(p); }
+template <> inline vfloat vloadu<vfloat>(const float* p) { return _mm_loadu_ps(p); }
+inline void vstore(float* p, vfloat a) { _mm_store_ps(p, a.v); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a.v, b.v); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm_max_ps(a.v, b.v); }
+inline vfloat vsqrt(vfloat a) { return _mm_sqrt_ps(a.v); }
+inline vfloat vless(vfloat a, vfloat b) { return _mm_cmplt_ps(a.v, b.v); }
+inline vfloat vlessEqual(vfloat a, vfloat b) { return _mm_cmple_ps(a.v, b.v); }
+inline vfloat vand(vfloat a, vfloat b) { return _mm_and_ps(a.v, b.v); }
+inline vfloat vselect(vfloat mask, vfloat a, vfloat b)
+{
+    return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+}
+
+typedef __m128i vint;
+inline vint vroundToInt(vfloat a) { return _mm_cvtps_epi32(a.v); }
+inline vfloat vtoFloat(vint a) { return _mm_cvtepi32_ps(a); }
+inline vfloat vpow2i(vint n)
+{
+    return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+}
+inline vint vexponent(vfloat a)
+{
+    return _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(a.v), 23), _mm_set1_epi32(127));
+}
+inline vfloat vmantissa(vfloat a)
+{
+    __m128i bits = _mm_castps_si128(a.v);
+    bits = _mm_and_si128(bits, _mm_set1_epi32(0x007fffff));
+    bits = _mm_or_si128(bits, _mm_set1_epi32(0x3f800000));
+    return _mm_castsi128_ps(bits);
+}
+
+#else
+
+typedef float vfloat;
+
+#endif
+
+#if VFLOAT_WIDTH > 1
+
+/***************************************************************************//**
+ * vexp
+ * Author - Dan Andrus
+ *
+ * Vectorized approximation of exp(x), accurate to about 2 ulp. Splits x into
+ * n*ln(2) + r with |r| <= ln(2)/2, evaluates a degree 6 polynomial for exp(r)
+ * and scales by 2^n through the exponent bits. Inputs are clamped to the range
+ * a float can represent, so very negative inputs give about 1e-38 rather
+ * than 0 and very large inputs give about 3e38 rather than infinity.
+ ******************************************************************************/
+inline vfloat vexp(vfloat x)
+{
+    x = vmin(vmax(x, vfloat(-87.3f)), vfloat(88.3f));
+
+    vint n = vroundToInt(x * vfloat(1.44269504088896341f));
+    vfloat fn = vtoFloat(n);
+    vfloat r = x - fn * vfloat(0.693359375f) + fn * vfloat(2.12194440e-4f);
+
+    vfloat p = vfloat(1.9875691500e-4f);
+    p = p * r + vfloat(1.3981999507e-3f);
+    p = p * r + vfloat(8.3334519073e-3f);
+    p = p * r + vfloat(4.1665795894e-2f);
+    p = p * r + vfloat(1.6666665459e-1f);
+    p = p * r + vfloat(5.0000001201e-1f);
+    p = p * r * r + r + vfloat(1.0f);
+
+    return p * vpow2i(n);
+}
+
+/***************************************************************************//**
+ * vlog
+ * Author - Dan Andrus
+ *
+ * Vectorized approximation of the natural logarithm for positive, normal
+ * inputs. Splits x into m * 2^e with m in [sqrt(1/2), sqrt(2)) and evaluates
+ * a polynomial in m - 1.
+ ******************************************************************************/
+inline vfloat vlog(vfloat x)
+{
+    vint e = vexponent(x);
+    vfloat m = vmantissa(x);                     // in [1, 2)
+    vfloat big = vless(vfloat(1.41421356f), m);
+    m = vselect(big, m * vfloat(0.5f), m);
+    vfloat fe = vtoFloat(e) + vselect(big, vfloat(1.0f), vfloat(0.0f));
+
+    vfloat f = m - vfloat(1.0f);
+    vfloat z = f * f;
+    vfloat p = vfloat(7.0376836292e-2f);
+    p = p * f + vfloat(-1.1514610310e-1f);
+    p = p * f + vfloat(1.1676998740e-1f);
+    p = p * f + vfloat(-1.2420140846e-1f);
+    p = p * f + vfloat(1.4249322787e-1f);
+    p = p * f + vfloat(-1.6668057665e-1f);
+    p = p * f + vfloat(2.0000714765e-1f);
+    p = p * f + vfloat(-2.4999993993e-1f);
+    p = p * f + vfloat(3.3333331174e-1f);
+    p = p * f * z;
+
+    p = p + fe * vfloat(-2.12194440e-4f) - z * vfloat(0.5f);
+    return f + p + fe * vfloat(0.693359375f);
+}
+
+#endif
@@ -0,0 +1,290 @@
+/***************************************************************************//**
+ * Spectrum.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 23, 2015
+ *
+ * Details - Defines the Spectrum class.
+ ******************************************************************************/
+#include "Spectrum.h"
+#include "FFT.h"
+#include <algorithm>
+#include <vector>
+
+/***************************************************************************//**
+ * transform
+ * Author - Dan Andrus
+ *
+ * Replaces the spectrum with the forward transform of an image, in the
+ * spectrum's precision. The image has its channels stacked one above the
+ * other; rows and cols are set from it.
+ ******************************************************************************/
+void Spectrum::transform(const Buffer2D<float>& spatial)
+{
+    rows = spatial.rows() / channels;
+    cols = spatial.cols();
+    release();
+
+    if (precision == DOUBLE_PRECISION)
+    {
+        Buffer2D<double> wide;
+        convertBuffer(spatial, wide);
+        realFFT2D(wide, realDouble, imagDouble, channels);
+        return;
+    }
+
+    realFFT2D(spatial, real, imag, channels);
+    if (precision == HALF_PRECISION)
+    {
+        convertBuffer(real, realHalf);
+        real.release();
+        convertBuffer(imag, imagHalf);
+        imag.release();
+    }
+}
+
+/***************************************************************************//**
+ * inverse
+ * Author - Dan Andrus
+ *
+ * Runs the inverse transform into an image, its channels stacked one above
+ * the other. Like inverseRealFFT2D, this overwrites the spectrum, which must
+ * be released or rebuilt afterwards.
+ ******************************************************************************/
+void Spectrum::inverse(Buffer2D<float>& spatial)
+{
+    if (precision == DOUBLE_PRECISION)
+    {
+        Buffer2D<double> wide;
+        inverseRealFFT2D(realDouble, imagDouble, wide, cols, channels);
+        convertBuffer(wide, spatial);
+        return;
+    }
+
+    if (precision == HALF_PRECISION)
+    {
+        convertBuffer(realHalf, real);
+        realHalf.release();
+        convertBuffer(imagHalf, imag);
+        imagHalf.release();
+    }
+    inverseRealFFT2D(real, imag, spatial, cols, channels);
+}
+
+/***************************************************************************//**
+ * apply
+ * Author - Dan Andrus
+ *
+ * Multiplies every channel of the spectrum by a transfer function through
+ * applyTransfer.
+ ******************************************************************************/
+void Spectrum::apply(const TransferFunction& transfer, const TransferObserver& observer)
+{
+    switch (precision)
+    {
+        case HALF_PRECISION:
+            applyTransfer(transfer, realHalf, imagHalf, cols, observer, channels);
+            break;
+        case SINGLE_PRECISION:
+            applyTransfer(transfer, real, imag, cols, observer, channels);
+            break;
+        case DOUBLE_PRECISION:
+            applyTransfer(transfer, realDouble, imagDouble, cols, observer, channels);
+            break;
+    }
+}
+
+/***************************************************************************//**
+ * copyChannel
+ * Author - Dan Andrus
+ *
+ * Copies channel k of a pair of stacked planes into single precision planes
+ * of its own, or back again if out is false.
+ ******************************************************************************/
+template <typename T>
+static void copyChannel(Buffer2D<T>& real, Buffer2D<T>& imag, int k,
+                        Buffer2D<float>& re, Buffer2D<float>& im, bool out)
+{
+    int rows = re.rows();
+    int n = re.cols();
+
+    for (int u = 0; u < rows; u++)
+    {
+        if (out)
+        {
+            convertRow(real[k * rows + u], re[u], n);
+            convertRow(imag[k * rows + u], im[u], n);
+        }
+        else
+        {
+            convertRow(re[u], real[k * rows + u], n);
+            convertRow(im[u], imag[k * rows + u], n);
+        }
+    }
+}
+
+/***************************************************************************//**
+ * edit
+ * Author - Dan Andrus
+ *
+ * Runs an edit on the spectrum, converting it to single precision and back
+ * if it is stored in another precision. The channels of a color spectrum are
+ * each copied out, edited and copied back in turn.
+ ******************************************************************************/
+void Spectrum::edit(const SpectrumEdit& change)
+{
+    if (channels > 1)
+    {
+        Buffer2D<float> re(rows, halfSpectrumCols(cols));
+        Buffer2D<float> im(rows, halfSpectrumCols(cols));
+
+        for (int k = 0; k < channels; k++)
+        {
+            switch (precision)
+            {
+                case HALF_PRECISION:
+                    copyChannel(realHalf, imagHalf, k, re, im, true);
+                    change(re, im, cols);
+                    copyChannel(realHalf, imagHalf, k, re, im, false);
+                    break;
+                case SINGLE_PRECISION:
+                    copyChannel(real, imag, k, re, im, true);
+                    change(re, im, cols);
+                    copyChannel(real, imag, k, re, im, false);
+                    break;
+                case DOUBLE_PRECISION:
+                    copyChannel(realDouble, imagDouble, k, re, im, true);
+                    change(re, im, cols);
+                    copyChannel(realDouble, imagDouble, k, re, im, false);
+                    break;
+            }
+        }
+        return;
+    }
+
+    if (precision == SINGLE_PRECISION)
+    {
+        change(real, imag, cols);
+        return;
+    }
+
+    Buffer2D<float> re;
+    Buffer2D<float> im;
+    toSingle(re, im);
+    change(re, im, cols);
+
+    if (precision == DOUBLE_PRECISION)
+    {
+        convertBuffer(re, realDouble);
+        convertBuffer(im, imagDouble);
+    }
+    else
+    {
+        convertBuffer(re, realHalf);
+        convertBuffer(im, imagHalf);
+    }
+}
+
+/***************************************************************************//**
+ * readRow
+ * Author - Dan Andrus
+ *
+ * Copies row u of the spectrum into re and im as floats, cols/2 + 1 values
+ * each. For a color spectrum, the row of the luminance is computed from the
+ * rows of the channels.
+ ******************************************************************************/
+void Spectrum::readRow(int u, float* re, float* im) const
+{
+    int n = halfSpectrumCols(cols);
+
+    if (channels > 1)
+    {
+        std::vector<float> line(2 * n);
+
+        std::fill(re, re + n, 0.0f);
+        std::fill(im, im + n, 0.0f);
+        for (int k = 0; k < channels; k++)
+        {
+            readChannelRow(k, u, &line[0], &line[n]);
+            for (int v = 0; v < n; v++)
+            {
+                re[v] += LUMINANCE_WEIGHTS[k] * line[v];
+                im[v] += LUMINANCE_WEIGHTS[k] * line[n + v];
+            }
+        }
+        return;
+    }
+    readChannelRow(0, u, re, im);
+}
+
+/***************************************************************************//**
+ * readChannelRow
+ * Author - Dan Andrus
+ *
+ * Copies row u of channel k of the spectrum into re and im as floats.
+ ******************************************************************************/
+void Spectrum::readChannelRow(int k, int u, float* re, float* im) const
+{
+    int n = halfSpectrumCols(cols);
+
+    u += k * rows;
+    switch (precision)
+    {
+        case HALF_PRECISION:
+            convertRow(realHalf[u], re, n);
+            convertRow(imagHalf[u], im, n);
+            break;
+        case SINGLE_PRECISION:
+            convertRow(real[u], re, n);
+            convertRow(imag[u], im, n);
+            break;
+        case DOUBLE_PRECISION:
+            convertRow(realDouble[u], re, n);
+            convertRow(imagDouble[u], im, n);
+            break;
+    }
+}
+
+/***************************************************************************//**
+ * toSingle
+ * Author - Dan Andrus
+ *
+ * Copies the whole spectrum, or the luminance of a color spectrum, into
+ * single precision planes.
+ ******************************************************************************/
+void Spectrum::toSingle(Buffer2D<float>& re, Buffer2D<float>& im) const
+{
+    re.resize(rows, halfSpectrumCols(cols));
+    im.resize(rows, halfSpectrumCols(cols));
+    for (int u = 0; u < rows; u++)
+        readRow(u, re[u], im[u]);
+}
+
+/***************************************************************************//**
+ * bytes
+ * Author - Dan Andrus
+ *
+ * Returns the memory held by the planes.
+ ******************************************************************************/
+size_t Spectrum::bytes() const
+{
+    return real.bytes() + imag.bytes() + realDouble.bytes() + imagDouble.bytes()
+           + realHalf.bytes() + imagHalf.bytes();
+}
+
+/***************************************************************************//**
+ * release
+ * Author - Dan Andrus
+ *
+ * Frees the planes, keeping the precision and dimensions.
+ ******************************************************************************/
+void Spectrum::release()
+{
+    real.release();
+    imag.release();
+    realDouble.release();
+    imagDouble.release();
+    realHalf.release();
+    imagHalf.release();
+}
@@ -0,0 +1,81 @@
+/***************************************************************************//**
+ * Spectrum.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 23, 2015
+ *
+ * Details - Contains the Spectrum class, the half spectrum of an image stored
+ *           in half, single or double precision.
+ ******************************************************************************/
+#pragma once
+#include <cstddef>
+#include <functional>
+#include "Buffer2D.h"
+#include "Precision.h"
+#include "Transfer.h"
+
+// A change to a spectrum other than a transfer function, made to single
+// precision planes
+typedef std::function<void(Buffer2D<float>& real, Buffer2D<float>& imag,
+                           int cols)> SpectrumEdit;
+
+// Most channels a spectrum can hold, and the weights of the red, green and
+// blue channels in the luminance of a color spectrum (ITU-R BT.601)
+static const int MAX_SPECTRUM_CHANNELS = 3;
+static const float LUMINANCE_WEIGHTS[MAX_SPECTRUM_CHANNELS] = { 0.299f, 0.587f, 0.114f };
+
+/***************************************************************************//**
+ * Spectrum
+ *
+ * Author - Dan Andrus
+ *
+ * The half spectrum of a rows x cols image, as left by realFFT2D. Only the
+ * pair of planes matching precision is used; the others stay empty. Single
+ * precision spectra are in real and imag, which is what most code reads
+ * directly.
+ *
+ * The transforms of a double precision spectrum are done in double, and
+ * transfer functions multiply it in double. A half precision spectrum is
+ * transformed in float and rounded to half for storage, and is converted to
+ * float a piece at a time whenever it is worked on. Edits always work on
+ * single precision planes, so an edit to a spectrum of another precision
+ * converts it to float and back.
+ *
+ * A color spectrum has three channels, red, green and blue, whose half
+ * spectra are stacked one above the other in each plane, channels * rows
+ * rows in all. They are transformed together and every transfer function
+ * multiplies all three by gains evaluated once, so a color image costs well
+ * under three times a gray one. Edits are made to each channel in turn.
+ * readRow and toSingle give the spectrum of the luminance, which is the same
+ * weighted sum of the channels' spectra as of the channels, so the display
+ * and anything that analyzes a spectrum see the image's intensities. Code
+ * that reads real and imag directly must check for a single channel.
+ ******************************************************************************/
+struct Spectrum
+{
+    Spectrum() : precision(SINGLE_PRECISION), rows(0), cols(0), channels(1) {}
+
+    void transform(const Buffer2D<float>& spatial);
+    void inverse(Buffer2D<float>& spatial);
+    void apply(const TransferFunction& transfer,
+               const TransferObserver& observer = TransferObserver());
+    void edit(const SpectrumEdit& change);
+
+    void readRow(int u, float* re, float* im) const;
+    void readChannelRow(int k, int u, float* re, float* im) const;
+    void toSingle(Buffer2D<float>& re, Buffer2D<float>& im) const;
+    size_t bytes() const;
+    void release();
+
+    Precision precision;
+    Buffer2D<float> real;
+    Buffer2D<float> imag;
+    Buffer2D<double> realDouble;
+    Buffer2D<double> imagDouble;
+    Buffer2D<half> realHalf;
+    Buffer2D<half> imagHalf;
+    int rows;
+    int cols;
+    int channels;
+};
@@ -0,0 +1,364 @@
+/***************************************************************************//**
+ * SpectrumCache.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 18, 2015
+ *
+ * Details - Defines the SpectrumCache class.
+ ******************************************************************************/
+#include "SpectrumCache.h"
+#include <cstdlib>
+
+SpectrumCache::SpectrumCache(size_t budget, Precision precision)
+    : storage(precision), limit(budget), resident(0), pinned(0), clock(0),
+      evicted(0)
+{
+}
+
+/***************************************************************************//**
+ * defaultBudget
+ * Author - Dan Andrus
+ *
+ * Returns the memory budget in bytes given by the PROG3_SPECTRUM_MB
+ * environment variable, or 1 GB if it is not set.
+ ******************************************************************************/
+size_t SpectrumCache::defaultBudget()
+{
+    const char* env = getenv("PROG3_SPECTRUM_MB");
+    long mb = (env != NULL) ? atol(env) : 0;
+
+    if (mb <= 0)
+        mb = 1024;
+    return (size_t) mb * 1024 * 1024;
+}
+
+/***************************************************************************//**
+ * defaultPrecision
+ * Author - Dan Andrus
+ *
+ * Returns the precision named by the PROG3_PRECISION environment variable,
+ * "half", "single" or "double", or single precision if it is not set.
+ ******************************************************************************/
+Precision SpectrumCache::defaultPrecision()
+{
+    const char* env = getenv("PROG3_PRECISION");
+    Precision precision = SINGLE_PRECISION;
+
+    if (env != NULL)
+        parsePrecision(env, precision);
+    return precision;
+}
+
+/***************************************************************************//**
+ * setBudget
+ * Author - Dan Andrus
+ *
+ * Changes the memory budget, releasing spectra right away if they no longer
+ * fit.
+ ******************************************************************************/
+void SpectrumCache::setBudget(size_t bytes)
+{
+    limit = bytes;
+    trim(NULL);
+}
+
+/***************************************************************************//**
+ * setPrecision
+ * Author - Dan Andrus
+ *
+ * Changes the precision spectra are kept in. Every spectrum is released so
+ * that it is rebuilt in the new precision, from its image and its history,
+ * the next time it is asked for.
+ ******************************************************************************/
+void SpectrumCache::setPrecision(Precision precision)
+{
+    if (precision == storage)
+        return;
+
+    storage = precision;
+    for (std::map<Key, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+        release(it->second);
+}
+
+/***************************************************************************//**
+ * insert
+ * Author - Dan Andrus
+ *
+ * Adds an image to the cache and computes its spectrum. An entry already
+ * stored under the key is replaced.
+ *
+ * Parameters -
+ *          key - identifies the entry
+ *          rows, cols - the dimensions of the image
+ *          loader - fills a buffer with the intensities of the image, or its
+ *                   channels stacked one above the other; kept to rebuild
+ *                   the spectrum if it is ever released
+ *          channels - 1 for a gray image, 3 for a color one (see Spectrum)
+ ******************************************************************************/
+void SpectrumCache::insert(Key key, int rows, int cols, const Loader& loader,
+                           int channels)
+{
+    remove(key);
+
+    Entry& entry = entries[key];
+    entry.data.rows = rows;
+    entry.data.cols = cols;
+    entry.data.channels = channels;
+    entry.loader = loader;
+    entry.lastUse = ++clock;
+    entry.counted = 0;
+    entry.kept = 0;
+    entry.loaded = false;
+
+    try
+    {
+        load(entry);
+    }
+    catch (...)
+    {
+        entries.erase(key);
+        throw;
+    }
+    trim(key);
+}
+
+/***************************************************************************//**
+ * setKeptBytes
+ * Author - Dan Andrus
+ *
+ * Sets the memory the caller keeps for an entry, outside the cache, to count
+ * against the budget, releasing other spectra right away if they no longer
+ * fit. Does nothing if there is no such entry.
+ ******************************************************************************/
+void SpectrumCache::setKeptBytes(Key key, size_t bytes)
+{
+    std::map<Key, Entry>::iterator it = entries.find(key);
+
+    if (it == entries.end())
+        return;
+
+    pinned = pinned - it->second.kept + bytes;
+    it->second.kept = bytes;
+    trim(key);
+}
+
+/***************************************************************************//**
+ * remove
+ * Author - Dan Andrus
+ *
+ * Drops an entry and its history. Does nothing if there is no such entry.
+ ******************************************************************************/
+void SpectrumCache::remove(Key key)
+{
+    std::map<Key, Entry>::iterator it = entries.find(key);
+
+    if (it != entries.end())
+    {
+        release(it->second);
+        pinned -= it->second.kept;
+        entries.erase(it);
+    }
+}
+
+/***************************************************************************//**
+ * discard
+ * Author - Dan Andrus
+ *
+ * Releases the spectrum of an entry but keeps its history, so the spectrum is
+ * rebuilt the next time it is asked for. Used when the spectrum has been
+ * changed in place by something other than the cache.
+ ******************************************************************************/
+void SpectrumCache::discard(Key key)
+{
+    std::map<Key, Entry>::iterator it = entries.find(key);
+
+    if (it != entries.end())
+        release(it->second);
+}
+
+/***************************************************************************//**
+ * spectrum
+ * Author - Dan Andrus
+ *
+ * Returns the spectrum of an entry, rebuilding it first if it was released.
+ * The entry becomes the most recently used one. The reference stays valid
+ * until the next call into the cache.
+ ******************************************************************************/
+Spectrum& SpectrumCache::spectrum(Key key)
+{
+    Entry& entry = entries.at(key);
+
+    entry.lastUse = ++clock;
+    if (!entry.loaded)
+    {
+        load(entry);
+        trim(key);
+    }
+    return entry.data;
+}
+
+/***************************************************************************//**
+ * applyTransfer
+ * Author - Dan Andrus
+ *
+ * Multiplies the spectrum of an entry by a transfer function and records it.
+ ******************************************************************************/
+void SpectrumCache::applyTransfer(Key key,
+                                  const std::shared_ptr<const TransferFunction>& transfer,
+                                  const TransferObserver& observer)
+{
+    Spectrum& data = spectrum(key);
+    Operation op;
+
+    try
+    {
+        data.apply(*transfer, observer);
+    }
+    catch (...)
+    {
+        discard(key);
+        throw;
+    }
+
+    op.transfer = transfer;
+    entries.at(key).history.push_back(op);
+}
+
+/***************************************************************************//**
+ * applyEdit
+ * Author - Dan Andrus
+ *
+ * Runs an arbitrary change on the spectrum of an entry and records it. The
+ * edit must give the same result every time it runs, since it is run again
+ * whenever the spectrum is rebuilt.
+ ******************************************************************************/
+void SpectrumCache::applyEdit(Key key, const Edit& edit)
+{
+    Spectrum& data = spectrum(key);
+    Operation op;
+
+    try
+    {
+        data.edit(edit);
+    }
+    catch (...)
+    {
+        discard(key);
+        throw;
+    }
+
+    op.edit = edit;
+    entries.at(key).history.push_back(op);
+}
+
+/***************************************************************************//**
+ * load
+ * Author - Dan Andrus
+ *
+ * Builds the spectrum of an entry from its image and replays its history.
+ ******************************************************************************/
+void SpectrumCache::load(Entry& entry)
+{
+    Buffer2D<float> spatial(entry.data.rows * entry.data.channels, entry.data.cols);
+    Spectrum& data = entry.data;
+
+    data.precision = storage;
+    try
+    {
+        replay(entry, spatial);
+    }
+    catch (...)
+    {
+        data.release();
+        throw;
+    }
+
+    entry.loaded = true;
+    entry.counted = data.bytes();
+    resident += entry.counted;
+}
+
+/***************************************************************************//**
+ * replay
+ * Author - Dan Andrus
+ *
+ * Fills in the spectrum of an entry for load().
+ ******************************************************************************/
+void SpectrumCache::replay(Entry& entry, Buffer2D<float>& spatial)
+{
+    Spectrum& data = entry.data;
+    TransferChain chain;
+
+    entry.loader(spatial);
+    data.transform(spatial);
+    spatial.release();
+
+    for (size_t i = 0; i < entry.history.size(); i++)
+    {
+        const Operation& op = entry.history[i];
+
+        if (op.transfer)
+        {
+            chain.add(op.transfer);
+            continue;
+        }
+
+        if (!chain.empty())
+        {
+            data.apply(chain);
+            chain.clear();
+        }
+        data.edit(op.edit);
+    }
+    if (!chain.empty())
+        data.apply(chain);
+}
+
+/***************************************************************************//**
+ * release
+ * Author - Dan Andrus
+ *
+ * Frees the spectrum of an entry, keeping what is needed to rebuild it.
+ ******************************************************************************/
+void SpectrumCache::release(Entry& entry)
+{
+    if (!entry.loaded)
+        return;
+
+    // Subtract what load() added: an inverse transform in place can change
+    // the planes a spectrum holds, and so its size, since then
+    resident -= entry.counted;
+    entry.counted = 0;
+    entry.data.release();
+    entry.loaded = false;
+}
+
+/***************************************************************************//**
+ * trim
+ * Author - Dan Andrus
+ *
+ * Releases the least recently used spectra, other than the one under keep,
+ * until the rest fit in the budget along with the kept bytes.
+ ******************************************************************************/
+void SpectrumCache::trim(Key keep)
+{
+    while (resident + pinned > limit)
+    {
+        Entry* oldest = NULL;
+
+        for (std::map<Key, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+        {
+            Entry& entry = it->second;
+            if (entry.loaded && it->first != keep
+                && (oldest == NULL || entry.lastUse < oldest->lastUse))
+                oldest = &entry;
+        }
+
+        if (oldest == NULL)
+            return;
+
+        release(*oldest);
+        evicted++;
+    }
+}
@@ -0,0 +1,120 @@
+/***************************************************************************//**
+ * SpectrumCache.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 18, 2015
+ *
+ * Details - Contains the SpectrumCache class, which holds the frequency data
+ *           of any number of images within a memory budget. Spectra that do
+ *           not fit are dropped and rebuilt from their image when needed.
+ ******************************************************************************/
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include "Buffer2D.h"
+#include "Spectrum.h"
+#include "Transfer.h"
+
+/***************************************************************************//**
+ * SpectrumCache
+ *
+ * Author - Dan Andrus
+ *
+ * Maps a key, normally the address of the image an entry belongs to, to the
+ * half spectrum of that image. Every change made through the cache, either a
+ * transfer function or an arbitrary edit, is recorded along with the entry.
+ *
+ * When the spectra held in memory exceed the budget, the least recently used
+ * ones are released. The next time one of them is asked for, its image is
+ * read again through the loader given to insert(), transformed, and the
+ * recorded changes are replayed, so the caller never sees the difference
+ * except in time. Consecutive transfer functions are replayed as a single
+ * TransferChain.
+ *
+ * The entry being asked for is never released, so a single spectrum larger
+ * than the budget still works. The cache is not thread-safe.
+ *
+ * Memory the caller keeps for an entry and cannot rebuild, such as the image
+ * its spectrum is read from, can be counted against the budget with
+ * setKeptBytes(). It is never released, but leaves that much less of the
+ * budget for spectra.
+ *
+ * Spectra are built in the cache's precision. Changing it releases every
+ * spectrum, and each is rebuilt in the new precision when next asked for.
+ * Budgets are in bytes, so half precision fits twice as many spectra as
+ * single and double half as many.
+ *
+ * If a change throws part way through, for instance because its Job was
+ * cancelled, the half-changed spectrum is released and the change is not
+ * recorded, so the entry is rebuilt as it was before the change.
+ ******************************************************************************/
+class SpectrumCache
+{
+  public:
+    typedef const void* Key;
+    typedef std::function<void(Buffer2D<float>& spatial)> Loader;
+    typedef SpectrumEdit Edit;
+
+    explicit SpectrumCache(size_t budget, Precision precision = SINGLE_PRECISION);
+
+    static size_t defaultBudget();
+    static Precision defaultPrecision();
+
+    void setBudget(size_t bytes);
+    size_t budget() const { return limit; }
+    void setPrecision(Precision precision);
+    Precision precision() const { return storage; }
+    size_t residentBytes() const { return resident; }
+    size_t keptBytes() const { return pinned; }
+    int size() const { return (int) entries.size(); }
+    int evictions() const { return evicted; }
+
+    void insert(Key key, int rows, int cols, const Loader& loader, int channels = 1);
+    bool contains(Key key) const { return entries.count(key) > 0; }
+    void setKeptBytes(Key key, size_t bytes);
+    void remove(Key key);
+    void discard(Key key);
+
+    Spectrum& spectrum(Key key);
+    void applyTransfer(Key key, const std::shared_ptr<const TransferFunction>& transfer,
+                       const TransferObserver& observer = TransferObserver());
+    void applyEdit(Key key, const Edit& edit);
+
+  private:
+    struct Operation
+    {
+        std::shared_ptr<const TransferFunction> transfer;
+        Edit edit;
+    };
+
+    struct Entry
+    {
+        Spectrum data;
+        Loader loader;
+        std::vector<Operation> history;
+        unsigned long long lastUse;
+        size_t counted;             // bytes added to resident when loaded
+        size_t kept;                // bytes the caller keeps for the entry
+        bool loaded;
+    };
+
+    void load(Entry& entry);
+    void replay(Entry& entry, Buffer2D<float>& spatial);
+    void release(Entry& entry);
+    void trim(Key keep);
+
+    std::map<Key, Entry> entries;
+    Precision storage;
+    size_t limit;
+    size_t resident;
+    size_t pinned;                  // sum of the entries' kept bytes
+    unsigned long long clock;
+    int evicted;
+
+    SpectrumCache(const SpectrumCache&);
+    SpectrumCache& operator=(const SpectrumCache&);
+};
@@ -0,0 +1,259 @@
+/***************************************************************************//**
+ * SpectrumRenderer.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 30, 2015
+ *
+ * Details - Defines the SpectrumRenderer class.
+ ******************************************************************************/
+#include "SpectrumRenderer.h"
+#include "FFT.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <mutex>
+
+/***************************************************************************//**
+ * magnitudeRow
+ * Author - Dan Andrus
+ *
+ * Writes scale * sqrt(re^2 + im^2) of n bins to out, all three rows aligned,
+ * and returns the largest value written.
+ ******************************************************************************/
+static float magnitudeRow(const float* re, const float* im, float* out, int n,
+                          float scale)
+{
+    vfloat most(0.0f);
+    float largest = 0.0f;
+    int v = 0;
+
+    for (; v + VFLOAT_WIDTH <= n; v += VFLOAT_WIDTH)
+    {
+        vfloat a = vload<vfloat>(re + v);
+        vfloat b = vload<vfloat>(im + v);
+        vfloat m = vsqrt(a * a + b * b) * vfloat(scale);
+        vstore(out + v, m);
+        most = vmax(most, m);
+    }
+    for (; v < n; v++)
+    {
+        out[v] = std::sqrt(re[v] * re[v] + im[v] * im[v]) * scale;
+        largest = std::max(largest, out[v]);
+    }
+
+    alignas(BUFFER2D_ALIGNMENT) float lanes[VFLOAT_WIDTH];
+    vstore(lanes, most);
+    for (int i = 0; i < VFLOAT_WIDTH; i++)
+        largest = std::max(largest, lanes[i]);
+    return largest;
+}
+
+/***************************************************************************//**
+ * render
+ * Author - Dan Andrus
+ *
+ * Reads the magnitudes of a spectrum, takes the log of the largest as the
+ * normalization range and draws the whole picture.
+ ******************************************************************************/
+void SpectrumRenderer::render(const Spectrum& spectrum)
+{
+    float largest = load(spectrum);
+
+    range = std::log(1.0f + largest);
+    if (range <= 0)
+        range = 1;
+    factor = 255.0f / range;
+    drawAll();
+}
+
+/***************************************************************************//**
+ * reload
+ * Author - Dan Andrus
+ *
+ * Reads the magnitudes of a spectrum that has changed and draws the whole
+ * picture with the normalization range of the last render(), which is done
+ * instead if there was none.
+ ******************************************************************************/
+void SpectrumRenderer::reload(const Spectrum& spectrum)
+{
+    if (range <= 0 || spectrum.rows != nrows || spectrum.cols != ncols)
+    {
+        render(spectrum);
+        return;
+    }
+    load(spectrum);
+    drawAll();
+}
+
+/***************************************************************************//**
+ * scaleSpan
+ * Author - Dan Andrus
+ *
+ * Multiplies the magnitudes of columns first to end - 1 of row u of the half
+ * spectrum by the size of their gains and redraws those bins and their
+ * mirrors. first must be a multiple of VFLOAT_WIDTH, as evaluateSpan and
+ * changedSpan leave it.
+ *
+ * Parameters -
+ *          u - the row of the half spectrum
+ *          h - the gains of the row, indexed by column
+ *          first - the first column to update
+ *          end - one past the last column to update
+ ******************************************************************************/
+void SpectrumRenderer::scaleSpan(int u, const float* h, int first, int end)
+{
+    float* m = magnitude[u];
+    int v = first;
+
+    for (; v + VFLOAT_WIDTH <= end; v += VFLOAT_WIDTH)
+    {
+        vfloat gain = vload<vfloat>(h + v);
+        gain = vmax(gain, vfloat(0.0f) - gain);
+        vstore(m + v, vload<vfloat>(m + v) * gain);
+    }
+    for (; v < end; v++)
+        m[v] *= std::fabs(h[v]);
+
+    drawRow(u, first, end);
+}
+
+/***************************************************************************//**
+ * changedSpan
+ * Author - Dan Andrus
+ *
+ * Finds the columns of a row of gains that are not 1, as evaluateSpan would
+ * report them, for gains evaluated a whole row at a time.
+ *
+ * Parameters -
+ *          h - n gains
+ *          first - set to the first column whose gain is not 1, rounded down
+ *                  to a multiple of VFLOAT_WIDTH
+ *          end - set to one past the last column whose gain is not 1
+ *
+ * Returns
+ *          false if every gain is 1
+ ******************************************************************************/
+bool SpectrumRenderer::changedSpan(const float* h, int n, int& first, int& end)
+{
+    first = 0;
+    while (first < n && h[first] == 1.0f)
+        first++;
+    if (first == n)
+        return false;
+
+    end = n;
+    while (h[end - 1] == 1.0f)
+        end--;
+    first -= first % VFLOAT_WIDTH;
+    return true;
+}
+
+/***************************************************************************//**
+ * load
+ * Author - Dan Andrus
+ *
+ * Fills the magnitudes from a spectrum, reading single precision gray
+ * spectra in place and the others a row at a time through readRow, which
+ * gives the luminance of a color spectrum. Rows are split across the global
+ * thread pool.
+ *
+ * Returns
+ *          the largest magnitude
+ ******************************************************************************/
+float SpectrumRenderer::load(const Spectrum& spectrum)
+{
+    bool single = (spectrum.precision == SINGLE_PRECISION && spectrum.channels == 1);
+    float scale = (float) spectrum.rows * spectrum.cols;   // undo forward normalization
+    int n = halfSpectrumCols(spectrum.cols);
+    std::mutex guard;
+    float largest = 0.0f;
+
+    nrows = spectrum.rows;
+    ncols = spectrum.cols;
+    magnitude.resize(nrows, n);
+    display.resize(nrows, ncols);
+
+    ThreadPool::global().parallelFor(nrows, [&](int begin, int end)
+    {
+        Buffer2D<float> line;
+        float most = 0.0f;
+
+        if (!single)
+            line.resize(2, n);
+        for (int u = begin; u < end; u++)
+        {
+            const float* re = single ? spectrum.real[u] : line[0];
+            const float* im = single ? spectrum.imag[u] : line[1];
+            if (!single)
+                spectrum.readRow(u, line[0], line[1]);
+            most = std::max(most, magnitudeRow(re, im, magnitude[u], n, scale));
+        }
+
+        std::lock_guard<std::mutex> lock(guard);
+        largest = std::max(largest, most);
+    });
+
+    return largest;
+}
+
+/***************************************************************************//**
+ * drawRow
+ * Author - Dan Andrus
+ *
+ * Draws columns first to end - 1 of row u of the half spectrum, and their
+ * mirrors, as 255 * log(1 + magnitude) / range, at most 255.
+ ******************************************************************************/
+void SpectrumRenderer::drawRow(int u, int first, int end)
+{
+    const FrequencyGeometry& geom = geometry();
+    const float* m = magnitude[u];
+    unsigned char* row = display[geom.displayRow[u]];
+    unsigned char* mirror = display[geom.displayRow[(nrows - u) % nrows]];
+    alignas(BUFFER2D_ALIGNMENT) float levels[VFLOAT_WIDTH];
+    int v = first;
+
+    while (v < end)
+    {
+        int count = std::min(end - v, VFLOAT_WIDTH);
+
+        if (count == VFLOAT_WIDTH)
+        {
+            vfloat level = vlog(vload<vfloat>(m + v) + vfloat(1.0f)) * vfloat(factor);
+            vstore(levels, vmin(level, vfloat(255.0f)));
+        }
+        else
+        {
+            for (int i = 0; i < count; i++)
+                levels[i] = std::min(std::log(m[v + i] + 1.0f) * factor, 255.0f);
+        }
+
+        for (int i = 0; i < count; i++, v++)
+        {
+            unsigned char value = (unsigned char) levels[i];
+            row[geom.displayCol[v]] = value;
+
+            // Columns 0 and cols/2 are stored for every row, mirrors included
+            if (v > 0 && 2 * v != ncols)
+                mirror[geom.displayCol[ncols - v]] = value;
+        }
+    }
+}
+
+/***************************************************************************//**
+ * drawAll
+ * Author - Dan Andrus
+ *
+ * Draws every bin, rows split across the global thread pool. A row and its
+ * mirror are drawn by the same call, and each display row is the stored row
+ * of some u and the mirror of another, which write different columns, so
+ * rows drawn at once never write the same pixel.
+ ******************************************************************************/
+void SpectrumRenderer::drawAll()
+{
+    ThreadPool::global().parallelFor(nrows, [&](int begin, int end)
+    {
+        for (int u = begin; u < end; u++)
+            drawRow(u, 0, magnitude.cols());
+    });
+}
@@ -0,0 +1,74 @@
+/***************************************************************************//**
+ * SpectrumRenderer.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 30, 2015
+ *
+ * Details - Contains the SpectrumRenderer class, which turns a half spectrum
+ *           into the 8-bit, log-scaled picture shown in the frequency view
+ *           and keeps it up to date as filters are applied.
+ ******************************************************************************/
+#pragma once
+#include "Buffer2D.h"
+#include "FrequencyGeometry.h"
+#include "Spectrum.h"
+
+/***************************************************************************//**
+ * SpectrumRenderer
+ *
+ * Author - Dan Andrus
+ *
+ * Keeps the magnitude scale * |F| of every stored bin of a spectrum, where
+ * scale undoes the forward transform's 1/N, and an 8-bit picture of
+ * log(1 + scale * |F|) the size of the full spectrum, with the zero
+ * frequency at its center and each stored bin drawn along with its mirror.
+ *
+ * render() reads the spectrum once, a row at a time in whatever precision
+ * it is kept, finding the magnitudes and the largest of them together. The
+ * logarithm is monotonic, so the largest level is the log of the largest
+ * magnitude and only one logarithm per bin is needed, taken with vlog while
+ * drawing. The largest level is kept as the normalization range: it maps to
+ * 255, and stays the same until render() is called again, so the picture
+ * keeps one brightness scale while it is updated.
+ *
+ * A transfer function scales each bin's magnitude by its gain, so
+ * scaleSpan() updates a span of a row from its gains alone, without reading
+ * the spectrum, and redraws only those bins and their mirrors. Levels that a
+ * gain above 1 takes over the range are drawn as 255. After a change to the
+ * spectrum that is not a transfer function, reload() reads the magnitudes
+ * again and redraws the picture with the range kept.
+ ******************************************************************************/
+class SpectrumRenderer
+{
+  public:
+    SpectrumRenderer() : nrows(0), ncols(0), range(0), factor(0) {}
+
+    void render(const Spectrum& spectrum);
+    void reload(const Spectrum& spectrum);
+    void scaleSpan(int u, const float* h, int first, int end);
+
+    static bool changedSpan(const float* h, int n, int& first, int& end);
+
+    bool empty() const { return magnitude.empty(); }
+    int rows() const { return nrows; }
+    int cols() const { return ncols; }
+    float largestLevel() const { return range; }
+    const Buffer2D<unsigned char>& pixels() const { return display; }
+    const FrequencyGeometry& geometry() const
+    {
+        return FrequencyGeometry::get(nrows, ncols);
+    }
+
+  private:
+    float load(const Spectrum& spectrum);
+    void drawRow(int u, int first, int end);
+    void drawAll();
+
+    Buffer2D<float> magnitude;      // scale * |F| of the stored half
+    Buffer2D<unsigned char> display;
+    int nrows;
+    int ncols;
+    float range;                    // largest level, drawn as 255
+    float factor;                   // 255 / range
+};
@@ -0,0 +1,190 @@
+/***************************************************************************//**
+ * StackFilter.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 28, 2015
+ *
+ * Details - Defines the StackFilter class.
+ ******************************************************************************/
+#include "StackFilter.h"
+#include "FFT.h"
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <thread>
+
+StackFilter::StackFilter(const TransferFunction& transfer, int rows, int cols,
+                         int depth)
+    : transfer(transfer), rows(rows), cols(cols), frames(std::max(1, depth))
+{
+}
+
+/***************************************************************************//**
+ * view
+ * Author - Dan Andrus
+ *
+ * Makes part use the first count rows of whole, without copying them. part
+ * must not outlive whole.
+ ******************************************************************************/
+template <typename T>
+static void view(Buffer2D<T>& whole, int count, Buffer2D<T>& part)
+{
+    part.adopt(whole.data(), count, whole.cols(),
+               std::shared_ptr<void>(whole.data(), [](void*) {}));
+}
+
+/***************************************************************************//**
+ * StackFilter::filter
+ * Author - Dan Andrus
+ *
+ * Filters the first count frames of a stack in place, using the spectrum
+ * planes given, which are large enough for a whole stack.
+ ******************************************************************************/
+void StackFilter::filter(Buffer2D<float>& stack, Buffer2D<float>& real,
+                         Buffer2D<float>& imag, int count) const
+{
+    Buffer2D<float> spatial;
+    Buffer2D<float> re;
+    Buffer2D<float> im;
+
+    view(stack, count * rows, spatial);
+    view(real, count * rows, re);
+    view(imag, count * rows, im);
+
+    realFFT2D(spatial, re, im, count);
+    applyTransfer(transfer, re, im, cols, TransferObserver(), count);
+    inverseRealFFT2D(re, im, spatial, cols, count);
+}
+
+/***************************************************************************//**
+ * StackFilter::run
+ * Author - Dan Andrus
+ *
+ * Filters every frame the reader gives, as described for the class, and
+ * passes each one to the writer once it is filtered. If the reader, the
+ * writer or the filtering throws, the exception is passed on once the second
+ * thread has finished what it was doing; frames not yet written are lost.
+ *
+ * Parameters -
+ *          read - fills the rows x cols frame numbered index, counting from
+ *                 0, and returns true, or returns false at the end of the
+ *                 stream
+ *          write - takes the filtered frame numbered index
+ *
+ * Returns
+ *          the number of frames filtered
+ ******************************************************************************/
+int StackFilter::run(const FrameReader& read, const FrameWriter& write) const
+{
+    Buffer2D<float> stacks[2];
+    Buffer2D<float> real(frames * rows, halfSpectrumCols(cols));
+    Buffer2D<float> imag(frames * rows, halfSpectrumCols(cols));
+    int counts[2] = { 0, 0 };
+    int firsts[2] = { 0, 0 };
+    int next = 0;
+    int done = 0;
+
+    stacks[0].resize(frames * rows, cols);
+    stacks[1].resize(frames * rows, cols);
+
+    auto fill = [&](int s)
+    {
+        firsts[s] = next;
+        counts[s] = 0;
+        while (counts[s] < frames
+               && read(next, stacks[s].rowPointers() + counts[s] * rows))
+        {
+            counts[s]++;
+            next++;
+        }
+    };
+
+    auto drain = [&](int s)
+    {
+        for (int k = 0; k < counts[s]; k++)
+            write(firsts[s] + k, stacks[s].rowPointers() + k * rows);
+        counts[s] = 0;
+    };
+
+    fill(0);
+    int current = 0;
+    while (counts[current] > 0)
+    {
+        int other = 1 - current;
+        std::exception_ptr error;
+
+        // Write out the last stack and read the next one while this one is
+        // filtered
+        std::thread io([&]()
+        {
+            try
+            {
+                drain(other);
+                fill(other);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        });
+
+        try
+        {
+            filter(stacks[current], real, imag, counts[current]);
+        }
+        catch (...)
+        {
+            io.join();
+            throw;
+        }
+        io.join();
+        if (error)
+            std::rethrow_exception(error);
+
+        done += counts[current];
+        current = other;
+    }
+
+    drain(1 - current);
+    return done;
+}
+
+/***************************************************************************//**
+ * StackFilter::run
+ * Author - Dan Andrus
+ *
+ * Filters frames already in memory, each rows x cols, in place.
+ ******************************************************************************/
+void StackFilter::run(std::vector<Buffer2D<float> >& images) const
+{
+    run([&](int index, float* const* out)
+        {
+            if (index >= (int) images.size())
+                return false;
+            for (int r = 0; r < rows; r++)
+                std::copy(images[index][r], images[index][r] + cols, out[r]);
+            return true;
+        },
+        [&](int index, const float* const* in)
+        {
+            for (int r = 0; r < rows; r++)
+                std::copy(in[r], in[r] + cols, images[index][r]);
+        });
+}
+
+/***************************************************************************//**
+ * StackFilter::peakBytes
+ * Author - Dan Andrus
+ *
+ * Returns the memory run() allocates: two stacks of depth frames and the
+ * half spectrum planes of one.
+ ******************************************************************************/
+size_t StackFilter::peakBytes() const
+{
+    size_t stack = (size_t) frames * rows * Buffer2D<float>::pitchFor(cols);
+    size_t spectrum = (size_t) frames * rows
+                      * Buffer2D<float>::pitchFor(halfSpectrumCols(cols));
+
+    return (2 * stack + 2 * spectrum) * sizeof(float);
+}
@@ -0,0 +1,76 @@
+/***************************************************************************//**
+ * StackFilter.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 28, 2015
+ *
+ * Details - Contains the StackFilter class, which applies one transfer
+ *           function to a stream of same-sized frames, such as the frames of
+ *           a video clip, several frames at a time.
+ ******************************************************************************/
+#pragma once
+#include <functional>
+#include <vector>
+#include "Buffer2D.h"
+#include "Transfer.h"
+
+/***************************************************************************//**
+ * StackFilter
+ *
+ * Author - Dan Andrus
+ *
+ * Runs fft, a transfer function and ifft on every frame of a stream of
+ * frames of the same size, giving the same result as filtering each one on
+ * its own.
+ *
+ * Frames are taken depth at a time and stacked one above the other, and
+ * each stack goes through realFFT2D, applyTransfer and inverseRealFFT2D as
+ * one batch: the frames share the plans and the gains of the transfer
+ * function, evaluated once per row for the whole stack, and each pass over
+ * the stack is a single split across the global thread pool. Small frames,
+ * whose own transforms are too short to keep many threads busy, keep them
+ * all busy this way.
+ *
+ * Two stacks are used in turn. While one is filtered, a second thread hands
+ * the frames of the other, filtered last time, to the writer and fills it
+ * with the next frames from the reader, so reading and writing overlap the
+ * transforms. The stacks and the spectrum planes are allocated once, when
+ * run() starts, and reused for every batch, so the memory used is about
+ * peakBytes() however long the stream.
+ *
+ * The reader and writer are given the rows of a frame inside a stack, to
+ * fill or to read, so frames are not copied on the way in or out. They are
+ * called in frame order and never at the same time as each other, but not
+ * always from the same thread: the first stack is filled and the last one
+ * written out on the thread that called run(), and the others on the second
+ * thread.
+ ******************************************************************************/
+class StackFilter
+{
+  public:
+    static const int DEFAULT_DEPTH = 8;
+
+    // Fills the rows of frame index; returns false once there are no more
+    typedef std::function<bool(int index, float* const* rows)> FrameReader;
+    // Takes the filtered rows of frame index
+    typedef std::function<void(int index, const float* const* rows)> FrameWriter;
+
+    StackFilter(const TransferFunction& transfer, int rows, int cols,
+                int depth = DEFAULT_DEPTH);
+
+    int run(const FrameReader& read, const FrameWriter& write) const;
+    void run(std::vector<Buffer2D<float> >& images) const;
+
+    int depth() const { return frames; }
+    size_t peakBytes() const;
+
+  private:
+    void filter(Buffer2D<float>& stack, Buffer2D<float>& real,
+                Buffer2D<float>& imag, int count) const;
+
+    const TransferFunction& transfer;
+    int rows;
+    int cols;
+    int frames;
+};
@@ -0,0 +1,268 @@
+/***************************************************************************//**
+ * ThreadPool.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 14, 2015
+ *
+ * Details - Defines the ThreadPool class.
+ ******************************************************************************/
+#include "ThreadPool.h"
+#include "Job.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Number of pieces a loop is cut into per thread. More pieces than threads
+// lets a thread that finishes early take work from one that is slowed down.
+static const int CHUNKS_PER_THREAD = 4;
+
+// Number of pieces a loop with a Job is cut into when it runs inline, so the
+// job still sees progress and can be cancelled part way through
+static const int JOB_CHUNKS = 32;
+
+// Set on worker threads, and on a calling thread while it runs a loop, so
+// that nested loops run inline instead of waiting on the pool they are in
+static thread_local bool T_Inside_Loop = false;
+
+/***************************************************************************//**
+ * ThreadPool
+ * Author - Dan Andrus
+ *
+ * Starts threads - 1 worker threads.
+ ******************************************************************************/
+ThreadPool::ThreadPool(int threads)
+    : body(NULL), count(0), chunks(0), nextChunk(0), pending(0), generation(0),
+      stopping(false)
+{
+    start(threads);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+/***************************************************************************//**
+ * global
+ * Author - Dan Andrus
+ *
+ * Returns the pool shared by the whole program. It is created on first use
+ * with defaultThreadCount() threads; main() calls this at startup so the
+ * threads exist before the first transform.
+ ******************************************************************************/
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool(defaultThreadCount());
+    return pool;
+}
+
+/***************************************************************************//**
+ * defaultThreadCount
+ * Author - Dan Andrus
+ *
+ * Returns the thread count given by the PROG3_THREADS environment variable,
+ * or the number of hardware threads if it is not set.
+ ******************************************************************************/
+int ThreadPool::defaultThreadCount()
+{
+    const char* env = getenv("PROG3_THREADS");
+    int threads = (env != NULL) ? atoi(env) : 0;
+
+    if (threads <= 0)
+        threads = (int) std::thread::hardware_concurrency();
+    return (threads > 0) ? threads : 1;
+}
+
+int ThreadPool::size() const
+{
+    return (int) workers.size() + 1;
+}
+
+/***************************************************************************//**
+ * resize
+ * Author - Dan Andrus
+ *
+ * Replaces the worker threads with a new set. Waits for a running loop to
+ * finish first.
+ ******************************************************************************/
+void ThreadPool::resize(int threads)
+{
+    std::lock_guard<std::mutex> loop(loopMutex);
+
+    stop();
+    start(threads);
+}
+
+/***************************************************************************//**
+ * parallelFor
+ * Author - Dan Andrus
+ *
+ * Calls body on consecutive ranges [begin, end) covering 0 to count, spread
+ * over the threads of the pool, and returns once every range is done. If body
+ * throws, the remaining ranges are skipped and the first exception is
+ * rethrown on the calling thread.
+ *
+ * Parameters -
+ *          count - the number of loop iterations
+ *          body - called with each range of iterations
+ ******************************************************************************/
+void ThreadPool::parallelFor(int count, const RangeFunction& body)
+{
+    Job* job = T_Inside_Loop ? NULL : Job::current();
+
+    if (job == NULL || count <= 0)
+    {
+        run(count, body, 1);
+        return;
+    }
+
+    // Ranges run on worker threads, which have no job of their own, so the
+    // job is reached through the caller's pointer
+    job->beginLoop(count);
+    run(count, [&](int begin, int end)
+    {
+        job->check();
+        body(begin, end);
+        job->advance(end - begin);
+    }, JOB_CHUNKS);
+}
+
+/***************************************************************************//**
+ * run
+ * Author - Dan Andrus
+ *
+ * Runs a loop for parallelFor, on the pool if it is free and otherwise on
+ * the calling thread, in up to pieces consecutive calls to body.
+ ******************************************************************************/
+void ThreadPool::run(int count, const RangeFunction& body, int pieces)
+{
+    if (count <= 0)
+        return;
+
+    std::unique_lock<std::mutex> loop(loopMutex, std::try_to_lock);
+    if (!loop.owns_lock() || workers.empty() || count == 1 || T_Inside_Loop)
+    {
+        pieces = std::min(count, pieces);
+        for (int k = 0; k < pieces; k++)
+            body((int) ((long long) count * k / pieces),
+                 (int) ((long long) count * (k + 1) / pieces));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        this->body = &body;
+        this->count = count;
+        chunks = std::min(count, size() * CHUNKS_PER_THREAD);
+        nextChunk = 0;
+        pending = (int) workers.size();
+        error = std::exception_ptr();
+        generation++;
+    }
+    wake.notify_all();
+
+    T_Inside_Loop = true;
+    runChunks();
+    T_Inside_Loop = false;
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+    finished.wait(lock, [this] { return pending == 0; });
+    this->body = NULL;
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/***************************************************************************//**
+ * start
+ * Author - Dan Andrus
+ *
+ * Creates the worker threads. The pool must not be running a loop.
+ ******************************************************************************/
+void ThreadPool::start(int threads)
+{
+    stopping = false;
+    for (int i = 1; i < threads; i++)
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this, generation));
+}
+
+/***************************************************************************//**
+ * stop
+ * Author - Dan Andrus
+ *
+ * Tells the worker threads to exit and waits for them.
+ ******************************************************************************/
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    workers.clear();
+}
+
+/***************************************************************************//**
+ * workerLoop
+ * Author - Dan Andrus
+ *
+ * Body of each worker thread: sleeps until a loop is started, helps run it,
+ * and reports back when there is nothing left to take. The generation the
+ * thread was created in is passed in rather than read here, since a thread
+ * that starts late must still take part in a loop begun before it ran.
+ ******************************************************************************/
+void ThreadPool::workerLoop(unsigned seen)
+{
+    T_Inside_Loop = true;
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+
+    for (;;)
+    {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping)
+            return;
+        seen = generation;
+
+        lock.unlock();
+        runChunks();
+        lock.lock();
+
+        if (--pending == 0)
+            finished.notify_one();
+    }
+}
+
+/***************************************************************************//**
+ * runChunks
+ * Author - Dan Andrus
+ *
+ * Takes chunks of the current loop until none are left.
+ ******************************************************************************/
+void ThreadPool::runChunks()
+{
+    for (;;)
+    {
+        int k = nextChunk++;
+        if (k >= chunks)
+            return;
+
+        int begin = (int) ((long long) count * k / chunks);
+        int end = (int) ((long long) count * (k + 1) / chunks);
+
+        try
+        {
+            (*body)(begin, end);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!error)
+                error = std::current_exception();
+            nextChunk = chunks;
+        }
+    }
+}
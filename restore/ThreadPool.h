@@ -0,0 +1,78 @@
+/***************************************************************************//**
+ * ThreadPool.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 14, 2015
+ *
+ * Details - Contains the ThreadPool class, a fixed set of worker threads that
+ *           split loops between them. The threads are created once and wait
+ *           for work, so starting a parallel loop costs a wake-up rather than
+ *           a thread creation.
+ ******************************************************************************/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***************************************************************************//**
+ * ThreadPool
+ *
+ * Author - Dan Andrus
+ *
+ * Runs parallel loops on a persistent set of threads. size() counts the
+ * calling thread, which always takes part in the loop, so a pool of size 1
+ * has no worker threads and runs everything inline.
+ *
+ * Only one loop runs on the pool at a time. A loop started while the pool is
+ * busy, including a loop started from inside another parallel loop, runs on
+ * the calling thread alone rather than waiting.
+ *
+ * A loop started by a thread with a Job installed reports each finished range
+ * to the job and stops early, throwing JobCancelled, once the job is
+ * cancelled. Nested loops are counted as part of the loop around them.
+ ******************************************************************************/
+class ThreadPool
+{
+  public:
+    typedef std::function<void(int begin, int end)> RangeFunction;
+
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    static ThreadPool& global();
+    static int defaultThreadCount();
+
+    int size() const;
+    void resize(int threads);
+    void parallelFor(int count, const RangeFunction& body);
+
+  private:
+    void start(int threads);
+    void stop();
+    void run(int count, const RangeFunction& body, int pieces);
+    void workerLoop(unsigned seen);
+    void runChunks();
+
+    std::vector<std::thread> workers;
+    std::mutex loopMutex;           // held while a loop runs on the pool
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+
+    const RangeFunction* body;
+    int count;
+    int chunks;
+    std::atomic<int> nextChunk;
+    int pending;                    // workers still busy with this loop
+    unsigned generation;            // bumped for every loop
+    std::exception_ptr error;       // first exception thrown by body
+    bool stopping;
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
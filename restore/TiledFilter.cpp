@@ -0,0 +1,309 @@
+/***************************************************************************//**
+ * TiledFilter.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 21, 2015
+ *
+ * Details - Defines the TiledFilter class.
+ ******************************************************************************/
+#include "TiledFilter.h"
+#include "FFT.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Smallest tile side, so a quarter of a tile still leaves room for a margin
+static const int MIN_TILE = 16;
+
+/***************************************************************************//**
+ * SampledTransfer
+ *
+ * Author - Dan Andrus
+ *
+ * Gains already worked out for every bin of one spectrum size, so the tiles
+ * can go through applyTransfer like any other filter.
+ ******************************************************************************/
+class SampledTransfer : public TransferFunction
+{
+  public:
+    SampledTransfer(const Buffer2D<float>& gains, int cols)
+        : gains(gains), cols(cols) {}
+
+    void evaluateRow(const FrequencyGeometry& geom, int u, float* h) const
+    {
+        std::copy(gains[u], gains[u] + geom.halfCols, h);
+    }
+
+    float evaluate(float fy, float fx) const
+    {
+        const FrequencyGeometry& geom = FrequencyGeometry::get(gains.rows(), cols);
+        int y = (int) floor(fy + 0.5f);
+        int x = (int) floor(fx + 0.5f);
+
+        // H is symmetric, so the gain of (y, x) is that of the stored (-y, -x)
+        if (x < 0)
+        {
+            y = -y;
+            x = -x;
+        }
+        y = ((y + geom.origin_y) % geom.rows + geom.rows) % geom.rows;
+        return gains[geom.spectrumRow[y]][std::min(x, geom.halfCols - 1)];
+    }
+
+  private:
+    const Buffer2D<float>& gains;
+    int cols;
+};
+
+/***************************************************************************//**
+ * smallestMargin
+ * Author - Dan Andrus
+ *
+ * Returns the smallest distance m such that the mass at distances greater
+ * than m is at most allowed, or limit if there is none below it.
+ ******************************************************************************/
+static int smallestMargin(const std::vector<double>& mass, double allowed, int limit)
+{
+    double tail = 0;
+
+    for (size_t d = 0; d < mass.size(); d++)
+        tail += mass[d];
+
+    for (int m = 0; m < limit && m < (int) mass.size(); m++)
+    {
+        tail -= mass[m];
+        if (tail <= allowed)
+            return m;
+    }
+    return limit;
+}
+
+/***************************************************************************//**
+ * TiledFilter
+ * Author - Dan Andrus
+ *
+ * Works out the tile size, the margins and the gains applied to each tile.
+ *
+ * Parameters -
+ *          transfer - the filter, as it would be applied to the whole frame
+ *          rows, cols - the dimensions of the image
+ *          tile - the side of a tile, margins included; dimensions of the
+ *                 image no larger than this are not split
+ *          tolerance - the fraction of the impulse response that may be cut
+ *                      off
+ ******************************************************************************/
+TiledFilter::TiledFilter(const TransferFunction& transfer, int rows, int cols,
+                         int tile, double tolerance)
+    : rows(rows), cols(cols), marginR(0), marginC(0), cut(0)
+{
+    tile = std::max(tile, MIN_TILE);
+    fftRows = std::min(rows, tile);
+    fftCols = std::min(cols, tile);
+
+    const FrequencyGeometry& geom = FrequencyGeometry::get(fftRows, fftCols);
+    float scaleY = (float) rows / fftRows;
+    float scaleX = (float) cols / fftCols;
+    Buffer2D<float> imag(fftRows, geom.halfCols);
+    Buffer2D<float> kernel;
+
+    // Bin u of a tile is bin u * rows / fftRows of the whole frame
+    gains.resize(fftRows, geom.halfCols);
+    imag.fill(0.0f);
+    for (int u = 0; u < fftRows; u++)
+    {
+        for (int v = 0; v < geom.halfCols; v++)
+            gains[u][v] = transfer.evaluate(geom.freqRow[u] * scaleY,
+                                            geom.freqCol[v] * scaleX);
+    }
+
+    if (fftRows == rows && fftCols == cols)
+        return;
+
+    // The response of a real, symmetric H cut off symmetrically is still
+    // real and symmetric, so its spectrum has no imaginary part to keep
+    inverseRealFFT2D(gains, imag, kernel, fftCols);
+    chooseMargins(kernel, tolerance);
+    realFFT2D(kernel, gains, imag);
+}
+
+/***************************************************************************//**
+ * tileCount
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          the number of tiles the image is split into
+ ******************************************************************************/
+int TiledFilter::tileCount() const
+{
+    int coreRows = fftRows - 2 * marginR;
+    int coreCols = fftCols - 2 * marginC;
+
+    return ((rows + coreRows - 1) / coreRows) * ((cols + coreCols - 1) / coreCols);
+}
+
+/***************************************************************************//**
+ * peakBytes
+ * Author - Dan Andrus
+ *
+ * Returns
+ *          about how much memory a run uses on top of its input and output:
+ *          the gains plus, for each thread working at once, a tile and its
+ *          half spectrum
+ ******************************************************************************/
+size_t TiledFilter::peakBytes() const
+{
+    int threads = std::min(ThreadPool::global().size(), tileCount());
+    size_t tile = (size_t) fftRows * fftCols + 2 * gains.bytes() / sizeof(float);
+
+    return gains.bytes() + threads * tile * sizeof(float);
+}
+
+/***************************************************************************//**
+ * run
+ * Author - Dan Andrus
+ *
+ * Filters an image held in memory. input and output must not be the same
+ * buffer, since each tile reads past the part of the output it writes.
+ ******************************************************************************/
+void TiledFilter::run(const Buffer2D<float>& input, Buffer2D<float>& output) const
+{
+    output.resize(rows, cols);
+
+    run([&](int row, int col, int count, float* out)
+        {
+            std::copy(input[row] + col, input[row] + col + count, out);
+        },
+        [&](int row, int col, int count, const float* in)
+        {
+            std::copy(in, in + count, output[row] + col);
+        });
+}
+
+/***************************************************************************//**
+ * run
+ * Author - Dan Andrus
+ *
+ * Filters an image read and written a piece of a row at a time, so that
+ * neither has to be in memory as a whole. Both functions are called from
+ * several threads at once; no part of the output is written twice.
+ *
+ * Parameters -
+ *          read - fills out with count intensities of the input, starting
+ *                 at (row, col); never asked to read past the end of a row
+ *          write - stores count filtered intensities starting at (row, col)
+ ******************************************************************************/
+void TiledFilter::run(const RowReader& read, const RowWriter& write) const
+{
+    SampledTransfer transfer(gains, fftCols);
+    int coreRows = fftRows - 2 * marginR;
+    int coreCols = fftCols - 2 * marginC;
+    int across = (cols + coreCols - 1) / coreCols;
+
+    ThreadPool::global().parallelFor(tileCount(), [&](int begin, int end)
+    {
+        Buffer2D<float> block(fftRows, fftCols);
+        Buffer2D<float> real;
+        Buffer2D<float> imag;
+
+        for (int t = begin; t < end; t++)
+        {
+            int top = (t / across) * coreRows;
+            int left = (t % across) * coreCols;
+
+            for (int y = 0; y < fftRows; y++)
+            {
+                int r = ((top - marginR + y) % rows + rows) % rows;
+                readRow(read, r, left - marginC, block[y]);
+            }
+
+            // Loops started here are nested in the loop over tiles, so they
+            // run on this thread alone
+            realFFT2D(block, real, imag);
+            applyTransfer(transfer, real, imag, fftCols);
+            inverseRealFFT2D(real, imag, block, fftCols);
+
+            int height = std::min(coreRows, rows - top);
+            int width = std::min(coreCols, cols - left);
+            for (int y = 0; y < height; y++)
+                write(top + y, left, width, block[marginR + y] + marginC);
+        }
+    });
+}
+
+/***************************************************************************//**
+ * chooseMargins
+ * Author - Dan Andrus
+ *
+ * Picks the margins from the impulse response of the filter on one tile and
+ * zeroes the response outside them. Along a dimension that is not split the
+ * response wraps around just as over the whole frame, so it is kept whole.
+ *
+ * Parameters -
+ *          kernel - the impulse response, with the origin at (0, 0)
+ *          tolerance - the fraction of the response's mass that may be cut
+ ******************************************************************************/
+void TiledFilter::chooseMargins(Buffer2D<float>& kernel, double tolerance)
+{
+    std::vector<double> rowMass(fftRows / 2 + 1, 0.0);
+    std::vector<double> colMass(fftCols / 2 + 1, 0.0);
+    bool splitRows = (fftRows < rows);
+    bool splitCols = (fftCols < cols);
+    double total = 0;
+    double removed = 0;
+
+    for (int r = 0; r < fftRows; r++)
+    {
+        int dy = std::min(r, fftRows - r);
+        for (int c = 0; c < fftCols; c++)
+        {
+            double mass = fabs(kernel[r][c]);
+            rowMass[dy] += mass;
+            colMass[std::min(c, fftCols - c)] += mass;
+            total += mass;
+        }
+    }
+
+    // Half of the tolerance goes to each dimension
+    if (splitRows)
+        marginR = smallestMargin(rowMass, total * tolerance / 2, fftRows / 4);
+    if (splitCols)
+        marginC = smallestMargin(colMass, total * tolerance / 2, fftCols / 4);
+
+    for (int r = 0; r < fftRows; r++)
+    {
+        bool outside = splitRows && std::min(r, fftRows - r) > marginR;
+        for (int c = 0; c < fftCols; c++)
+        {
+            if (outside || (splitCols && std::min(c, fftCols - c) > marginC))
+            {
+                removed += fabs(kernel[r][c]);
+                kernel[r][c] = 0.0f;
+            }
+        }
+    }
+    cut = (total > 0) ? removed / total : 0.0;
+}
+
+/***************************************************************************//**
+ * readRow
+ * Author - Dan Andrus
+ *
+ * Reads one row of a tile, wrapping around the left and right edges of the
+ * image.
+ ******************************************************************************/
+void TiledFilter::readRow(const RowReader& read, int row, int col, float* out) const
+{
+    int c = (col % cols + cols) % cols;
+    int left = fftCols;
+
+    while (left > 0)
+    {
+        int count = std::min(left, cols - c);
+        read(row, c, count, out);
+        out += count;
+        left -= count;
+        c = 0;
+    }
+}
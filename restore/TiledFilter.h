@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * TiledFilter.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 21, 2015
+ *
+ * Details - Contains the TiledFilter class, which applies a transfer function
+ *           to an image one tile at a time by overlap-save convolution, for
+ *           images whose whole spectrum would not fit in memory.
+ ******************************************************************************/
+#pragma once
+#include <functional>
+#include "Buffer2D.h"
+#include "Transfer.h"
+
+// Fraction of the filter's impulse response that may be cut off to keep the
+// overlap between tiles small
+static const double DEFAULT_TILE_TOLERANCE = 1e-4;
+
+/***************************************************************************//**
+ * TiledFilter
+ *
+ * Author - Dan Andrus
+ *
+ * Filtering the whole frame holds the half spectrum of the image, two float
+ * planes as large as the image itself, plus transform scratch. A TiledFilter
+ * gives the same result holding only a few tiles at a time.
+ *
+ * The transfer function, which is given in frequencies of the full frame, is
+ * sampled at the frequencies the bins of a tile stand for and turned into an
+ * impulse response. The response is cut off at the smallest margin that
+ * keeps all but tolerance of its mass, limited to a quarter of the tile, and
+ * transformed back into the gains applied to each tile. Each tile is read
+ * with that margin on every side, filtered, and only its inside is kept
+ * (overlap-save), so neighbouring tiles join without seams. Reads past the
+ * edge of the image wrap around, as the whole-frame transform does.
+ *
+ * A dimension no larger than the tile is not split at all and needs no
+ * margin, so an image that fits in one tile gives exactly the whole-frame
+ * result. Otherwise the result differs from it by about truncation() times
+ * the image's range: negligibly for the Gaussian filters, more for the ideal
+ * filters and for inverse filters with a high threshold, whose responses
+ * spread over the whole image.
+ *
+ * Tiles are spread over the global thread pool, each thread filtering its
+ * tiles one after the other with one set of buffers, so the memory used on
+ * top of the input and output is about peakBytes().
+ ******************************************************************************/
+class TiledFilter
+{
+  public:
+    static const int DEFAULT_TILE = 1024;
+
+    typedef std::function<void(int row, int col, int count, float* out)> RowReader;
+    typedef std::function<void(int row, int col, int count, const float* in)> RowWriter;
+
+    TiledFilter(const TransferFunction& transfer, int rows, int cols,
+                int tile = DEFAULT_TILE, double tolerance = DEFAULT_TILE_TOLERANCE);
+
+    void run(const Buffer2D<float>& input, Buffer2D<float>& output) const;
+    void run(const RowReader& read, const RowWriter& write) const;
+
+    int tileRows() const { return fftRows; }
+    int tileCols() const { return fftCols; }
+    int marginRows() const { return marginR; }
+    int marginCols() const { return marginC; }
+    int tileCount() const;
+    double truncation() const { return cut; }
+    size_t peakBytes() const;
+
+  private:
+    void chooseMargins(Buffer2D<float>& kernel, double tolerance);
+    void readRow(const RowReader& read, int row, int col, float* out) const;
+
+    int rows;
+    int cols;
+    int fftRows;
+    int fftCols;
+    int marginR;
+    int marginC;
+    double cut;
+    Buffer2D<float> gains;          // fftRows x (fftCols/2 + 1)
+};
@@ -0,0 +1,416 @@
+/***************************************************************************//**
+ * Transfer.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 12, 2015
+ *
+ * Details - Defines the non-radial transfer functions and the kernel which
+ *           applies a transfer function to the half spectrum.
+ ******************************************************************************/
+#include "Transfer.h"
+#include "ThreadPool.h"
+#include "Job.h"
+#include "Precision.h"
+#include <algorithm>
+#include <cmath>
+
+// Values of a half spectrum converted to float at a time by multiplyRow
+static const int HALF_CHUNK = 256;
+
+// Largest change to a gain that GaussianNotchBank leaves out
+static const double NOTCH_CUTOFF = 1e-4;
+
+/***************************************************************************//**
+ * GaussianSpotReject::evaluateRow
+ * Author - Dan Andrus
+ *
+ * Fills h with the gains of row u of the half spectrum.
+ ******************************************************************************/
+void GaussianSpotReject::evaluateRow(const FrequencyGeometry& geom, int u,
+                                     float* h) const
+{
+    const float* fx = &geom.freqCol[0];
+    float fy = geom.freqRow[u];
+    int n = geom.halfCols;
+    int v = 0;
+
+    for (; v + VFLOAT_WIDTH <= n; v += VFLOAT_WIDTH)
+        vstore(h + v, gain(vfloat(fy), vloadu<vfloat>(fx + v)));
+    for (; v < n; v++)
+        h[v] = gain(fy, fx[v]);
+}
+
+/***************************************************************************//**
+ * GaussianNotchBank::add
+ * Author - Dan Andrus
+ *
+ * Adds a notch of the given radius around the frequency (fy, fx) and its
+ * mirror (-fy, -fx), as GaussianSpotReject(fy, fx, radius) would remove.
+ ******************************************************************************/
+void GaussianNotchBank::add(double fy, double fx, double radius)
+{
+    Notch notch;
+    notch.py = (float) fy;
+    notch.px = (float) fx;
+    notch.scale = (float) (-1.0 / (2.0 * radius * radius));
+    notch.extent = (float) (radius * sqrt(2.0 * log(1.0 / NOTCH_CUTOFF)));
+    notches.push_back(notch);
+
+    notch.py = -notch.py;
+    notch.px = -notch.px;
+    notches.push_back(notch);
+}
+
+/***************************************************************************//**
+ * GaussianNotchBank::columns
+ * Author - Dan Andrus
+ *
+ * Finds the columns of the half spectrum, in the row at offset fy from the
+ * center, that lie within a notch's extent. Stored column v is at offset v,
+ * except that the last column of an even width is drawn at -cols / 2, so it
+ * is checked on its own.
+ *
+ * Returns
+ *          true if the row crosses the notch, with the columns in v0 to v1
+ ******************************************************************************/
+bool GaussianNotchBank::columns(const FrequencyGeometry& geom, const Notch& notch,
+                                float fy, int& v0, int& v1)
+{
+    float dy = fy - notch.py;
+    if (fabs(dy) > notch.extent)
+        return false;
+
+    float dx = sqrt(notch.extent * notch.extent - dy * dy);
+    int last = geom.halfCols - 1;
+    float nyquist = geom.freqCol[last];
+    int regular = (nyquist == last) ? last : last - 1;
+
+    v0 = std::max(0, (int) ceil(notch.px - dx));
+    v1 = std::min(regular, (int) floor(notch.px + dx));
+
+    if (regular < last && fabs(nyquist - notch.px) <= dx)
+    {
+        v0 = std::min(v0, last);
+        v1 = last;
+    }
+    return v0 <= v1;
+}
+
+/***************************************************************************//**
+ * multiplyNotch
+ * Author - Dan Andrus
+ *
+ * Multiplies gains v0 to v1 of a row by the gain of one notch spot. The
+ * vector loop starts at v0 rounded down to a multiple of VFLOAT_WIDTH, so a
+ * few gains before v0 are multiplied by the notch too, which is still its
+ * exact gain there.
+ *
+ * Parameters -
+ *          fx - The offsets of the columns from the center
+ *          dy2 - The squared row distance from the spot
+ *          px - The column offset of the spot
+ *          scale - -1 / (2 radius^2)
+ *          h - The aligned row of gains
+ *          v0, v1 - The columns to multiply
+ ******************************************************************************/
+static void multiplyNotch(const float* fx, float dy2, float px, float scale,
+                          float* h, int v0, int v1)
+{
+    int v = v0 - v0 % VFLOAT_WIDTH;
+
+    for (; v + VFLOAT_WIDTH <= v1 + 1; v += VFLOAT_WIDTH)
+    {
+        vfloat dx = vloadu<vfloat>(fx + v) - vfloat(px);
+        vfloat spot = vfloat(1.0f) - vexp((vfloat(dy2) + dx * dx) * vfloat(scale));
+        vstore(h + v, vload<vfloat>(h + v) * spot);
+    }
+    for (; v <= v1; v++)
+    {
+        float dx = fx[v] - px;
+        h[v] *= 1.0f - vexp((dy2 + dx * dx) * scale);
+    }
+}
+
+/***************************************************************************//**
+ * GaussianNotchBank::evaluateRow
+ * Author - Dan Andrus
+ *
+ * Fills h with the gains of row u of the half spectrum.
+ ******************************************************************************/
+void GaussianNotchBank::evaluateRow(const FrequencyGeometry& geom, int u,
+                                    float* h) const
+{
+    float fy = geom.freqRow[u];
+    int v0, v1;
+
+    for (int v = 0; v < geom.halfCols; v++)
+        h[v] = 1.0f;
+
+    for (size_t i = 0; i < notches.size(); i++)
+    {
+        const Notch& notch = notches[i];
+        if (columns(geom, notch, fy, v0, v1))
+            multiplyNotch(&geom.freqCol[0], (fy - notch.py) * (fy - notch.py),
+                          notch.px, notch.scale, h, v0, v1);
+    }
+}
+
+/***************************************************************************//**
+ * GaussianNotchBank::evaluateSpan
+ * Author - Dan Andrus
+ *
+ * Fills in the gains of row u from the first column any notch covers to the
+ * last, and nothing if no notch crosses the row.
+ ******************************************************************************/
+bool GaussianNotchBank::evaluateSpan(const FrequencyGeometry& geom, int u,
+                                     float* h, int& first, int& end) const
+{
+    float fy = geom.freqRow[u];
+    int v0, v1;
+    size_t i;
+
+    first = geom.halfCols;
+    end = 0;
+    for (i = 0; i < notches.size(); i++)
+    {
+        if (columns(geom, notches[i], fy, v0, v1))
+        {
+            first = std::min(first, v0);
+            end = std::max(end, v1 + 1);
+        }
+    }
+    if (first >= end)
+        return false;
+
+    first -= first % VFLOAT_WIDTH;
+    for (int v = first; v < end; v++)
+        h[v] = 1.0f;
+
+    for (i = 0; i < notches.size(); i++)
+    {
+        const Notch& notch = notches[i];
+        if (columns(geom, notch, fy, v0, v1))
+            multiplyNotch(&geom.freqCol[0], (fy - notch.py) * (fy - notch.py),
+                          notch.px, notch.scale, h, v0, v1);
+    }
+    return true;
+}
+
+float GaussianNotchBank::evaluate(float fy, float fx) const
+{
+    float gain = 1.0f;
+
+    for (size_t i = 0; i < notches.size(); i++)
+    {
+        const Notch& notch = notches[i];
+        float dy = fy - notch.py;
+        float dx = fx - notch.px;
+        float d2 = dy * dy + dx * dx;
+
+        if (d2 <= notch.extent * notch.extent)
+            gain *= 1.0f - vexp(d2 * notch.scale);
+    }
+    return gain;
+}
+
+/***************************************************************************//**
+ * TransferChain::add
+ * Author - Dan Andrus
+ *
+ * Appends a transfer function to the chain. A chain added to a chain is
+ * flattened into its members, so evaluateRow never runs one chain inside
+ * another and the scratch row can be shared.
+ ******************************************************************************/
+void TransferChain::add(const std::shared_ptr<const TransferFunction>& transfer)
+{
+    const TransferChain* chain = dynamic_cast<const TransferChain*>(transfer.get());
+
+    if (chain == NULL)
+        transfers.push_back(transfer);
+    else
+        transfers.insert(transfers.end(), chain->transfers.begin(), chain->transfers.end());
+}
+
+/***************************************************************************//**
+ * TransferChain::evaluateRow
+ * Author - Dan Andrus
+ *
+ * Fills h with the product of the gains of every function in the chain for
+ * row u. The first function writes h directly and the rest are evaluated
+ * into a scratch row and multiplied in, so a row of gains never leaves the
+ * cache.
+ ******************************************************************************/
+void TransferChain::evaluateRow(const FrequencyGeometry& geom, int u, float* h) const
+{
+    static thread_local Buffer2D<float> scratch;
+    int n = geom.halfCols;
+    int v;
+
+    if (transfers.empty())
+    {
+        for (v = 0; v < n; v++)
+            h[v] = 1.0f;
+        return;
+    }
+
+    transfers[0]->evaluateRow(geom, u, h);
+    scratch.resize(1, n);
+
+    for (size_t i = 1; i < transfers.size(); i++)
+    {
+        float* g = scratch[0];
+        transfers[i]->evaluateRow(geom, u, g);
+
+        for (v = 0; v + VFLOAT_WIDTH <= n; v += VFLOAT_WIDTH)
+            vstore(h + v, vload<vfloat>(h + v) * vload<vfloat>(g + v));
+        for (; v < n; v++)
+            h[v] *= g[v];
+    }
+}
+
+float TransferChain::evaluate(float fy, float fx) const
+{
+    float gain = 1.0f;
+
+    for (size_t i = 0; i < transfers.size(); i++)
+        gain *= transfers[i]->evaluate(fy, fx);
+    return gain;
+}
+
+/***************************************************************************//**
+ * multiplyRow
+ * Author - Dan Andrus
+ *
+ * Multiplies the real and imaginary parts of n bins by the gains in h. All
+ * three rows must start on an aligned address, which Buffer2D guarantees.
+ * Double rows are multiplied in double; half rows are converted to float a
+ * chunk at a time, multiplied and rounded back.
+ ******************************************************************************/
+static void multiplyRow(float* real, float* imag, const float* h, int n)
+{
+    int v = 0;
+
+    for (; v + VFLOAT_WIDTH <= n; v += VFLOAT_WIDTH)
+    {
+        vfloat gain = vload<vfloat>(h + v);
+        vstore(real + v, vload<vfloat>(real + v) * gain);
+        vstore(imag + v, vload<vfloat>(imag + v) * gain);
+    }
+    for (; v < n; v++)
+    {
+        real[v] *= h[v];
+        imag[v] *= h[v];
+    }
+}
+
+static void multiplyRow(double* real, double* imag, const float* h, int n)
+{
+    for (int v = 0; v < n; v++)
+    {
+        real[v] *= h[v];
+        imag[v] *= h[v];
+    }
+}
+
+static void multiplyRow(half* real, half* imag, const float* h, int n)
+{
+    alignas(BUFFER2D_ALIGNMENT) float re[HALF_CHUNK];
+    alignas(BUFFER2D_ALIGNMENT) float im[HALF_CHUNK];
+
+    for (int v = 0; v < n; v += HALF_CHUNK)
+    {
+        int count = std::min(HALF_CHUNK, n - v);
+
+        convertRow(real + v, re, count);
+        convertRow(imag + v, im, count);
+        for (int i = 0; i < count; i++)
+        {
+            re[i] *= h[v + i];
+            im[i] *= h[v + i];
+        }
+        convertRow(re, real + v, count);
+        convertRow(im, imag + v, count);
+    }
+}
+
+/***************************************************************************//**
+ * applyTransfer
+ * Author - Dan Andrus
+ *
+ * Multiplies the half spectrum of a real image by a transfer function, one
+ * row at a time: the gains of a row are evaluated into a small aligned buffer
+ * which is then applied to the real and imaginary parts in a single pass.
+ * Since H is real and symmetric, scaling the stored half scales the mirrored
+ * half along with it. Only the span of each row that evaluateSpan reports is
+ * multiplied, except with an observer, which is given whole rows.
+ *
+ * Rows are split across the global thread pool unless there is an observer,
+ * which is called from the calling thread in row order. Either way the rows
+ * done count towards the calling thread's Job, if it has one.
+ *
+ * Spectra stacked one above the other, as realFFT2D leaves the channels of a
+ * color image, are all filtered by the same gains: each row's gains are
+ * evaluated once and applied to that row of every spectrum.
+ *
+ * Parameters -
+ *          transfer - The transfer function H to apply
+ *          real - The real parts of the half spectrum
+ *          imag - The imaginary parts of the half spectrum
+ *          cols - The number of columns of the full spectrum
+ *          observer - Called with the gains of each row after the row has
+ *                     been filtered, so a caller can update a display
+ *          planes - The number of spectra stacked in real and imag
+ ******************************************************************************/
+template <typename T>
+void applyTransfer(const TransferFunction& transfer, Buffer2D<T>& real,
+                   Buffer2D<T>& imag, int cols,
+                   const TransferObserver& observer, int planes)
+{
+    const FrequencyGeometry& geom = FrequencyGeometry::get(real.rows() / planes, cols);
+
+    if (observer)
+    {
+        Buffer2D<float> h(1, geom.halfCols);
+        for (int u = 0; u < geom.rows; u++)
+        {
+            transfer.evaluateRow(geom, u, h[0]);
+            for (int p = 0; p < planes; p++)
+            {
+                int row = p * geom.rows + u;
+                multiplyRow(real[row], imag[row], h[0], geom.halfCols);
+            }
+            observer(u, h[0]);
+            Job::report(u + 1, geom.rows);
+        }
+        return;
+    }
+
+    ThreadPool::global().parallelFor(geom.rows, [&](int begin, int end)
+    {
+        Buffer2D<float> h(1, geom.halfCols);
+        int first;
+        int last;
+        for (int u = begin; u < end; u++)
+        {
+            if (!transfer.evaluateSpan(geom, u, h[0], first, last))
+                continue;
+            for (int p = 0; p < planes; p++)
+            {
+                int row = p * geom.rows + u;
+                multiplyRow(real[row] + first, imag[row] + first, h[0] + first,
+                            last - first);
+            }
+        }
+    });
+}
+
+template void applyTransfer(const TransferFunction& transfer, Buffer2D<float>& real,
+                            Buffer2D<float>& imag, int cols,
+                            const TransferObserver& observer, int planes);
+template void applyTransfer(const TransferFunction& transfer, Buffer2D<double>& real,
+                            Buffer2D<double>& imag, int cols,
+                            const TransferObserver& observer, int planes);
+template void applyTransfer(const TransferFunction& transfer, Buffer2D<half>& real,
+                            Buffer2D<half>& imag, int cols,
+                            const TransferObserver& observer, int planes);
@@ -0,0 +1,351 @@
+/***************************************************************************//**
+ * Transfer.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 12, 2015
+ *
+ * Details - Contains the transfer functions H(u, v) used by the frequency
+ *           domain filters and applyTransfer, the one kernel that multiplies
+ *           the half spectrum by any of them. Every filter used to be its own
+ *           copy of the same loop over the image; now a filter only describes
+ *           its H and the loop lives here.
+ ******************************************************************************/
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Buffer2D.h"
+#include "FrequencyGeometry.h"
+#include "Simd.h"
+
+/***************************************************************************//**
+ * TransferFunction
+ *
+ * Author - Dan Andrus
+ *
+ * A real, conjugate symmetric transfer function H. Frequencies are offsets
+ * from the center of the displayed spectrum, in pixels, so H(fy, fx) is the
+ * gain applied to the pixel drawn at (origin_y + fy, origin_x + fx).
+ *
+ * evaluateRow fills in the gains for one row of the half spectrum at once.
+ * evaluate gives the gain at a single frequency.
+ *
+ * evaluateSpan is what applyTransfer calls. It fills in only the gains of
+ * columns first to end - 1 of a row, where first is a multiple of
+ * VFLOAT_WIDTH, and promises that every other gain of the row is 1, so
+ * applyTransfer can leave those bins alone. It returns false if the whole
+ * row is 1. By default the span is the whole row; functions that only touch
+ * small parts of the spectrum override it.
+ ******************************************************************************/
+class TransferFunction
+{
+  public:
+    virtual ~TransferFunction() {}
+
+    virtual void evaluateRow(const FrequencyGeometry& geom, int u, float* h) const = 0;
+    virtual float evaluate(float fy, float fx) const = 0;
+
+    virtual bool evaluateSpan(const FrequencyGeometry& geom, int u, float* h,
+                              int& first, int& end) const
+    {
+        evaluateRow(geom, u, h);
+        first = 0;
+        end = geom.halfCols;
+        return true;
+    }
+};
+
+/***************************************************************************//**
+ * RadialTransfer
+ *
+ * Author - Dan Andrus
+ *
+ * Base for transfer functions that only depend on the distance from the
+ * center. The derived class supplies
+ *
+ *      template <typename V> V gain(V r2) const
+ *
+ * written with the functions of Simd.h, which is instantiated for vfloat over
+ * the bulk of a row and for float over the last few columns.
+ ******************************************************************************/
+template <typename Derived>
+class RadialTransfer : public TransferFunction
+{
+  public:
+    void evaluateRow(const FrequencyGeometry& geom, int u, float* h) const
+    {
+        const Derived& self = static_cast<const Derived&>(*this);
+        const float* dx2 = &geom.freqColDist2[0];
+        float dy2 = geom.freqRowDist2[u];
+        int n = geom.halfCols;
+        int v = 0;
+
+        for (; v + VFLOAT_WIDTH <= n; v += VFLOAT_WIDTH)
+            vstore(h + v, self.gain(vfloat(dy2) + vloadu<vfloat>(dx2 + v)));
+        for (; v < n; v++)
+            h[v] = self.gain(dy2 + dx2[v]);
+    }
+
+    float evaluate(float fy, float fx) const
+    {
+        return static_cast<const Derived&>(*this).gain(fy * fy + fx * fx);
+    }
+};
+
+/***************************************************************************//**
+ * IdealLowPass
+ *
+ * Passes everything within radius of the center and removes the rest.
+ ******************************************************************************/
+class IdealLowPass : public RadialTransfer<IdealLowPass>
+{
+  public:
+    explicit IdealLowPass(double radius) : radius2((float) (radius * radius)) {}
+
+    template <typename V> V gain(V r2) const
+    {
+        return vselect(vless(V(radius2), r2), V(0.0f), V(1.0f));
+    }
+
+  private:
+    float radius2;
+};
+
+/***************************************************************************//**
+ * GaussianLowPass
+ *
+ * H = exp(-D^2 / (2 * radius^2))
+ ******************************************************************************/
+class GaussianLowPass : public RadialTransfer<GaussianLowPass>
+{
+  public:
+    explicit GaussianLowPass(double radius)
+        : scale((float) (-1.0 / (2.0 * radius * radius))) {}
+
+    template <typename V> V gain(V r2) const
+    {
+        return vexp(r2 * V(scale));
+    }
+
+  private:
+    float scale;
+};
+
+/***************************************************************************//**
+ * IdealBandReject
+ *
+ * Removes everything between the lower and upper radius, inclusive.
+ ******************************************************************************/
+class IdealBandReject : public RadialTransfer<IdealBandReject>
+{
+  public:
+    IdealBandReject(double lower, double upper)
+        : lower2((float) (lower * lower)), upper2((float) (upper * upper)) {}
+
+    template <typename V> V gain(V r2) const
+    {
+        auto inside = vand(vlessEqual(V(lower2), r2), vlessEqual(r2, V(upper2)));
+        return vselect(inside, V(0.0f), V(1.0f));
+    }
+
+  private:
+    float lower2;
+    float upper2;
+};
+
+/***************************************************************************//**
+ * GaussianBandReject
+ *
+ * H = 1 - exp(-(D - middle)^2 / (2 * (upper - lower)^2))
+ ******************************************************************************/
+class GaussianBandReject : public RadialTransfer<GaussianBandReject>
+{
+  public:
+    GaussianBandReject(double lower, double upper)
+        : middle((float) ((lower + upper) / 2.0)),
+          scale((float) (-1.0 / (2.0 * (upper - lower) * (upper - lower)))) {}
+
+    template <typename V> V gain(V r2) const
+    {
+        V d = vsqrt(r2) - V(middle);
+        return V(1.0f) - vexp(d * d * V(scale));
+    }
+
+  private:
+    float middle;
+    float scale;
+};
+
+/***************************************************************************//**
+ * GaussianInverse
+ *
+ * Undoes a Gaussian blur of the given radius: H = 1 / exp(-D^2 / (2 r^2)),
+ * limited to threshold so that frequencies the blur wiped out are not
+ * amplified without bound.
+ ******************************************************************************/
+class GaussianInverse : public RadialTransfer<GaussianInverse>
+{
+  public:
+    GaussianInverse(double radius, double threshold)
+        : scale((float) (1.0 / (2.0 * radius * radius))),
+          threshold((float) threshold) {}
+
+    template <typename V> V gain(V r2) const
+    {
+        return vmin(vexp(r2 * V(scale)), V(threshold));
+    }
+
+  private:
+    float scale;
+    float threshold;
+};
+
+/***************************************************************************//**
+ * GaussianWiener
+ *
+ * Wiener filter for a Gaussian blur of the given radius, with K estimating
+ * the ratio of the noise and image power spectra:
+ *
+ *      H = exp(-D^2 / (2 r^2)),  W = H^2 / (H^2 + K),  gain = W / H
+ *
+ * 1 / H is limited to threshold as in GaussianInverse.
+ ******************************************************************************/
+class GaussianWiener : public RadialTransfer<GaussianWiener>
+{
+  public:
+    GaussianWiener(double radius, double K, double threshold)
+        : scale((float) (-1.0 / (2.0 * radius * radius))), K((float) K),
+          threshold((float) threshold) {}
+
+    template <typename V> V gain(V r2) const
+    {
+        V h = vexp(r2 * V(scale));
+        V h2 = h * h;
+        V w = h2 / (h2 + V(K));
+        return vselect(vless(h * V(threshold), V(1.0f)), V(threshold) * w, w / h);
+    }
+
+  private:
+    float scale;
+    float K;
+    float threshold;
+};
+
+/***************************************************************************//**
+ * GaussianSpotReject
+ *
+ * Author - Dan Andrus
+ *
+ * Gaussian notch of the given radius around the frequency (fy, fx), and
+ * around its mirror (-fy, -fx) since the spectrum of a real image is
+ * symmetric:
+ *
+ *      H = (1 - exp(-|f - p|^2 / 2r^2)) * (1 - exp(-|f + p|^2 / 2r^2))
+ ******************************************************************************/
+class GaussianSpotReject : public TransferFunction
+{
+  public:
+    GaussianSpotReject(double fy, double fx, double radius)
+        : py((float) fy), px((float) fx),
+          scale((float) (-1.0 / (2.0 * radius * radius))) {}
+
+    void evaluateRow(const FrequencyGeometry& geom, int u, float* h) const;
+
+    float evaluate(float fy, float fx) const
+    {
+        return gain(fy, fx);
+    }
+
+  private:
+    template <typename V> V gain(V fy, V fx) const
+    {
+        V dy = fy - V(py);
+        V dx = fx - V(px);
+        V spot = V(1.0f) - vexp((dy * dy + dx * dx) * V(scale));
+        dy = fy + V(py);
+        dx = fx + V(px);
+        V mirror = V(1.0f) - vexp((dy * dy + dx * dx) * V(scale));
+        return spot * mirror;
+    }
+
+    float py;
+    float px;
+    float scale;
+};
+
+/***************************************************************************//**
+ * GaussianNotchBank
+ *
+ * Author - Dan Andrus
+ *
+ * Any number of GaussianSpotReject notches, applied as one filter. Each
+ * notch's gain differs from 1 by less than NOTCH_CUTOFF beyond
+ * sqrt(2 ln(1 / NOTCH_CUTOFF)) radii of its center, about 4.3 radii, so it is
+ * only evaluated within that distance of its spot and of the spot's mirror.
+ * evaluateSpan returns the columns those notches cover in a row and skips
+ * the rows they miss, so applying the bank costs time in proportion to the
+ * area of the notches rather than of the spectrum. Where notches overlap,
+ * their gains multiply.
+ ******************************************************************************/
+class GaussianNotchBank : public TransferFunction
+{
+  public:
+    void add(double fy, double fx, double radius);
+    bool empty() const { return notches.empty(); }
+    int size() const { return (int) notches.size() / 2; }
+
+    void evaluateRow(const FrequencyGeometry& geom, int u, float* h) const;
+    float evaluate(float fy, float fx) const;
+    bool evaluateSpan(const FrequencyGeometry& geom, int u, float* h,
+                      int& first, int& end) const;
+
+  private:
+    // One spot of a notch; the spot and its mirror are stored separately
+    struct Notch
+    {
+        float py;
+        float px;
+        float scale;
+        float extent;               // distance beyond which the gain is 1
+    };
+
+    static bool columns(const FrequencyGeometry& geom, const Notch& notch,
+                        float fy, int& v0, int& v1);
+
+    std::vector<Notch> notches;
+};
+
+/***************************************************************************//**
+ * TransferChain
+ *
+ * Author - Dan Andrus
+ *
+ * The product H = H1 * H2 * ... * Hn of several transfer functions. Applying
+ * a chain multiplies the spectrum once by the combined gains instead of once
+ * per filter, so the spectrum is read and written a single time however many
+ * filters are in the chain. An empty chain passes everything.
+ ******************************************************************************/
+class TransferChain : public TransferFunction
+{
+  public:
+    void add(const std::shared_ptr<const TransferFunction>& transfer);
+    void clear() { transfers.clear(); }
+    bool empty() const { return transfers.empty(); }
+    int size() const { return (int) transfers.size(); }
+
+    void evaluateRow(const FrequencyGeometry& geom, int u, float* h) const;
+    float evaluate(float fy, float fx) const;
+
+  private:
+    std::vector<std::shared_ptr<const TransferFunction> > transfers;
+};
+
+typedef std::function<void(int u, const float* h)> TransferObserver;
+
+// Instantiated for float, double and half spectra. Gains are always float
+template <typename T>
+void applyTransfer(const TransferFunction& transfer, Buffer2D<T>& real,
+                   Buffer2D<T>& imag, int cols,
+                   const TransferObserver& observer = TransferObserver(),
+                   int planes = 1);
@@ -0,0 +1,390 @@
+/***************************************************************************//**
+ * WienerSearch.cpp
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 25, 2015
+ *
+ * Details - Defines the WienerSearch class.
+ ******************************************************************************/
+#include "WienerSearch.h"
+#include "Pipeline.h"
+#include "ThreadPool.h"
+#include "Transfer.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Golden-section steps per parameter, each narrowing the interval by 0.618
+static const int GOLDEN_STEPS = 16;
+
+// Times the radius and K are refined in turn after the grid
+static const int REFINE_ROUNDS = 2;
+
+// Frequencies further from the center than this fraction of the largest
+// distance that fits in the image give the noise estimate
+static const double NOISE_RING = 0.8;
+
+// Distances fitted by estimateRadius: from FIT_FIRST out, while the power is
+// at least FIT_ABOVE_NOISE times the noise, and at least FIT_POINTS of them
+static const int FIT_FIRST = 4;
+static const double FIT_ABOVE_NOISE = 4.0;
+static const int FIT_POINTS = 8;
+
+/***************************************************************************//**
+ * WienerSearch
+ * Author - Dan Andrus
+ *
+ * Prepares a search over the half spectrum of an image, which must outlive
+ * the search, and estimates its noise. Radii default to 2 up to half the
+ * smaller side of the image, K to 1e-6 up to 1, and the grid to 12 x 12.
+ *
+ * Parameters -
+ *          real - The real parts of the half spectrum
+ *          imag - The imaginary parts of the half spectrum
+ *          cols - The number of columns of the full spectrum
+ ******************************************************************************/
+WienerSearch::WienerSearch(const Buffer2D<float>& real, const Buffer2D<float>& imag,
+                           int cols)
+    : real(real), imag(imag), refReal(NULL), refImag(NULL), cols(cols),
+      noise(0), fixedRadius(0), radiusLow(2),
+      radiusHigh(std::max(4, std::min(real.rows(), cols) / 2)),
+      KLow(1e-6), KHigh(1), gridRadii(12), gridKs(12),
+      threshold(DEFAULT_INVERSE_THRESHOLD)
+{
+    const FrequencyGeometry& geom = FrequencyGeometry::get(real.rows(), cols);
+    double ring = NOISE_RING * std::min(real.rows(), cols) / 2;
+    std::vector<double> power;
+
+    for (int u = 0; u < geom.rows; u++)
+    {
+        for (int v = 0; v < geom.halfCols; v++)
+        {
+            if (geom.freqRowDist2[u] + geom.freqColDist2[v] > ring * ring)
+                power.push_back((double) real[u][v] * real[u][v]
+                                + (double) imag[u][v] * imag[u][v]);
+        }
+    }
+
+    if (!power.empty())
+    {
+        std::nth_element(power.begin(), power.begin() + power.size() / 2, power.end());
+        noise = power[power.size() / 2] / log(2.0);
+    }
+}
+
+/***************************************************************************//**
+ * noiseDeviation
+ * Author - Dan Andrus
+ *
+ * Returns the estimated standard deviation of the noise, in gray levels.
+ ******************************************************************************/
+double WienerSearch::noiseDeviation() const
+{
+    return sqrt(noise * real.rows() * cols);
+}
+
+/***************************************************************************//**
+ * estimateRadius
+ * Author - Dan Andrus
+ *
+ * Estimates the radius of the Gaussian blur from the fall-off of the power
+ * spectrum, as described with the class.
+ *
+ * Returns
+ *          the radius, within the radius range
+ ******************************************************************************/
+double WienerSearch::estimateRadius() const
+{
+    const FrequencyGeometry& geom = FrequencyGeometry::get(real.rows(), cols);
+    double farthest = (double) geom.origin_y * geom.origin_y
+                      + (double) (geom.halfCols - 1) * (geom.halfCols - 1);
+    int distances = (int) sqrt(farthest) + 2;
+    std::vector<double> power(distances, 0.0);
+    std::vector<int> count(distances, 0);
+
+    for (int u = 0; u < geom.rows; u++)
+    {
+        for (int v = 0; v < geom.halfCols; v++)
+        {
+            int d = (int) (sqrt(geom.freqRowDist2[u] + geom.freqColDist2[v]) + 0.5);
+            power[d] += (double) real[u][v] * real[u][v] + (double) imag[u][v] * imag[u][v];
+            count[d]++;
+        }
+    }
+
+    // Normal equations of the fit of log(P - noise) to a + b log D + c D^2
+    double A[3][3] = { { 0 } };
+    double y[3] = { 0 };
+    int points = 0;
+
+    for (int d = FIT_FIRST; d < distances; d++)
+    {
+        if (count[d] == 0)
+            continue;
+
+        double p = power[d] / count[d];
+        if (p < FIT_ABOVE_NOISE * noise)
+            break;
+
+        double x[3] = { 1.0, log((double) d), (double) d * d };
+        double value = log(p - noise);
+        for (int i = 0; i < 3; i++)
+        {
+            y[i] += x[i] * value;
+            for (int j = 0; j < 3; j++)
+                A[i][j] += x[i] * x[j];
+        }
+        points++;
+    }
+    if (points < FIT_POINTS)
+        return radiusHigh;
+
+    // Gaussian elimination with partial pivoting
+    for (int i = 0; i < 3; i++)
+    {
+        int pivot = i;
+        for (int k = i + 1; k < 3; k++)
+        {
+            if (fabs(A[k][i]) > fabs(A[pivot][i]))
+                pivot = k;
+        }
+        std::swap(A[i], A[pivot]);
+        std::swap(y[i], y[pivot]);
+
+        for (int k = 0; k < 3; k++)
+        {
+            if (k == i)
+                continue;
+            double factor = A[k][i] / A[i][i];
+            for (int j = 0; j < 3; j++)
+                A[k][j] -= factor * A[i][j];
+            y[k] -= factor * y[i];
+        }
+    }
+
+    double c = y[2] / A[2][2];
+    if (!(c < 0))
+        return radiusHigh;
+    return std::min(radiusHigh, std::max(radiusLow, 1.0 / sqrt(-c)));
+}
+
+/***************************************************************************//**
+ * setReference
+ * Author - Dan Andrus
+ *
+ * Scores candidates by their error against a reference image, given by its
+ * half spectrum, instead of by the discrepancy principle. The spectrum must
+ * be the same size as the image's and outlive the search.
+ ******************************************************************************/
+void WienerSearch::setReference(const Buffer2D<float>& real, const Buffer2D<float>& imag)
+{
+    refReal = &real;
+    refImag = &imag;
+}
+
+void WienerSearch::setRadiusRange(double low, double high)
+{
+    radiusLow = low;
+    radiusHigh = high;
+}
+
+void WienerSearch::setKRange(double low, double high)
+{
+    KLow = low;
+    KHigh = high;
+}
+
+void WienerSearch::setGridSize(int radii, int Ks)
+{
+    gridRadii = std::max(2, radii);
+    gridKs = std::max(2, Ks);
+}
+
+/***************************************************************************//**
+ * score
+ * Author - Dan Andrus
+ *
+ * Scores one candidate, lower being better: the mean squared error against
+ * the reference if there is one, the discrepancy score otherwise. Rows are
+ * split across the global thread pool, or run on the calling thread when it
+ * is already inside a parallel loop. Row sums are added up in order, so the
+ * score does not depend on the number of threads.
+ ******************************************************************************/
+double WienerSearch::score(double radius, double K) const
+{
+    const FrequencyGeometry& geom = FrequencyGeometry::get(real.rows(), cols);
+    GaussianLowPass blur(radius);
+    GaussianWiener wiener(radius, K, threshold);
+    std::vector<double> error(geom.rows);
+
+    ThreadPool::global().parallelFor(geom.rows, [&](int begin, int end)
+    {
+        Buffer2D<float> gains(2, geom.halfCols);
+        float* h = gains[0];
+        float* g = gains[1];
+
+        for (int u = begin; u < end; u++)
+        {
+            const float* re = real[u];
+            const float* im = imag[u];
+            double sum = 0;
+
+            blur.evaluateRow(geom, u, h);
+            wiener.evaluateRow(geom, u, g);
+
+            for (int v = 0; v < geom.halfCols; v++)
+            {
+                // Columns other than 0 and cols/2 stand for their mirror too
+                double weight = (v == 0 || 2 * v == cols) ? 1.0 : 2.0;
+
+                if (refReal != NULL)
+                {
+                    double dr = g[v] * re[v] - (*refReal)[u][v];
+                    double di = g[v] * im[v] - (*refImag)[u][v];
+                    sum += weight * (dr * dr + di * di);
+                }
+                else
+                {
+                    // What the restoration, blurred again, leaves of G
+                    double a = 1.0 - (double) h[v] * g[v];
+                    sum += weight * a * a * ((double) re[v] * re[v] + (double) im[v] * im[v]);
+                }
+            }
+            error[u] = sum;
+        }
+    });
+
+    double sum = 0;
+    for (int u = 0; u < geom.rows; u++)
+        sum += error[u];
+    if (refReal != NULL)
+        return sum;
+
+    double expected = std::max(noise, 1e-30) * geom.rows * cols;
+    double ratio = log(std::max(sum, 1e-30) / expected);
+    return ratio * ratio;
+}
+
+/***************************************************************************//**
+ * golden
+ * Author - Dan Andrus
+ *
+ * Golden-section search for the lowest score along one parameter, on a log
+ * scale, with the other held fixed.
+ *
+ * Parameters -
+ *          low, high - The interval to search
+ *          fixed - The value of the other parameter
+ *          radius - true to search the radius, false to search K
+ *
+ * Returns
+ *          the best value found
+ ******************************************************************************/
+double WienerSearch::golden(double low, double high, double fixed, bool radius) const
+{
+    const double ratio = (sqrt(5.0) - 1) / 2;
+    double a = log(low);
+    double b = log(high);
+    double x1 = b - ratio * (b - a);
+    double x2 = a + ratio * (b - a);
+    double f1 = radius ? score(exp(x1), fixed) : score(fixed, exp(x1));
+    double f2 = radius ? score(exp(x2), fixed) : score(fixed, exp(x2));
+
+    for (int step = 0; step < GOLDEN_STEPS; step++)
+    {
+        if (f1 < f2)
+        {
+            b = x2;
+            x2 = x1;
+            f2 = f1;
+            x1 = b - ratio * (b - a);
+            f1 = radius ? score(exp(x1), fixed) : score(fixed, exp(x1));
+        }
+        else
+        {
+            a = x1;
+            x1 = x2;
+            f1 = f2;
+            x2 = a + ratio * (b - a);
+            f2 = radius ? score(exp(x2), fixed) : score(fixed, exp(x2));
+        }
+    }
+    return exp(f1 < f2 ? x1 : x2);
+}
+
+/***************************************************************************//**
+ * search
+ * Author - Dan Andrus
+ *
+ * Runs the grid and the refinement. The radius is only searched with a
+ * reference and no fixed radius; without a reference it is estimated unless
+ * fixed. Counts towards the calling thread's Job, if it has one, and stops
+ * with JobCancelled when it is cancelled.
+ *
+ * Returns
+ *          the best candidate found
+ ******************************************************************************/
+WienerCandidate WienerSearch::search() const
+{
+    double radius = fixedRadius;
+    if (radius <= 0 && refReal == NULL)
+        radius = estimateRadius();
+
+    int gridRadii = (radius > 0) ? 1 : this->gridRadii;
+    std::vector<double> radii(gridRadii, radius);
+    std::vector<double> Ks(gridKs);
+    std::vector<double> scores(gridRadii * gridKs);
+
+    for (int i = 0; i < gridRadii && radius <= 0; i++)
+        radii[i] = radiusLow * pow(radiusHigh / radiusLow, i / (gridRadii - 1.0));
+    for (int j = 0; j < gridKs; j++)
+        Ks[j] = KLow * pow(KHigh / KLow, j / (gridKs - 1.0));
+
+    // Candidates are independent, so the grid runs one candidate per thread
+    ThreadPool::global().parallelFor((int) scores.size(), [&](int begin, int end)
+    {
+        for (int n = begin; n < end; n++)
+            scores[n] = score(radii[n / gridKs], Ks[n % gridKs]);
+    });
+
+    int best = (int) (std::min_element(scores.begin(), scores.end()) - scores.begin());
+    int i = best / gridKs;
+    int j = best % gridKs;
+    WienerCandidate result = { radii[i], Ks[j], scores[best] };
+
+    // Refine within the grid points either side of the best one
+    double rLow = radii[std::max(i - 1, 0)];
+    double rHigh = radii[std::min(i + 1, gridRadii - 1)];
+    double kLow = Ks[std::max(j - 1, 0)];
+    double kHigh = Ks[std::min(j + 1, gridKs - 1)];
+
+    for (int round = 0; round < REFINE_ROUNDS; round++)
+    {
+        double r = (gridRadii > 1) ? golden(rLow, rHigh, result.K, true) : radius;
+        double K = golden(kLow, kHigh, r, false);
+        double value = score(r, K);
+
+        if (value < result.score)
+        {
+            result.radius = r;
+            result.K = K;
+            result.score = value;
+        }
+        if (gridRadii == 1)
+            break;
+    }
+    return result;
+}
+
+/***************************************************************************//**
+ * psnr
+ * Author - Dan Andrus
+ *
+ * Returns the peak signal to noise ratio in dB of an 8-bit image with the
+ * given mean squared error.
+ ******************************************************************************/
+double WienerSearch::psnr(double mse)
+{
+    return 10 * log10(255.0 * 255.0 / mse);
+}
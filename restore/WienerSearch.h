@@ -0,0 +1,105 @@
+/***************************************************************************//**
+ * WienerSearch.h
+ *
+ * Author - Dan Andrus
+ *
+ * Date - May 25, 2015
+ *
+ * Details - Contains the WienerSearch class, which picks the blur radius and
+ *           K of a Wiener filter for an image automatically.
+ ******************************************************************************/
+#pragma once
+#include "Buffer2D.h"
+
+/***************************************************************************//**
+ * WienerCandidate
+ *
+ * Author - Dan Andrus
+ *
+ * One pair of Wiener filter parameters and its score, lower being better.
+ ******************************************************************************/
+struct WienerCandidate
+{
+    double radius;
+    double K;
+    double score;
+};
+
+/***************************************************************************//**
+ * WienerSearch
+ *
+ * Author - Dan Andrus
+ *
+ * Searches for the radius and K of the GaussianWiener filter that best
+ * restore a blurred, noisy image, given its half spectrum. Each candidate is
+ * scored with a single pass over the spectrum, which is only read, so no
+ * candidate needs an inverse transform.
+ *
+ * Given the spectrum of a reference image, the score is the mean squared
+ * error of the restored image against it. By Parseval's theorem this is the
+ * sum of |gain * G - F|^2 over the spectrum, with the 1/N scaling of
+ * realFFT2D. search() scores a grid of radii and values of K, spaced evenly
+ * on a log scale, with the candidates split across the global thread pool,
+ * then refines the best of them with golden-section searches in log radius
+ * and log K in turn, between the grid points either side of it.
+ *
+ * Without a reference, both parameters are estimated from the spectrum
+ * itself:
+ *
+ * - The noise is taken to be white, and its power per frequency to be the
+ *   median power of the frequencies far from the center, which the blur has
+ *   left with only noise. Since the power of a noise frequency follows an
+ *   exponential distribution, the median is divided by ln 2.
+ *
+ * - The radius comes from the average power at each distance D from the
+ *   center, less the noise. Natural images have power falling off as
+ *   D^-alpha, which a Gaussian blur multiplies by exp(-D^2 / r^2), so a least
+ *   squares fit of log power against 1, log D and D^2 gives r. If the fit
+ *   finds no blur, the largest radius of the range is used.
+ *
+ * - K is chosen by the discrepancy principle: the restoration, blurred
+ *   again, should differ from the image by exactly the estimated noise. The
+ *   score is the squared log of the ratio of the two, and only K is
+ *   searched.
+ *
+ * The estimates assume the image is noticeably blurred; the noise estimate
+ * of a sharp image includes some of its detail.
+ ******************************************************************************/
+class WienerSearch
+{
+  public:
+    WienerSearch(const Buffer2D<float>& real, const Buffer2D<float>& imag, int cols);
+
+    void setReference(const Buffer2D<float>& real, const Buffer2D<float>& imag);
+    void setRadius(double radius) { fixedRadius = radius; }
+    void setRadiusRange(double low, double high);
+    void setKRange(double low, double high);
+    void setGridSize(int radii, int Ks);
+    void setThreshold(double threshold) { this->threshold = threshold; }
+
+    bool hasReference() const { return refReal != NULL; }
+    double noiseDeviation() const;
+    double estimateRadius() const;
+    double score(double radius, double K) const;
+    WienerCandidate search() const;
+
+    static double psnr(double mse);
+
+  private:
+    double golden(double low, double high, double fixed, bool radius) const;
+
+    const Buffer2D<float>& real;
+    const Buffer2D<float>& imag;
+    const Buffer2D<float>* refReal;
+    const Buffer2D<float>* refImag;
+    int cols;
+    double noise;                   // estimated noise power per frequency
+    double fixedRadius;             // 0 to search or estimate the radius
+    double radiusLow;
+    double radiusHigh;
+    double KLow;
+    double KHigh;
+    int gridRadii;
+    int gridKs;
+    double threshold;
+};
@@ -0,0 +1,17 @@
+# Included by projects that link the restoration library. Expects the project
+# to sit next to restore/ in the top level directory.
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+win32:CONFIG(release, debug|release): RESTORE_LIB_DIR = $$OUT_PWD/../restore/release
+else:win32:CONFIG(debug, debug|release): RESTORE_LIB_DIR = $$OUT_PWD/../restore/debug
+else: RESTORE_LIB_DIR = $$OUT_PWD/../restore
+
+LIBS += -L$$RESTORE_LIB_DIR -lrestore
+win32-msvc*: PRE_TARGETDEPS += $$RESTORE_LIB_DIR/restore.lib
+else: PRE_TARGETDEPS += $$RESTORE_LIB_DIR/librestore.a
+
+unix {
+    QMAKE_CXXFLAGS += -pthread
+    LIBS += -pthread
+}
@@ -0,0 +1,55 @@
+# GUI-free restoration library: transforms, filters and pipelines. Linked by
+# both the prog3 GUI and the prog3-batch command line tool.
+TEMPLATE = lib
+TARGET = restore
+CONFIG += staticlib c++11
+CONFIG -= qt
+
+HEADERS += \
+    Buffer2D.h \
+    BufferPool.h \
+    FFT.h \
+    FrameFile.h \
+    FrequencyGeometry.h \
+    GaussianSmoother.h \
+    Job.h \
+    MappedFile.h \
+    Noise.h \
+    Simd.h \
+    Transfer.h \
+    ThreadPool.h \
+    PeakDetector.h \
+    Pipeline.h \
+    Precision.h \
+    ProxyPreview.h \
+    Spectrum.h \
+    SpectrumCache.h \
+    SpectrumRenderer.h \
+    StackFilter.h \
+    TiledFilter.h \
+    WienerSearch.h
+
+SOURCES += \
+    BufferPool.cpp \
+    FFT.cpp \
+    FrameFile.cpp \
+    FrequencyGeometry.cpp \
+    GaussianSmoother.cpp \
+    Job.cpp \
+    MappedFile.cpp \
+    Noise.cpp \
+    Transfer.cpp \
+    ThreadPool.cpp \
+    PeakDetector.cpp \
+    Pipeline.cpp \
+    ProxyPreview.cpp \
+    Spectrum.cpp \
+    SpectrumCache.cpp \
+    SpectrumRenderer.cpp \
+    StackFilter.cpp \
+    TiledFilter.cpp \
+    WienerSearch.cpp
+
+unix {
+    QMAKE_CXXFLAGS += -pthread
+}